@@ -0,0 +1,122 @@
+#ifndef ERTOOL_ERALGOSHOWERPREPRUNE_CXX
+#define ERTOOL_ERALGOSHOWERPREPRUNE_CXX
+
+#include "ERAlgoShowerPrePrune.h"
+
+namespace ertool {
+
+  ERAlgoShowerPrePrune::ERAlgoShowerPrePrune(const std::string& name)
+    : AlgoBase(name)
+    , _min_energy(0.)
+    , _require_tpc_overlap(false)
+    , _bgw_start(3.5)
+    , _bgw_end(5.2)
+    , _min_flash_pe(10.)
+    , _max_flash_dist(-1.)
+  {
+    Reset();
+  }
+
+  void ERAlgoShowerPrePrune::Reset()
+  {
+    _n_evts = 0;
+    _n_showers = 0;
+    _n_pruned_energy = 0;
+    _n_pruned_tpc = 0;
+    _n_pruned_flash = 0;
+  }
+
+  void ERAlgoShowerPrePrune::AcceptPSet(const ::fcllite::PSet& cfg)
+  {}
+
+  void ERAlgoShowerPrePrune::ProcessBegin()
+  {
+    Reset();
+
+    // Build Box for TPC active volume
+    _vactive = ::geoalgo::AABox(0,
+                                -larutil::Geometry::GetME()->DetHalfHeight(),
+                                0,
+                                2 * larutil::Geometry::GetME()->DetHalfWidth(),
+                                larutil::Geometry::GetME()->DetHalfHeight(),
+                                larutil::Geometry::GetME()->DetLength());
+  }
+
+  bool ERAlgoShowerPrePrune::OverlapsTPC(const Shower& shower) const
+  {
+    if (_vactive.Contain(shower.Start())) return true;
+
+    ::geoalgo::LineSegment axis(shower.Start(), shower.Start() + shower.Dir() * shower.Length());
+    return !_geoalg.Intersection(_vactive, axis).empty();
+  }
+
+  bool ERAlgoShowerPrePrune::Reconstruct(const EventData &data, ParticleGraph& graph)
+  {
+    _n_evts++;
+
+    // Collect the in-beam flashes once per event (only if the flash check is used)
+    std::vector<const Flash*> beam_flashes;
+    if (_max_flash_dist > 0) {
+      for (auto const& flash : data.Flash()) {
+        if (flash._t < _bgw_start || flash._t > _bgw_end) continue;
+        if (flash.TotalPE() < _min_flash_pe) continue;
+        beam_flashes.push_back(&flash);
+      }
+    }
+
+    for (auto const& id : graph.GetParticleNodes(kShower)) {
+
+      auto& part = graph.GetParticle(id);
+      if (part.ProcessType() == kCosmic) continue;
+
+      _n_showers++;
+
+      auto const& shower = data.Shower(part.RecoID());
+
+      if (_min_energy > 0 && shower._energy < _min_energy) {
+        part.SetProcess(kCosmic);
+        _n_pruned_energy++;
+        continue;
+      }
+
+      if (_require_tpc_overlap && !OverlapsTPC(shower)) {
+        part.SetProcess(kCosmic);
+        _n_pruned_tpc++;
+        continue;
+      }
+
+      if (_max_flash_dist > 0) {
+        bool near_flash = false;
+        for (auto const& flash : beam_flashes) {
+          double dy = shower.Start()[1] - flash->_y;
+          double dz = shower.Start()[2] - flash->_z;
+          if (dy * dy + dz * dz < _max_flash_dist * _max_flash_dist) {
+            near_flash = true;
+            break;
+          }
+        }
+        if (!near_flash) {
+          part.SetProcess(kCosmic);
+          _n_pruned_flash++;
+          continue;
+        }
+      }
+
+    }
+
+    return true;
+
+  }
+
+  void ERAlgoShowerPrePrune::ProcessEnd(TFile * fout)
+  {
+    std::cout << "ERAlgoShowerPrePrune: looked at " << _n_showers
+              << " showers in " << _n_evts << " events." << std::endl;
+    std::cout << "  tagged (below " << _min_energy << " MeV)     : " << _n_pruned_energy << std::endl;
+    std::cout << "  tagged (outside TPC)          : " << _n_pruned_tpc << std::endl;
+    std::cout << "  tagged (far from beam flash)  : " << _n_pruned_flash << std::endl;
+  }
+
+}
+
+#endif
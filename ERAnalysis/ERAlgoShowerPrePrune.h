@@ -0,0 +1,103 @@
+/**
+ * \file ERAlgoShowerPrePrune.h
+ *
+ * \ingroup ERAnalysis
+ * 
+ * \brief Class def header for a class ERAlgoShowerPrePrune
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ERAnalysis
+
+    @{*/
+
+#ifndef ERTOOL_ERALGOSHOWERPREPRUNE_H
+#define ERTOOL_ERALGOSHOWERPREPRUNE_H
+
+#include "ERTool/Base/AlgoBase.h"
+#include "GeoAlgo/GeoAABox.h"
+#include "GeoAlgo/GeoAlgo.h"
+#include "LArUtil/Geometry.h"
+
+namespace ertool {
+
+  /**
+     \class ERAlgoShowerPrePrune
+     Cheap algorithm meant to run at the very start of the chain (before the track dresser
+     and pi0 algorithms). It tags showers that can't matter for the selection as kCosmic,
+     so the algorithms that skip cosmic-tagged particles loop over fewer showers:
+     - showers below a minimum energy (off by default: the ERTool helper already drops
+       showers below its SetMinEDep threshold)
+     - showers whose cone axis (start -> start + length*dir) never touches the TPC active volume
+       (off by default: it changes which showers the selection sees, so it has to be validated
+       against the unpruned selection before it is turned on)
+     - showers far (in y-z) from every flash in the beam window (off by default)
+     Each criterion is turned on independently. Counters are printed in ProcessEnd.
+   */
+  class ERAlgoShowerPrePrune : public AlgoBase {
+  
+  public:
+
+    /// Default constructor
+    ERAlgoShowerPrePrune(const std::string& name="ERAlgoShowerPrePrune");
+
+    /// Default destructor
+    virtual ~ERAlgoShowerPrePrune(){};
+
+    /// Reset function
+    void Reset();
+
+    /// Function to accept fclite::PSet
+    void AcceptPSet(const ::fcllite::PSet& cfg);
+
+    /// Called @ before processing the first event sample
+    void ProcessBegin();
+
+    /// Function to evaluate input showers and determine a score
+    bool Reconstruct(const EventData &data, ParticleGraph& graph);
+
+    /// Called after processing the last event sample
+    void ProcessEnd(TFile* fout=nullptr);
+
+    /// Showers below this energy [MeV] are tagged (<= 0 disables the energy check)
+    void SetMinEnergy(double e) { _min_energy = e; }
+
+    /// Whether to tag showers that are entirely outside of the TPC active volume (default false)
+    void SetRequireTPCOverlap(bool flag) { _require_tpc_overlap = flag; }
+
+    /// Flashes with time in [start,end] (us) and more than min PE count as "in-beam" flashes
+    void SetBeamWindow(double start, double end) { _bgw_start = start; _bgw_end = end; }
+    void SetMinFlashPE(double pe) { _min_flash_pe = pe; }
+
+    /// Showers whose start is further than this (cm, in y-z) from every in-beam flash center
+    /// are tagged (<= 0 disables the flash check)
+    void SetMaxFlashDistance(double d) { _max_flash_dist = d; }
+
+  private:
+
+    /// Whether the shower axis overlaps the TPC active volume
+    bool OverlapsTPC(const Shower& shower) const;
+
+    double _min_energy;
+    bool   _require_tpc_overlap;
+    double _bgw_start;
+    double _bgw_end;
+    double _min_flash_pe;
+    double _max_flash_dist;
+
+    ::geoalgo::AABox _vactive;
+    ::geoalgo::GeoAlgo _geoalg;
+
+    // counters
+    size_t _n_evts;
+    size_t _n_showers;
+    size_t _n_pruned_energy;
+    size_t _n_pruned_tpc;
+    size_t _n_pruned_flash;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group 
@@ -0,0 +1,66 @@
+#ifndef ERTOOL_ERANAINPUTSUMMARY_CXX
+#define ERTOOL_ERANAINPUTSUMMARY_CXX
+
+#include "ERAnaInputSummary.h"
+
+namespace ertool {
+
+  ERAnaInputSummary::ERAnaInputSummary(const std::string& name)
+    : AnaBase(name)
+    , _summary_filename("ertool_input_summary.bin")
+    , _quantum(summary::kDefaultQuantum)
+  {}
+
+  void ERAnaInputSummary::Reset()
+  {}
+
+  void ERAnaInputSummary::AcceptPSet(const ::fcllite::PSet& cfg)
+  {}
+
+  void ERAnaInputSummary::ProcessBegin()
+  {
+    if (!_writer.Open(_summary_filename, _quantum))
+      std::cout << "ERROR!! ERAnaInputSummary could not open summary file " << _summary_filename << std::endl;
+  }
+
+  bool ERAnaInputSummary::Analyze(const EventData &data, const ParticleGraph &ps)
+  {
+    _evt.Clear();
+    _evt.run = data.Run();
+    _evt.subrun = data.SubRun();
+    _evt.event = data.Event_ID();
+
+    for (auto const& shower : data.Shower())
+      _evt.AddShower(shower.Start()[0], shower.Start()[1], shower.Start()[2],
+                     shower.Dir()[0], shower.Dir()[1], shower.Dir()[2],
+                     shower.Length(), shower.Radius(),
+                     shower._energy, shower._dedx, shower._time);
+
+    for (auto const& track : data.Track()) {
+      _pts.clear();
+      for (auto const& pt : track) {
+        _pts.push_back(pt[0]);
+        _pts.push_back(pt[1]);
+        _pts.push_back(pt[2]);
+      }
+      _evt.AddTrack(_pts.data(), track.size(), track._energy, track._dedx, track._time);
+    }
+
+    for (auto const& flash : data.Flash()) {
+      _npe.assign(flash._npe_v.begin(), flash._npe_v.end());
+      _evt.AddFlash(flash._t, flash._x, flash._y, flash._z, _npe.data(), _npe.size());
+    }
+
+    return _writer.Write(_evt);
+  }
+
+  void ERAnaInputSummary::ProcessEnd(TFile* fout)
+  {
+    std::cout << "ERAnaInputSummary wrote " << _writer.NEvents() << " events ("
+              << _writer.NBytes() << " bytes) to " << _summary_filename << "." << std::endl;
+    _writer.Close();
+  }
+
+}
+
+#endif
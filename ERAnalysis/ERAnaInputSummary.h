@@ -0,0 +1,80 @@
+/**
+ * \file ERAnaInputSummary.h
+ *
+ * \ingroup ERAnalysis
+ *
+ * \brief Class def header for a class ERAnaInputSummary
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ERAnalysis
+
+    @{*/
+
+#ifndef ERTOOL_ERANAINPUTSUMMARY_H
+#define ERTOOL_ERANAINPUTSUMMARY_H
+
+#include "ERTool/Base/AnaBase.h"
+#include "InputSummary.h"
+#include <string>
+
+namespace ertool {
+
+  /**
+     \class ERAnaInputSummary
+     Converter from larlite files to a compact input summary file (see InputSummary.h):
+     stores exactly the ertool::Shower, Track and Flash objects handed to the algorithms
+     (so after the ERToolHelper conversion, SetMinEDep cut and x-shift).
+     Run it with an ERTool manager that has no algorithms for the fastest conversion.
+     The summary files can then be run through the algorithm chain with ERInputSummaryDriver.
+   */
+  class ERAnaInputSummary : public AnaBase {
+
+  public:
+
+    /// Default constructor
+    ERAnaInputSummary(const std::string& name = "ERAnaInputSummary");
+
+    /// Default destructor
+    virtual ~ERAnaInputSummary() {}
+
+    /// Reset function
+    virtual void Reset();
+
+    /// Function to accept fclite::PSet
+    void AcceptPSet(const ::fcllite::PSet& cfg);
+
+    /// Called @ before processing the first event sample
+    void ProcessBegin();
+
+    /// Function to convert and store the event's EventData
+    bool Analyze(const EventData &data, const ParticleGraph &ps);
+
+    /// Called after processing the last event sample
+    void ProcessEnd(TFile* fout = nullptr);
+
+    /// Name of the summary file to be written
+    void SetSummaryFileName(const std::string& name) { _summary_filename = name; }
+
+    /// Trajectory quantum [cm] used to store track points
+    void SetTrajectoryQuantum(float quantum) { _quantum = quantum; }
+
+  private:
+
+    std::string _summary_filename;
+    float _quantum;
+
+    summary::InputSummaryWriter _writer;
+    summary::InputSummaryEvent _evt;
+
+    /// Per-PMT PE buffer (re-used between flashes)
+    std::vector<float> _npe;
+    /// Track point buffer (re-used between tracks)
+    std::vector<float> _pts;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
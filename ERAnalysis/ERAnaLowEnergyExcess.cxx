@@ -2,6 +2,10 @@
 #define ERTOOL_ERANALOWENERGYEXCESS_CXX
 
 #include "ERAnaLowEnergyExcess.h"
+#include "TFile.h"
+#include "TKey.h"
+#include "TLeaf.h"
+#include <algorithm>
 
 namespace ertool {
 
@@ -14,21 +18,71 @@ namespace ertool {
 
 	void ERAnaLowEnergyExcess::ProcessBegin() {
 
-		/// Initialize the LEE reweighting package, if in LEE sample mode...
-		if (_LEESample_mode) {
+		/// Initialize the LEE reweighting package, if in LEE sample mode (or LEE weight column mode)...
+		if (_LEESample_mode || _LEEWeightColumn_mode) {
 			_rw.set_debug(false);
-			if (_LEE_filename.empty() || _LEE_corrhist_name.empty() || !_LEE_evts_passing_filter) {
-				std::cout << "ERROR!! Did not properly configure LEE reweighting thingy, and you're trying to use it!" << std::endl;
-				return;
-			}
+			if (_LEE_filename.empty() || _LEE_corrhist_name.empty() || (_LEESample_mode && !_LEE_evts_passing_filter))
+				throw std::runtime_error("ERAnaLowEnergyExcess: Did not properly configure LEE reweighting thingy, and you're trying to use it!");
 			_rw.set_source_filename(_LEE_filename.c_str());
 			_rw.set_generated_evis_uz_corr_name(_LEE_corrhist_name.c_str());
-			_rw.set_n_generated_events(_LEE_evts_passing_filter);
+			/// In LEE weight column mode the weight is for one generated event: it is normalized at plot
+			/// time with the n_LEE_topology_evts counter of the merged jobs (the weight goes as 1/N)
+			_rw.set_n_generated_events(_LEESample_mode ? _LEE_evts_passing_filter : 1);
 			/// The input neutrinos were generated only in the TPC, not the entire cryostat
 			_rw.set_events_generated_only_in_TPC(true);
 			_rw.initialize();
 		}
 
+		_counters = ::lee::util::JobCounters();
+
+		// the replicas shift the flash times only, the x positions would need the x shift of each trigger time
+		if (_n_replicas > 1 && !_x_shift_disabled)
+			throw std::runtime_error("ERAnaLowEnergyExcess: cosmic oversampling needs the x shift disabled (SetXShiftDisabled)!");
+
+		// Bootstrap weight branches, once the number of replicas is configured
+		// (the tree itself is made by the constructor, before any setter)
+		_bootstrap.assign(_n_bootstrap, 1);
+		for (size_t i = 0; i < _bootstrap.size(); ++i) {
+			std::string name = Form("_bootstrap_%zu", i);
+			if (auto branch = _result_tree->GetBranch(name.c_str()))
+				branch->SetAddress(&_bootstrap[i]);
+			else
+				_result_tree->Branch(name.c_str(), &_bootstrap[i], (name + "/b").c_str());
+		}
+
+		// Replica branches only when oversampling: the plotter moves the flashes of the in-time
+		// cosmics to the middle of the BGW unless the tree has _replica
+		if (_n_replicas > 1) {
+			if (auto branch = _result_tree->GetBranch("_replica"))
+				branch->SetAddress(&_replica);
+			else
+				_result_tree->Branch("_replica", &_replica, "_replica/I");
+			if (auto branch = _result_tree->GetBranch("_replica_weight"))
+				branch->SetAddress(&_replica_weight);
+			else
+				_result_tree->Branch("_replica_weight", &_replica_weight, "_replica_weight/D");
+		}
+
+		// stages of the shared cut flow, after the (unweighted) ones of the filters before this unit
+		auto& cut_flow = ::lee::util::CutFlow::Shared();
+		cut_flow.AddStage("analyzed", true);
+		cut_flow.AddStage("nue reconstructed", true);
+		cut_flow.AddStage("electron found", true);
+		cut_flow.AddStage("MC match found", true);
+
+		// with a discriminant cut, a model that can't be scored would silently drop every row
+		bool const discriminant_cut = _discriminant_cut > -std::numeric_limits<double>::max();
+		if (discriminant_cut && _discriminant_filename.empty())
+			throw std::runtime_error("ERAnaLowEnergyExcess: a discriminant cut is set without a discriminant model!");
+		if (!PrepareDiscriminant()) {
+			std::string msg = "Could not load the discriminant model " + _discriminant_name + " from " + _discriminant_filename;
+			if (discriminant_cut)
+				throw std::runtime_error("ERAnaLowEnergyExcess: " + msg + ", and a discriminant cut is set!");
+			std::cout << "ERROR!! " << msg << ", _discriminant will be -1!" << std::endl;
+		}
+		if (discriminant_cut)
+			cut_flow.AddStage("discriminant passed", true);
+
 		// Build Box for TPC active volume
 		_vactive  = ::geoalgo::AABox(0,
 		                             -larutil::Geometry::GetME()->DetHalfHeight(),
@@ -54,9 +108,36 @@ namespace ertool {
 	{
 		_result_tree->SetName(Form("%s", _treename.c_str()));
 
+		_counters.Add("n_events_analyzed", 1);
+
 		// Reset tree variables
 		ResetTreeVariables();
 
+		// Bootstrap weights, the same for every row of the event
+		if (!_bootstrap.empty()) {
+			_rng.SetKey(data.Run(), data.SubRun(), data.Event_ID(), ::lee::util::kBootstrapStream);
+			for (auto& w : _bootstrap) w = _rng.PoissonInversion(1.);
+		}
+
+		// Compute a reweight:
+		// in the case of BNB files, this is flux reweighting
+		// in case of LEE sample, this is the LEERW package to make scaled excess
+		// (note this also fills the _ptype variable)
+		// It only depends on the truth, so it is computed once per event and also weights the cut flow
+		double const event_weight = GetWeight(MCParticleGraph());
+		auto& cut_flow = ::lee::util::CutFlow::Shared();
+		cut_flow.Fill("analyzed", event_weight);
+
+		/// In LEE weight column mode, the LEE truth topology of the event comes from the mctruth,
+		/// recorded by MC_LEE_Filter (tag only) before any other filter
+		bool is_LEE_topology = false;
+		if (_LEEWeightColumn_mode) {
+			auto const& topology = ::lee::util::LEETopology::Shared();
+			if (!topology.NEvents())
+				throw std::runtime_error("ERAnaLowEnergyExcess: LEE weight column mode needs MC_LEE_Filter (SetTagOnly) first in the chain!");
+			is_LEE_topology = topology.Passed();
+		}
+
 		/// This variable seems to indicate whether a neutrino was reconstructed
 		/// (IE a "ccsingleE" was found)
 		bool reco = false;
@@ -75,6 +156,12 @@ namespace ertool {
 			// std::cout<<"No reconstructed nue in this event."<<std::endl;
 			return false;
 		}
+		cut_flow.Fill("nue reconstructed", event_weight);
+
+		/// Whether a ccsingleE electron was found, and matched to a MC shower (for the cut flow)
+		bool electron_found = false;
+		bool mc_match_found = false;
+		Long64_t const n_rows_before = _result_tree->GetEntries();
 
 		// Get MC particle set
 		auto const& mc_graph = MCParticleGraph();
@@ -116,6 +203,7 @@ namespace ertool {
 				_nu_theta = p.Momentum().Theta();
 				_nu_p = p.Momentum().Length();
 				_nu_pt = _nu_p * std::sin(_nu_theta);
+				_nu_pt_over_p = _nu_p > 0. ? _nu_pt / _nu_p : -999.;
 
 				/// There are various ways to compute the neutrino energy.
 				/// This function fills all the different reconstructed nue energy variables in the ttree
@@ -142,6 +230,7 @@ namespace ertool {
 
 						// Make a copy of the shower that is the ccsingleE
 						singleE_shower = data.Shower(daught.RecoID());
+						electron_found = true;
 						// std::cout << "Found singleE! reco ID is " << daught.RecoID() << std::endl;
 
 						// Some info about the shower to store in the analysis ttree
@@ -175,28 +264,17 @@ namespace ertool {
 				//// you can find a one-to-one match between the reco particle graph nodes
 				//// and the MC particlegraph nodes in order to do reco-to-MC comparisons
 
-				// Compute a reweight:
-				// in the case of BNB files, this is flux reweighting
-				// in case of LEE sample, this is the LEERW package to make scaled excess
-				// (note this also fills the _ptype variable)
-				_weight = GetWeight(mc_graph);
+				_weight = event_weight;
 
+				// LEE weight as an extra column, zero if the event fails the LEE truth topology
+				if (_LEEWeightColumn_mode && is_LEE_topology)
+					_lee_weight = GetLEEWeight(mc_graph);
 
 
 				// Make a vector of arrival time of all mctracks that pass thru the TPC
 				// std::vector<double> hacked_trig_times;
 				// hacked_trig_times.clear();
-				double flash_time_closest_to_bgw = std::numeric_limits<double>::max();
-				double BGW_center = 4.35;
-				for (auto const& flash : data.Flash()) {
-					if (flash.TotalPE() > 10.) {
-						if (fabs(flash._t - BGW_center) < fabs(flash_time_closest_to_bgw - BGW_center)) {
-							flash_time_closest_to_bgw = flash._t;
-						}
-					}
-					// hacked_trig_times.push_back(flash._t);
-				}
-				_trigger_hack_time = flash_time_closest_to_bgw;
+				_trigger_hack_time = FlashTimeClosestToBGW(data);
 
 				// std::cout << "Neutrino reconstructed! Let's loop through particle graph" << std::endl;
 				for ( auto const & mc : mc_graph.GetParticleArray() ) {
@@ -236,6 +314,7 @@ namespace ertool {
 							// std::cout << "Found the singleE shower in the MCParticleGraph. Origin is "
 							// <<mc.Origin()<<" and shower time is "<<singleE_shower._time<<std::endl;
 							_mc_origin = mc.Origin();
+							mc_match_found = true;
 
 							auto parent = mc_graph.GetParticle(mc.Parent());
 							auto ancestor = mc_graph.GetParticle(mc.Ancestor());
@@ -263,20 +342,195 @@ namespace ertool {
 				// _trigger_hack_time = hacked_trig_times[randomIndex];
 
 				/// Actually fill the analysis tree once per reconstructed neutrino
-				_result_tree->Fill();
+				/// (once per replica in cosmic oversampling mode)
+				FillReplicas(data, mc_data);
 
 			}// if we found the neutrino
 		}// End loop over particles
 
+		if (electron_found) cut_flow.Fill("electron found", event_weight);
+		if (mc_match_found) cut_flow.Fill("MC match found", event_weight);
+		if (_discriminant_cut > -std::numeric_limits<double>::max() && _result_tree->GetEntries() > n_rows_before)
+			cut_flow.Fill("discriminant passed", event_weight);
+
+		return true;
+	}
+
+	void ERAnaLowEnergyExcess::FillTree()
+	{
+		// scored here, once all the variables of the row (and replica) are set
+		_discriminant = ComputeDiscriminant();
+		if (_discriminant < _discriminant_cut) return;
+
+		_result_tree->Fill();
+
+		// per-job sums, written as JobCounters in ProcessEnd
+		_counters.Add("n_rows", 1);
+		_counters.Add("sum_weight", _weight * _replica_weight);
+		_counters.Add("sum_weight2", _weight * _weight * _replica_weight * _replica_weight);
+		if (_LEEWeightColumn_mode) _counters.Add("sum_lee_weight", _lee_weight * _replica_weight);
+	}
+
+	bool ERAnaLowEnergyExcess::PrepareDiscriminant()
+	{
+		_discriminant_model.reset();
+		_discriminant_score = nullptr;
+		_discriminant_inputs.clear();
+		_discriminant_values.clear();
+		if (_discriminant_filename.empty()) return true;
+
+		TDirectory::TContext context; // keep the current directory of the result tree
+		std::unique_ptr<TFile> f(TFile::Open(_discriminant_filename.c_str(), "READ"));
+		if (!f || f->IsZombie()) return false;
+
+		// the first model in the file (or the one with this name)
+		std::vector<std::string> features;
+		TIter next(f->GetListOfKeys());
+		while (auto key = dynamic_cast<TKey*>(next())) {
+			if (!_discriminant_name.empty() && _discriminant_name != key->GetName()) continue;
+			std::unique_ptr<TObject> obj(key->ReadObj());
+			if (auto model = dynamic_cast< ::lee::util::LogisticModel* >(obj.get())) {
+				if (model->FormatVersion() > ::lee::util::LogisticModel::kFormatVersion) {
+					std::cout << "ERROR!! LogisticModel format version " << model->FormatVersion() << " is too new!" << std::endl;
+					return false;
+				}
+				features = model->Features();
+				_discriminant_score = [model](const double * x) { return model->Probability(x); };
+				_discriminant_model = std::move(obj);
+				break;
+			}
+			if (auto model = dynamic_cast< ::lee::util::BDTModel* >(obj.get())) {
+				if (model->FormatVersion() > ::lee::util::BDTModel::kFormatVersion) {
+					std::cout << "ERROR!! BDTModel format version " << model->FormatVersion() << " is too new!" << std::endl;
+					return false;
+				}
+				model->Compile();
+				features = model->Features();
+				_discriminant_score = [model](const double * x) { return model->Score(x); };
+				_discriminant_model = std::move(obj);
+				break;
+			}
+		}
+		if (!_discriminant_model) return false;
+
+		// bind the features to the result tree branches
+		for (auto const& feature : features) {
+			auto branch = _result_tree->GetBranch(feature.c_str());
+			auto leaf = branch ? dynamic_cast<TLeaf*>(branch->GetListOfLeaves()->At(0)) : nullptr;
+			std::string type = leaf ? leaf->GetTypeName() : "";
+			char code = 0;
+			if (type == "Double_t") code = 'D';
+			else if (type == "Float_t") code = 'F';
+			else if (type == "Int_t") code = 'I';
+			else if (type == "Bool_t") code = 'O';
+			if (!code) {
+				std::cout << "ERROR!! Discriminant feature " << feature << " is not a numeric branch of the result tree!" << std::endl;
+				_discriminant_score = nullptr;
+				_discriminant_inputs.clear();
+				return false;
+			}
+			_discriminant_inputs.push_back(std::make_pair((const void*)branch->GetAddress(), code));
+		}
+		_discriminant_values.assign(features.size(), 0.);
+
+		std::cout << "Scoring the rows with the discriminant " << _discriminant_model->GetName()
+		          << " of " << _discriminant_filename << std::endl;
 		return true;
 	}
 
+	double ERAnaLowEnergyExcess::ComputeDiscriminant()
+	{
+		if (!_discriminant_score) return -1.;
+		for (size_t j = 0; j < _discriminant_inputs.size(); ++j) {
+			auto const& input = _discriminant_inputs[j];
+			switch (input.second) {
+			case 'D': _discriminant_values[j] = *static_cast<const double*>(input.first); break;
+			case 'F': _discriminant_values[j] = *static_cast<const float*>(input.first); break;
+			case 'I': _discriminant_values[j] = *static_cast<const int*>(input.first); break;
+			case 'O': _discriminant_values[j] = *static_cast<const bool*>(input.first); break;
+			}
+		}
+		return _discriminant_score(_discriminant_values.data());
+	}
+
+	double ERAnaLowEnergyExcess::FlashTimeClosestToBGW(const EventData &data, double time_shift)
+	{
+		double flash_time_closest_to_bgw = std::numeric_limits<double>::max();
+		for (auto const& flash : data.Flash()) {
+			if (flash.TotalPE() > 10.) {
+				double t = flash._t + time_shift;
+				if (fabs(t - _BGW_center) < fabs(flash_time_closest_to_bgw - _BGW_center)) {
+					flash_time_closest_to_bgw = t;
+				}
+			}
+		}
+		return flash_time_closest_to_bgw;
+	}
+
+	void ERAnaLowEnergyExcess::FillReplicas(const EventData &data, const EventData &mc_data)
+	{
+		if (_n_replicas <= 1) {
+			FillTree();
+			return;
+		}
+
+		// Arrival time [ns] of all mc tracks that pass thru the TPC are the trigger time candidates
+		std::vector<double> trig_times;
+		for (auto const& trk : mc_data.Track()) {
+			if (!trk.size()) continue;
+			trig_times.push_back(trk._time);
+		}
+		// No track to trigger on: the event as it is, once
+		if (trig_times.empty()) {
+			_replica = 0;
+			_replica_weight = 1.;
+			FillTree();
+			return;
+		}
+
+		bool has_flash = _flash_time > -999999999.;
+		double orig_flash_time = _flash_time;
+
+		// Consecutive candidates starting from a random one, each track at most once
+		// (keyed by the event ids, so the choice doesn't depend on event order / sharding)
+		_rng.SetKey(data.Run(), data.SubRun(), data.Event_ID(), ::lee::util::kCosmicOversampleStream);
+		size_t offset = _rng.Integer(trig_times.size());
+		size_t n_replicas = std::min(_n_replicas, trig_times.size());
+
+		for (size_t k = 0; k < n_replicas; ++k) {
+
+			// Shift all flashes so the chosen track arrives in the middle of the beam gate
+			double time_shift = _BGW_center - trig_times[(offset + k) % trig_times.size()] / 1000.;
+
+			_flash_time = has_flash ? orig_flash_time + time_shift : orig_flash_time;
+			_trigger_hack_time = FlashTimeClosestToBGW(data, time_shift);
+			_replica = k;
+			_replica_weight = 1. / n_replicas;
+
+			FillTree();
+		}
+
+		_flash_time = orig_flash_time;
+	}
+
 	void ERAnaLowEnergyExcess::ProcessEnd(TFile * fout)
 	{
+		_counters.SetName(Form("%s_counters", _treename.c_str()));
+		_counters.Set("n_jobs", 1);
+		if (_LEEWeightColumn_mode)
+			_counters.Set("n_LEE_topology_evts", ::lee::util::LEETopology::Shared().NPassed());
+
 		if (fout) {
 			fout->cd();
 			_result_tree->Write();
+			_counters.Write();
 		}
+		// the shared cut flow, now including the stages of this unit
+		::lee::util::CutFlow::WriteShared(fout);
+
+		if (_LEEWeightColumn_mode)
+			std::cout << ::lee::util::LEETopology::Shared().NPassed() << " events passed the LEE truth topology "
+			          << "(n_LEE_topology_evts, divide _lee_weight by its total over the merged jobs)." << std::endl;
 
 		return;
 
@@ -284,19 +538,8 @@ namespace ertool {
 
 	double ERAnaLowEnergyExcess::GetWeight(const ParticleGraph mc_graph) {
 
-		double nu_E_GEV = 1.;
-		double e_E_MEV = -1.;
-		double e_uz = -2.;
-
 		for ( auto const & mc : mc_graph.GetParticleArray() ) {
 
-			if (abs(mc.PdgCode()) == 12)
-				nu_E_GEV = mc.Energy() / 1000.;
-			if (abs(mc.PdgCode()) == 11) {
-				e_E_MEV = mc.Energy();
-				e_uz = std::cos(mc.Momentum().Theta());
-			}
-
 			if (!_LEESample_mode) {
 				/// This stuff takes the truth neutrino information and computes a flux RW
 				/// Make sure the neutrino is its own ancestor (it wasn't from something decaying IN the event)
@@ -316,16 +559,19 @@ namespace ertool {
 					else if (mc.ProcessType() == ::ertool::kMuDecay) ptype = 1;
 					else if (mc.ProcessType() == ::ertool::kPionDecay) ptype = 2;
 
+					// GetWeight runs on every analyzed event: count the unknown parents, print the first one only
 					if (mc.ProcessType() != ::ertool::kK0L &&
 					        mc.ProcessType() != ::ertool::kKCharged &&
 					        mc.ProcessType() != ::ertool::kMuDecay &&
 					        mc.ProcessType() != ::ertool::kPionDecay) {
 
-						std::cout << " PDG : " << mc.PdgCode() << " Process Type : " << mc.ProcessType() << " from " <<
-						          ::ertool::kK0L <<  " or " <<
-						          ::ertool::kKCharged << " or " <<
-						          ::ertool::kMuDecay << " or " <<
-						          ::ertool::kPionDecay << std::endl;
+						_counters.Add("n_unknown_nu_parent", 1);
+						if (_counters.Get("n_unknown_nu_parent") == 1)
+							std::cout << " PDG : " << mc.PdgCode() << " Process Type : " << mc.ProcessType() << " from " <<
+							          ::ertool::kK0L <<  " or " <<
+							          ::ertool::kKCharged << " or " <<
+							          ::ertool::kMuDecay << " or " <<
+							          ::ertool::kPionDecay << " (printed once, counted in n_unknown_nu_parent)" << std::endl;
 					}
 
 					_ptype = ptype;
@@ -334,16 +580,37 @@ namespace ertool {
 			} // end if you aren't using LEESample mode
 		} // end loop over mc particle graph
 
-		if (_LEESample_mode) {
-			if (e_E_MEV < 0 || e_uz < -1 || nu_E_GEV < 0)
-				std::cout << "wtf i don't understand" << std::endl;
-			return _rw.get_sculpting_weight(e_E_MEV, e_uz) * _rw.get_normalized_weight(nu_E_GEV);
-		}
+		if (_LEESample_mode)
+			return GetLEEWeight(mc_graph);
 
 		/// You get here if you are running on cosmics (no truth neutrino in the event)
 		return 1;
 	}
 
+	double ERAnaLowEnergyExcess::GetLEEWeight(const ParticleGraph &mc_graph) {
+
+		double nu_E_GEV = 1.;
+		double e_E_MEV = -1.;
+		double e_uz = -2.;
+
+		for ( auto const & mc : mc_graph.GetParticleArray() ) {
+
+			if (abs(mc.PdgCode()) == 12)
+				nu_E_GEV = mc.Energy() / 1000.;
+			if (abs(mc.PdgCode()) == 11) {
+				e_E_MEV = mc.Energy();
+				e_uz = std::cos(mc.Momentum().Theta());
+			}
+		}
+
+		if (e_E_MEV < 0 || e_uz < -1 || nu_E_GEV < 0) {
+			_counters.Add("n_no_LEE_truth", 1);
+			if (_counters.Get("n_no_LEE_truth") == 1)
+				std::cout << "wtf i don't understand (no truth electron, printed once, counted in n_no_LEE_truth)" << std::endl;
+		}
+		return _rw.get_sculpting_weight(e_E_MEV, e_uz) * _rw.get_normalized_weight(nu_E_GEV);
+	}
+
 	void ERAnaLowEnergyExcess::PrepareTreeVariables() {
 
 		if (_result_tree) { delete _result_tree; }
@@ -387,6 +654,9 @@ namespace ertool {
 		_result_tree->Branch("_mc_time", &_mc_time, "_mc_time/D");
 		_result_tree->Branch("_trigger_hack_time", &_trigger_hack_time, "_trigger_hack_time/D");
 		_result_tree->Branch("_mc_nu_energy", &_mc_nu_energy, "_mc_nu_energy/D");
+		_result_tree->Branch("_lee_weight", &_lee_weight, "_lee_weight/D");
+		_result_tree->Branch("_nu_pt_over_p", &_nu_pt_over_p, "_nu_pt_over_p/D");
+		_result_tree->Branch("_discriminant", &_discriminant, "_discriminant/D");
 
 		return;
 	}
@@ -430,6 +700,11 @@ namespace ertool {
 		_mc_time = -9e9;
 		_trigger_hack_time = std::numeric_limits<double>::max();
 		_mc_nu_energy = std::numeric_limits<double>::max();
+		_lee_weight = 0.;
+		_replica = 0;
+		_replica_weight = 1.;
+		_nu_pt_over_p = -999.;
+		_discriminant = -1.;
 
 		return;
 
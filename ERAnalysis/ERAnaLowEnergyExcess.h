@@ -29,6 +29,16 @@
 #include <cmath>
 #include "GeoAlgo/GeoAlgo.h"
 #include "ECCQECalculator.h"
+#include "CounterRNG.h"
+#include "JobCounters.h"
+#include "CutFlow.h"
+#include "LEETopology.h"
+#include "LogisticModel.h"
+#include "BDTModel.h"
+#include <memory>
+#include <functional>
+#include <limits>
+#include <stdexcept>
 
 
 namespace ertool {
@@ -72,6 +82,50 @@ namespace ertool {
         void SetLEENEvents(size_t n_evts_passing_filter) { _LEE_evts_passing_filter = n_evts_passing_filter; }
         void SetLEECorrHistName(const std::string& name) { _LEE_corrhist_name = name; }
 
+        /// Set this to true if you're running over the intrinsic nue sample and want the LEE weight
+        /// stored as an extra column (_lee_weight) instead of running a separate LEE sample job.
+        /// Uses the same LEE reweighting configuration (SetLEEFilename etc.) as LEE sample mode, except
+        /// SetLEENEvents: _lee_weight is the weight for one generated event, to be divided by the
+        /// n_LEE_topology_evts counter of the merged jobs (see stack_plotter.py).
+        /// The topology of each event comes from an MC_LEE_Filter in tag only mode, first in the chain.
+        void SetLEEWeightColumnMode(bool flag) { _LEEWeightColumn_mode = flag; }
+
+        /// Cosmic oversampling: each reconstructed neutrino is filled n_replicas times, each replica
+        /// with a different trigger time (arrival time of one of the event's mc tracks) and the flash
+        /// times shifted so that this track arrives in the middle of the beam gate window.
+        /// Replicas are numbered by _replica and weighted by _replica_weight = 1/(number of replicas),
+        /// two branches that only exist with n_replicas > 1 (stack_plotter.py keys on them).
+        /// The event is read and reconstructed once for all replicas.
+        /// Each track is used at most once: an event with fewer tracks than n_replicas gets one replica
+        /// per track, and an event without tracks a single unshifted replica (weight 1).
+        /// Only the flash times are shifted, so the x dependent variables (_x_vtx, fiducial volume,
+        /// B.I.T.E. distances) are only consistent without the x shift of the reconstruction:
+        /// ProcessBegin throws if n_replicas > 1 without SetXShiftDisabled(true)
+        /// (ExampleERSelection::setDisableXShift(true)).
+        void SetCosmicOversampling(size_t n_replicas) { _n_replicas = n_replicas ? n_replicas : 1; }
+
+        /// Whether the selection unit runs with its x shift disabled (required by cosmic oversampling)
+        void SetXShiftDisabled(bool flag) { _x_shift_disabled = flag; }
+
+        /// Bootstrap replicas: every row gets n_bootstrap Poisson(1) weights _bootstrap_0, _bootstrap_1, ...
+        /// (one byte each), drawn from the kBootstrapStream of the event key, so all the rows of an event
+        /// share them and re-runs give the same weights. Multiplying the row weight by _bootstrap_<i> gives
+        /// the i-th resampling of the selected events (see StackBuilder::SetBootstrapReplicas).
+        /// Must be set before ProcessBegin.
+        void SetBootstrapReplicas(size_t n_bootstrap) { _n_bootstrap = n_bootstrap; }
+
+        /// Trained discriminant (IE the cosmic vs nue lee::util::LogisticModel of likelihood_fitter.py,
+        /// or a lee::util::BDTModel), loaded from a ROOT file at ProcessBegin. Its score is stored in
+        /// every row as _discriminant (-1 without a model). Its features must be branches of the result
+        /// tree (IE "_nu_pt_over_p", "_y_vtx", "_dedx"), read from the branch addresses when the row is filled.
+        /// name = "" takes the first model in the file.
+        void SetDiscriminantModel(const std::string& filename, const std::string& name = "")
+        { _discriminant_filename = filename; _discriminant_name = name; }
+
+        /// Early cut: only fill the rows with a discriminant score >= min_score.
+        /// ProcessBegin throws if the model then can't be loaded or bound to the tree.
+        void SetDiscriminantCut(double min_score) { _discriminant_cut = min_score; }
+
     private:
 
         // Calc new E_nu^calo, with missing pT cut
@@ -86,6 +140,24 @@ namespace ertool {
         /// Function to compute BNB flux RW weight, or LEE weight (if in LEE mode)
         double GetWeight(const ParticleGraph mc_graph);
 
+        /// Function to compute the LEE weight from the truth neutrino and electron in the mc graph
+        double GetLEEWeight(const ParticleGraph &mc_graph);
+
+        /// Time of the flash (above 10 PE) closest to the beam gate center, with all flashes shifted by time_shift [us]
+        double FlashTimeClosestToBGW(const EventData &data, double time_shift = 0.);
+
+        /// Fill the result tree (and add the row to the job counters), if the row passes the discriminant cut
+        void FillTree();
+
+        /// Load the discriminant model and bind its features to the result tree branches
+        bool PrepareDiscriminant();
+
+        /// Discriminant score of the current tree variables (-1 without a model)
+        double ComputeDiscriminant();
+
+        /// Fill the result tree once, or once per replica in cosmic oversampling mode
+        void FillReplicas(const EventData &data, const EventData &mc_data);
+
         /// Function to compute various neutrino energy definitions and fill them
         void FillRecoNuEnergies(const Particle &nue, const ParticleGraph &ps, const EventData &data);
 
@@ -130,6 +202,12 @@ namespace ertool {
         double _mc_time;          /// ertool::Shower._time for the single electron
         double _mc_nu_energy;     /// true neutrino energy if there is a neutrino
         double _trigger_hack_time; /// randomly selected cosmic track arrival time
+        double _lee_weight;       /// LEE weight for one generated event (zero if event fails LEE truth topology), only in LEE weight column mode
+        int _replica;             /// replica index in cosmic oversampling mode (0 otherwise)
+        double _replica_weight;   /// 1/n_replicas in cosmic oversampling mode (1 otherwise)
+        double _nu_pt_over_p;     /// _nu_pt/_nu_p (feature of the cosmic vs nue discriminant)
+        double _discriminant;     /// score of the discriminant model (-1 without a model)
+        std::vector<UChar_t> _bootstrap; /// Poisson(1) bootstrap weights of the event (SetBootstrapReplicas)
 
         
         // prepare TTree with variables
@@ -139,10 +217,31 @@ namespace ertool {
 
         ::fluxRW _fluxRW;
 
+        std::string _discriminant_filename;
+        std::string _discriminant_name;
+        double _discriminant_cut = -std::numeric_limits<double>::max();
+        /// The discriminant model, and its score of one value per feature
+        std::unique_ptr<TObject> _discriminant_model;
+        std::function<double(const double*)> _discriminant_score;
+        /// Result tree branch of each feature: address and leaf type ('D', 'F', 'I' or 'O')
+        std::vector<std::pair<const void*, char> > _discriminant_inputs;
+        /// Feature values of the current row (allocated once)
+        std::vector<double> _discriminant_values;
+
         // ertool_helper::ParticleID singleE_particleID;
         ertool::Shower singleE_shower;
 
         bool _LEESample_mode = false;
+        bool _LEEWeightColumn_mode = false;
+
+        size_t _n_replicas = 1;
+        bool _x_shift_disabled = false;
+        size_t _n_bootstrap = 0;
+
+        /// Events analyzed (= passed all filters), rows and weight sums of this job, written as <treename>_counters
+        ::lee::util::JobCounters _counters;
+        /// Center of the beam gate window [us]
+        double _BGW_center = 4.35;
 
         // Variables for B.I.T.E analysis
         double _dist_2wall_shr ;  /// Electron shower backwards distance 2 wall
@@ -163,6 +262,7 @@ namespace ertool {
         ::lee::LEERW _rw;
         ::geoalgo::GeoAlgo _geoalg;
         ::lee::util::ECCQECalculator _eccqecalc;
+        ::lee::util::CounterRNG _rng;
 
     };
 }
@@ -0,0 +1,105 @@
+#ifndef ERTOOL_ERANARECOCACHE_CXX
+#define ERTOOL_ERANARECOCACHE_CXX
+
+#include "ERAnaRecoCache.h"
+
+namespace ertool {
+
+  ERAnaRecoCache::ERAnaRecoCache(const std::string& name)
+    : AnaBase(name)
+    , _cache_filename("ertool_reco_cache.root")
+    , _store_mc(true)
+    , _require_nue(false)
+    , _cache_file(nullptr)
+    , _cache_tree(nullptr)
+    , _data(nullptr)
+    , _graph(nullptr)
+    , _mc_data(nullptr)
+    , _mc_graph(nullptr)
+  {}
+
+  void ERAnaRecoCache::Reset()
+  {}
+
+  void ERAnaRecoCache::AcceptPSet(const ::fcllite::PSet& cfg)
+  {}
+
+  void ERAnaRecoCache::ProcessBegin()
+  {
+    _n_evts_seen = 0;
+    _n_evts_stored = 0;
+
+    // the cache file and tree must not become the current directory of the other modules
+    TDirectory::TContext context;
+    _cache_file = TFile::Open(_cache_filename.c_str(), "RECREATE");
+    if (!_cache_file || _cache_file->IsZombie()) {
+      std::cout << "ERROR!! ERAnaRecoCache could not open cache file " << _cache_filename << std::endl;
+      _cache_file = nullptr;
+      return;
+    }
+    // Reconstructed objects compress well, and the cache is read back many times
+    _cache_file->SetCompressionLevel(5);
+    _cache_file->cd();
+
+    if (!_data)  _data  = new EventData;
+    if (!_graph) _graph = new ParticleGraph;
+    _cache_tree = new TTree(TreeName(), "ERTool reconstruction cache");
+    _cache_tree->Branch("data", &_data);
+    _cache_tree->Branch("graph", &_graph);
+
+    if (_store_mc) {
+      if (!_mc_data)  _mc_data  = new EventData;
+      if (!_mc_graph) _mc_graph = new ParticleGraph;
+      _cache_tree->Branch("mc_data", &_mc_data);
+      _cache_tree->Branch("mc_graph", &_mc_graph);
+    }
+  }
+
+  bool ERAnaRecoCache::Analyze(const EventData &data, const ParticleGraph &graph)
+  {
+    _n_evts_seen++;
+
+    if (!_cache_tree) return false;
+
+    if (_require_nue) {
+      bool reco = false;
+      for ( auto const & p : graph.GetParticleArray() )
+        if ( abs(p.PdgCode()) == 12 ) {
+          reco = true;
+          break;
+        }
+      if (!reco) return false;
+    }
+
+    *_data = data;
+    *_graph = graph;
+    if (_store_mc) {
+      *_mc_data = MCEventData();
+      *_mc_graph = MCParticleGraph();
+    }
+
+    _cache_tree->Fill();
+    _n_evts_stored++;
+
+    return true;
+  }
+
+  void ERAnaRecoCache::ProcessEnd(TFile* fout)
+  {
+    if (_cache_file) {
+      TDirectory::TContext context;
+      _cache_file->cd();
+      _cache_tree->Write();
+      _cache_file->Close();
+      delete _cache_file;
+      _cache_file = nullptr;
+      _cache_tree = nullptr;
+    }
+
+    std::cout << _n_evts_seen << " events seen, " << _n_evts_stored
+              << " events stored in reco cache file " << _cache_filename << "." << std::endl;
+  }
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * \file ERAnaRecoCache.h
+ *
+ * \ingroup ERAnalysis
+ *
+ * \brief Class def header for a class ERAnaRecoCache
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ERAnalysis
+
+    @{*/
+
+#ifndef ERTOOL_ERANARECOCACHE_H
+#define ERTOOL_ERANARECOCACHE_H
+
+#include "ERTool/Base/AnaBase.h"
+#include "TFile.h"
+#include "TTree.h"
+#include <string>
+
+namespace ertool {
+
+  /**
+     \class ERAnaRecoCache
+     Saves the reconstructed ParticleGraph and EventData (and their MC counterparts)
+     of every event into a compact cache file, after the whole ERTool algorithm chain ran.
+     The cache can then be replayed with ERCacheReplay, which only runs the AnaBase modules
+     (IE ERAnaLowEnergyExcess) and skips every algorithm.
+   */
+  class ERAnaRecoCache : public AnaBase {
+
+  public:
+
+    /// Default constructor
+    ERAnaRecoCache(const std::string& name = "ERAnaRecoCache");
+
+    /// Default destructor
+    virtual ~ERAnaRecoCache() {}
+
+    /// Reset function
+    virtual void Reset();
+
+    /// Function to accept fclite::PSet
+    void AcceptPSet(const ::fcllite::PSet& cfg);
+
+    /// Called @ before processing the first event sample
+    void ProcessBegin();
+
+    /// Function to store the event in the cache tree
+    bool Analyze(const EventData &data, const ParticleGraph &ps);
+
+    /// Called after processing the last event sample
+    void ProcessEnd(TFile* fout = nullptr);
+
+    /// Name of the cache file to be written (separate from the ana output file)
+    void SetCacheFileName(const std::string& name) { _cache_filename = name; }
+
+    /// Whether to also store the MC EventData and ParticleGraph (needed for MC matching, weights)
+    void SetStoreMC(bool flag) { _store_mc = flag; }
+
+    /// Only store events in which a nue was reconstructed (everything else is skipped by
+    /// ERAnaLowEnergyExcess anyway). Note event counters in the replayed modules then only
+    /// see these events.
+    void SetRequireNue(bool flag) { _require_nue = flag; }
+
+    /// Name of the TTree in the cache file
+    static const char* TreeName() { return "ertool_reco_cache"; }
+
+  private:
+
+    std::string _cache_filename;
+    bool _store_mc;
+    bool _require_nue;
+
+    TFile* _cache_file;
+    TTree* _cache_tree;
+
+    /// Copies of the event that are bound to the cache tree branches
+    EventData*     _data;
+    ParticleGraph* _graph;
+    EventData*     _mc_data;
+    ParticleGraph* _mc_graph;
+
+    size_t _n_evts_seen;
+    size_t _n_evts_stored;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
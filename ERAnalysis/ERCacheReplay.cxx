@@ -0,0 +1,78 @@
+#ifndef ERTOOL_ERCACHEREPLAY_CXX
+#define ERTOOL_ERCACHEREPLAY_CXX
+
+#include "ERCacheReplay.h"
+#include "TFile.h"
+#include <algorithm>
+
+namespace ertool {
+
+  ERCacheReplay::ERCacheReplay()
+    : _output_filename("")
+  {}
+
+  bool ERCacheReplay::Run(size_t start, size_t nevents)
+  {
+    if (_input_files.empty()) {
+      std::cout << "ERROR!! ERCacheReplay was not given any input cache file!" << std::endl;
+      return false;
+    }
+
+    TChain chain(ERAnaRecoCache::TreeName());
+    for (auto const& name : _input_files)
+      chain.Add(name.c_str());
+
+    EventData*     data = nullptr;
+    ParticleGraph* graph = nullptr;
+    EventData*     mc_data = nullptr;
+    ParticleGraph* mc_graph = nullptr;
+    chain.SetBranchAddress("data", &data);
+    chain.SetBranchAddress("graph", &graph);
+
+    // MC copies are optional in the cache (see ERAnaRecoCache::SetStoreMC)
+    bool has_mc = chain.GetBranch("mc_data") && chain.GetBranch("mc_graph");
+    if (has_mc) {
+      chain.SetBranchAddress("mc_data", &mc_data);
+      chain.SetBranchAddress("mc_graph", &mc_graph);
+    }
+    _mgr._mc_for_ana = has_mc;
+
+    size_t n_entries = chain.GetEntries();
+    size_t end = nevents ? std::min(n_entries, start + nevents) : n_entries;
+
+    if (!_mgr.Initialize()) return false;
+
+    for (size_t entry = start; entry < end; ++entry) {
+
+      chain.GetEntry(entry);
+
+      _mgr.EventDataWriteable() = *data;
+      _mgr.ParticleGraphWriteable() = *graph;
+      if (has_mc) {
+        _mgr.MCEventDataWriteable() = *mc_data;
+        _mgr.MCParticleGraphWriteable() = *mc_graph;
+      }
+
+      _mgr.Process();
+    }
+
+    TFile* fout = nullptr;
+    if (!_output_filename.empty())
+      fout = TFile::Open(_output_filename.c_str(), "RECREATE");
+
+    bool status = _mgr.Finalize(fout);
+
+    if (fout) {
+      fout->Close();
+      delete fout;
+    }
+
+    std::cout << "ERCacheReplay replayed " << (end > start ? end - start : 0)
+              << " cached events." << std::endl;
+
+    return status;
+  }
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * \file ERCacheReplay.h
+ *
+ * \ingroup ERAnalysis
+ *
+ * \brief Class def header for a class ERCacheReplay
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ERAnalysis
+
+    @{*/
+
+#ifndef ERTOOL_ERCACHEREPLAY_H
+#define ERTOOL_ERCACHEREPLAY_H
+
+#include "ERTool/Base/Manager.h"
+#include "ERAnaRecoCache.h"
+#include "TChain.h"
+#include <string>
+#include <vector>
+
+namespace ertool {
+
+  /**
+     \class ERCacheReplay
+     Replays ERTool reconstruction cache files written by ERAnaRecoCache.
+     For every cached event the stored EventData/ParticleGraph (and MC copies) are handed
+     to the ERTool manager, which then only runs the AnaBase modules that were added to it.
+     Do not add any algorithms to _mgr: the cached ParticleGraph is already reconstructed.
+   */
+  class ERCacheReplay {
+
+  public:
+
+    /// Default constructor
+    ERCacheReplay();
+
+    /// Default destructor
+    virtual ~ERCacheReplay() {}
+
+    /// Add a cache file written by ERAnaRecoCache
+    void AddInputFile(const std::string& name) { _input_files.push_back(name); }
+
+    /// Output file handed to the AnaBase modules' ProcessEnd
+    void SetOutputFile(const std::string& name) { _output_filename = name; }
+
+    /// Replay nevents events starting from start (all events if nevents is 0)
+    bool Run(size_t start = 0, size_t nevents = 0);
+
+    /// ERTool manager: add the AnaBase modules (IE ERAnaLowEnergyExcess) here
+    ::ertool::Manager _mgr;
+
+  private:
+
+    std::vector<std::string> _input_files;
+    std::string _output_filename;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,107 @@
+#ifndef ERTOOL_ERINPUTSUMMARYDRIVER_CXX
+#define ERTOOL_ERINPUTSUMMARYDRIVER_CXX
+
+#include "ERInputSummaryDriver.h"
+#include "TFile.h"
+
+namespace ertool {
+
+  ERInputSummaryDriver::ERInputSummaryDriver()
+    : _output_filename("")
+  {}
+
+  void ERInputSummaryDriver::Load(const summary::InputSummaryEvent& evt, ::ertool::io::EmptyInput& strm)
+  {
+    strm.SetID(evt.event, evt.run, evt.subrun);
+
+    for (size_t i = 0; i < evt.NShowers(); ++i) {
+      ::ertool::Shower shower(::geoalgo::Vector(evt.shr_x[i], evt.shr_y[i], evt.shr_z[i]),
+                              ::geoalgo::Vector(evt.shr_dx[i], evt.shr_dy[i], evt.shr_dz[i]),
+                              evt.shr_length[i], evt.shr_radius[i]);
+      shower._energy = evt.shr_energy[i];
+      shower._dedx = evt.shr_dedx[i];
+      shower._time = evt.shr_time[i];
+      strm.Add(shower, ::ertool::RecoInputID_t(i, "summary"));
+    }
+
+    for (size_t i = 0; i < evt.NTracks(); ++i) {
+      ::ertool::Track track;
+      track.reserve(evt.trk_npts[i]);
+      for (size_t ipt = evt.trk_first_pt[i]; ipt < evt.trk_first_pt[i] + evt.trk_npts[i]; ++ipt)
+        track.push_back(::geoalgo::Vector(evt.trk_pts[3 * ipt], evt.trk_pts[3 * ipt + 1], evt.trk_pts[3 * ipt + 2]));
+      track._energy = evt.trk_energy[i];
+      track._dedx = evt.trk_dedx[i];
+      track._time = evt.trk_time[i];
+      strm.Add(track, ::ertool::RecoInputID_t(i, "summary"));
+    }
+
+    for (size_t i = 0; i < evt.NFlashes(); ++i) {
+      ::ertool::Flash flash;
+      flash._t = evt.fl_t[i];
+      flash._x = evt.fl_x[i];
+      flash._y = evt.fl_y[i];
+      flash._z = evt.fl_z[i];
+      flash._npe_v.assign(evt.fl_npe.begin() + evt.fl_first_pmt[i],
+                          evt.fl_npe.begin() + evt.fl_first_pmt[i] + evt.fl_npmt[i]);
+      strm.Add(flash, ::ertool::RecoInputID_t(i, "summary"));
+    }
+  }
+
+  bool ERInputSummaryDriver::Run(size_t start, size_t nevents)
+  {
+    if (_input_files.empty()) {
+      std::cout << "ERROR!! ERInputSummaryDriver was not given any input summary file!" << std::endl;
+      return false;
+    }
+
+    if (!_mgr.Initialize()) return false;
+
+    auto& strm = dynamic_cast< ::ertool::io::EmptyInput& >(_mgr.InputStream());
+
+    summary::InputSummaryEvent evt;
+    size_t entry = 0;
+    size_t n_processed = 0;
+
+    for (auto const& name : _input_files) {
+
+      summary::InputSummaryReader reader;
+      if (!reader.Open(name)) return false;
+
+      while (!nevents || n_processed < nevents) {
+
+        // Skipping does not decode the event, so jumping to start is cheap
+        if (entry < start) {
+          if (!reader.Skip()) break;
+          entry++;
+          continue;
+        }
+
+        if (!reader.Next(evt)) break;
+        entry++;
+
+        _mgr.ClearData();
+        Load(evt, strm);
+        _mgr.Process();
+        n_processed++;
+      }
+    }
+
+    TFile* fout = nullptr;
+    if (!_output_filename.empty())
+      fout = TFile::Open(_output_filename.c_str(), "RECREATE");
+
+    bool status = _mgr.Finalize(fout);
+
+    if (fout) {
+      fout->Close();
+      delete fout;
+    }
+
+    std::cout << "ERInputSummaryDriver processed " << n_processed << " events." << std::endl;
+
+    return status;
+  }
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * \file ERInputSummaryDriver.h
+ *
+ * \ingroup ERAnalysis
+ *
+ * \brief Class def header for a class ERInputSummaryDriver
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ERAnalysis
+
+    @{*/
+
+#ifndef ERTOOL_ERINPUTSUMMARYDRIVER_H
+#define ERTOOL_ERINPUTSUMMARYDRIVER_H
+
+#include "ERTool/Base/Manager.h"
+#include "ERTool/Base/EmptyInput.h"
+#include "InputSummary.h"
+#include <string>
+#include <vector>
+
+namespace ertool {
+
+  /**
+     \class ERInputSummaryDriver
+     Runs the ERTool chain (algorithms and anas added to _mgr) over input summary files
+     written by ERAnaInputSummary, instead of the full larlite mcinfo/opreco/reco files.
+     Note the summary only holds the reconstruction inputs: there is no MC particle graph,
+     so ana modules that need MC truth (IE weights, MC matching) still need the larlite files
+     (or an ERAnaRecoCache cache).
+   */
+  class ERInputSummaryDriver {
+
+  public:
+
+    /// Default constructor
+    ERInputSummaryDriver();
+
+    /// Default destructor
+    virtual ~ERInputSummaryDriver() {}
+
+    /// Add an input summary file
+    void AddInputFile(const std::string& name) { _input_files.push_back(name); }
+
+    /// Output file handed to the algorithms' and anas' ProcessEnd
+    void SetOutputFile(const std::string& name) { _output_filename = name; }
+
+    /// Process nevents events starting from start (all events if nevents is 0)
+    bool Run(size_t start = 0, size_t nevents = 0);
+
+    /// Fill the ERTool input stream with the content of one summary event
+    static void Load(const summary::InputSummaryEvent& evt, ::ertool::io::EmptyInput& strm);
+
+    /// ERTool manager: add the algorithms and anas here
+    ::ertool::Manager _mgr;
+
+  private:
+
+    std::vector<std::string> _input_files;
+    std::string _output_filename;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
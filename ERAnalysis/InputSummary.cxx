@@ -0,0 +1,390 @@
+#ifndef ERTOOL_INPUTSUMMARY_CXX
+#define ERTOOL_INPUTSUMMARY_CXX
+
+#include "InputSummary.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace ertool {
+
+  namespace summary {
+
+    namespace {
+
+      const char kMagic[8] = {'L', 'E', 'E', 'I', 'S', 'U', 'M', '1'};
+
+      /// # of 32 bit words in the per-event record header
+      const size_t kNHeaderWords = 9;
+
+      template <class T>
+      void Append(std::vector<char>& buf, const T* p, size_t n) {
+        if (!n) return;
+        size_t pos = buf.size();
+        buf.resize(pos + n * sizeof(T));
+        std::memcpy(&buf[pos], p, n * sizeof(T));
+      }
+
+      template <class T>
+      void Append(std::vector<char>& buf, const std::vector<T>& v) { Append(buf, v.data(), v.size()); }
+
+      /// Cursor over a record buffer, throws if the record is truncated
+      class Cursor {
+      public:
+        Cursor(const std::vector<char>& buf) : _buf(buf), _pos(0) {}
+        template <class T>
+        void Read(std::vector<T>& v, size_t n) {
+          if (_pos + n * sizeof(T) > _buf.size())
+            throw std::runtime_error("InputSummaryReader: truncated event record!");
+          v.resize(n);
+          if (n) std::memcpy(v.data(), &_buf[_pos], n * sizeof(T));
+          _pos += n * sizeof(T);
+        }
+      private:
+        const std::vector<char>& _buf;
+        size_t _pos;
+      };
+
+      /// Whether every step of a track fits in an int16 number of quanta
+      bool IsQuantizable(const float* pts, size_t npts, float quantum) {
+        float prev[3] = {pts[0], pts[1], pts[2]};
+        for (size_t i = 1; i < npts; ++i) {
+          for (size_t c = 0; c < 3; ++c) {
+            long q = std::lround((pts[3 * i + c] - prev[c]) / quantum);
+            if (q > std::numeric_limits<int16_t>::max() || q < std::numeric_limits<int16_t>::min())
+              return false;
+            prev[c] = prev[c] + static_cast<float>(q) * quantum;
+          }
+        }
+        return true;
+      }
+    }
+
+    void InputSummaryEvent::Clear() {
+
+      run = subrun = event = -1;
+
+      for (auto v : { &shr_x, &shr_y, &shr_z, &shr_dx, &shr_dy, &shr_dz,
+                      &shr_length, &shr_radius, &shr_energy, &shr_dedx, &shr_time,
+                      &trk_energy, &trk_dedx, &trk_time, &trk_pts,
+                      &fl_t, &fl_x, &fl_y, &fl_z, &fl_npe })
+        v->clear();
+
+      trk_npts.clear();
+      trk_first_pt.clear();
+      fl_npmt.clear();
+      fl_first_pmt.clear();
+    }
+
+    void InputSummaryEvent::AddShower(float x, float y, float z, float dx, float dy, float dz,
+                                      float length, float radius, float energy, float dedx, float time) {
+      shr_x.push_back(x);   shr_y.push_back(y);   shr_z.push_back(z);
+      shr_dx.push_back(dx); shr_dy.push_back(dy); shr_dz.push_back(dz);
+      shr_length.push_back(length);
+      shr_radius.push_back(radius);
+      shr_energy.push_back(energy);
+      shr_dedx.push_back(dedx);
+      shr_time.push_back(time);
+    }
+
+    void InputSummaryEvent::AddTrack(const float* pts, size_t npts, float energy, float dedx, float time) {
+      trk_first_pt.push_back(trk_pts.size() / 3);
+      trk_npts.push_back(npts);
+      trk_pts.insert(trk_pts.end(), pts, pts + 3 * npts);
+      trk_energy.push_back(energy);
+      trk_dedx.push_back(dedx);
+      trk_time.push_back(time);
+    }
+
+    void InputSummaryEvent::AddFlash(float t, float x, float y, float z, const float* npe, size_t npmt) {
+      fl_t.push_back(t);
+      fl_x.push_back(x);
+      fl_y.push_back(y);
+      fl_z.push_back(z);
+      fl_first_pmt.push_back(fl_npe.size());
+      fl_npmt.push_back(npmt);
+      fl_npe.insert(fl_npe.end(), npe, npe + npmt);
+    }
+
+    //
+    // Writer
+    //
+    InputSummaryWriter::InputSummaryWriter()
+      : _fp(nullptr)
+      , _quantum(kDefaultQuantum)
+      , _n_events(0)
+      , _n_bytes(0)
+    {}
+
+    InputSummaryWriter::~InputSummaryWriter() { Close(); }
+
+    bool InputSummaryWriter::Open(const std::string& fname, float quantum) {
+
+      Close();
+
+      if (quantum <= 0) {
+        std::cerr << "InputSummaryWriter: trajectory quantum must be positive!" << std::endl;
+        return false;
+      }
+
+      _fp = std::fopen(fname.c_str(), "wb");
+      if (!_fp) {
+        std::cerr << "InputSummaryWriter: could not open " << fname << " for writing!" << std::endl;
+        return false;
+      }
+
+      _quantum = quantum;
+      _n_events = 0;
+      _n_bytes = 0;
+
+      std::fwrite(kMagic, 1, sizeof(kMagic), _fp);
+      std::fwrite(&kVersion, sizeof(kVersion), 1, _fp);
+      std::fwrite(&_quantum, sizeof(_quantum), 1, _fp);
+      _n_bytes += sizeof(kMagic) + sizeof(kVersion) + sizeof(_quantum);
+
+      return true;
+    }
+
+    bool InputSummaryWriter::Write(const InputSummaryEvent& evt) {
+
+      if (!_fp) return false;
+
+      size_t ntrk = evt.NTracks();
+
+      // First decide which tracks can be quantized, and count their steps
+      std::vector<uint8_t> quantized(ntrk, 1);
+      uint32_t n_qsteps = 0;
+      uint32_t n_rsteps = 0;
+      for (size_t i = 0; i < ntrk; ++i) {
+        size_t npts = evt.trk_npts[i];
+        if (npts < 2) continue;
+        quantized[i] = IsQuantizable(&evt.trk_pts[3 * evt.trk_first_pt[i]], npts, _quantum);
+        if (quantized[i]) n_qsteps += npts - 1;
+        else              n_rsteps += npts - 1;
+      }
+
+      std::vector<float>   first_pts(3 * ntrk, 0.);
+      std::vector<int16_t> qsteps;
+      std::vector<float>   rsteps;
+      qsteps.reserve(3 * n_qsteps);
+      rsteps.reserve(3 * n_rsteps);
+
+      for (size_t i = 0; i < ntrk; ++i) {
+
+        size_t npts = evt.trk_npts[i];
+        if (!npts) continue;
+        const float* pts = &evt.trk_pts[3 * evt.trk_first_pt[i]];
+
+        float prev[3] = {pts[0], pts[1], pts[2]};
+        for (size_t c = 0; c < 3; ++c) first_pts[3 * i + c] = prev[c];
+
+        for (size_t ipt = 1; ipt < npts; ++ipt) {
+          for (size_t c = 0; c < 3; ++c) {
+            if (quantized[i]) {
+              // Step from the previous *quantized* point so the error does not accumulate
+              int16_t q = std::lround((pts[3 * ipt + c] - prev[c]) / _quantum);
+              qsteps.push_back(q);
+              prev[c] = prev[c] + static_cast<float>(q) * _quantum;
+            }
+            else
+              rsteps.push_back(pts[3 * ipt + c] - pts[3 * (ipt - 1) + c]);
+          }
+        }
+      }
+
+      uint32_t header[kNHeaderWords] = {
+        static_cast<uint32_t>(evt.run),
+        static_cast<uint32_t>(evt.subrun),
+        static_cast<uint32_t>(evt.event),
+        static_cast<uint32_t>(evt.NShowers()),
+        static_cast<uint32_t>(ntrk),
+        static_cast<uint32_t>(evt.NFlashes()),
+        n_qsteps,
+        n_rsteps,
+        static_cast<uint32_t>(evt.fl_npe.size())
+      };
+
+      _buf.clear();
+      Append(_buf, header, kNHeaderWords);
+
+      Append(_buf, evt.shr_x);      Append(_buf, evt.shr_y);  Append(_buf, evt.shr_z);
+      Append(_buf, evt.shr_dx);     Append(_buf, evt.shr_dy); Append(_buf, evt.shr_dz);
+      Append(_buf, evt.shr_length); Append(_buf, evt.shr_radius);
+      Append(_buf, evt.shr_energy); Append(_buf, evt.shr_dedx); Append(_buf, evt.shr_time);
+
+      Append(_buf, evt.trk_npts);
+      Append(_buf, quantized);
+      Append(_buf, evt.trk_energy); Append(_buf, evt.trk_dedx); Append(_buf, evt.trk_time);
+      Append(_buf, first_pts);
+      Append(_buf, qsteps);
+      Append(_buf, rsteps);
+
+      Append(_buf, evt.fl_t); Append(_buf, evt.fl_x); Append(_buf, evt.fl_y); Append(_buf, evt.fl_z);
+      Append(_buf, evt.fl_npmt);
+      Append(_buf, evt.fl_npe);
+
+      uint32_t record_size = _buf.size();
+      if (std::fwrite(&record_size, sizeof(record_size), 1, _fp) != 1 ||
+          std::fwrite(_buf.data(), 1, _buf.size(), _fp) != _buf.size()) {
+        std::cerr << "InputSummaryWriter: failed to write event record!" << std::endl;
+        return false;
+      }
+
+      _n_bytes += sizeof(record_size) + _buf.size();
+      _n_events++;
+      return true;
+    }
+
+    void InputSummaryWriter::Close() {
+      if (_fp) std::fclose(_fp);
+      _fp = nullptr;
+    }
+
+    //
+    // Reader
+    //
+    InputSummaryReader::InputSummaryReader()
+      : _fp(nullptr)
+      , _quantum(kDefaultQuantum)
+    {}
+
+    InputSummaryReader::~InputSummaryReader() { Close(); }
+
+    bool InputSummaryReader::Open(const std::string& fname) {
+
+      Close();
+
+      _fp = std::fopen(fname.c_str(), "rb");
+      if (!_fp) {
+        std::cerr << "InputSummaryReader: could not open " << fname << "!" << std::endl;
+        return false;
+      }
+
+      char magic[sizeof(kMagic)];
+      uint32_t version = 0;
+      if (std::fread(magic, 1, sizeof(magic), _fp) != sizeof(magic) ||
+          std::memcmp(magic, kMagic, sizeof(kMagic)) ||
+          std::fread(&version, sizeof(version), 1, _fp) != 1 ||
+          std::fread(&_quantum, sizeof(_quantum), 1, _fp) != 1) {
+        std::cerr << "InputSummaryReader: " << fname << " is not an input summary file!" << std::endl;
+        Close();
+        return false;
+      }
+      if (version != kVersion) {
+        std::cerr << "InputSummaryReader: " << fname << " has format version " << version
+                  << " but this reader understands version " << kVersion << "!" << std::endl;
+        Close();
+        return false;
+      }
+
+      return true;
+    }
+
+    bool InputSummaryReader::ReadRecord() {
+
+      if (!_fp) return false;
+
+      uint32_t record_size = 0;
+      if (std::fread(&record_size, sizeof(record_size), 1, _fp) != 1)
+        return false;
+
+      _buf.resize(record_size);
+      if (std::fread(_buf.data(), 1, record_size, _fp) != record_size)
+        throw std::runtime_error("InputSummaryReader: truncated event record!");
+
+      return true;
+    }
+
+    bool InputSummaryReader::Skip() {
+
+      if (!_fp) return false;
+
+      uint32_t record_size = 0;
+      if (std::fread(&record_size, sizeof(record_size), 1, _fp) != 1)
+        return false;
+
+      return !std::fseek(_fp, record_size, SEEK_CUR);
+    }
+
+    bool InputSummaryReader::Next(InputSummaryEvent& evt) {
+
+      if (!ReadRecord()) return false;
+
+      Cursor cur(_buf);
+
+      std::vector<uint32_t> header;
+      cur.Read(header, kNHeaderWords);
+
+      evt.run    = static_cast<int32_t>(header[0]);
+      evt.subrun = static_cast<int32_t>(header[1]);
+      evt.event  = static_cast<int32_t>(header[2]);
+      size_t nshr     = header[3];
+      size_t ntrk     = header[4];
+      size_t nfl      = header[5];
+      size_t n_qsteps = header[6];
+      size_t n_rsteps = header[7];
+      size_t n_pmt    = header[8];
+
+      cur.Read(evt.shr_x, nshr);      cur.Read(evt.shr_y, nshr);  cur.Read(evt.shr_z, nshr);
+      cur.Read(evt.shr_dx, nshr);     cur.Read(evt.shr_dy, nshr); cur.Read(evt.shr_dz, nshr);
+      cur.Read(evt.shr_length, nshr); cur.Read(evt.shr_radius, nshr);
+      cur.Read(evt.shr_energy, nshr); cur.Read(evt.shr_dedx, nshr); cur.Read(evt.shr_time, nshr);
+
+      std::vector<uint8_t> quantized;
+      std::vector<float>   first_pts;
+      std::vector<int16_t> qsteps;
+      std::vector<float>   rsteps;
+      cur.Read(evt.trk_npts, ntrk);
+      cur.Read(quantized, ntrk);
+      cur.Read(evt.trk_energy, ntrk); cur.Read(evt.trk_dedx, ntrk); cur.Read(evt.trk_time, ntrk);
+      cur.Read(first_pts, 3 * ntrk);
+      cur.Read(qsteps, 3 * n_qsteps);
+      cur.Read(rsteps, 3 * n_rsteps);
+
+      cur.Read(evt.fl_t, nfl); cur.Read(evt.fl_x, nfl); cur.Read(evt.fl_y, nfl); cur.Read(evt.fl_z, nfl);
+      cur.Read(evt.fl_npmt, nfl);
+      cur.Read(evt.fl_npe, n_pmt);
+
+      // Rebuild the track trajectories
+      evt.trk_first_pt.resize(ntrk);
+      evt.trk_pts.clear();
+      size_t iq = 0, ir = 0;
+      for (size_t i = 0; i < ntrk; ++i) {
+        size_t npts = evt.trk_npts[i];
+        evt.trk_first_pt[i] = evt.trk_pts.size() / 3;
+        if (!npts) continue;
+        float prev[3] = {first_pts[3 * i], first_pts[3 * i + 1], first_pts[3 * i + 2]};
+        evt.trk_pts.insert(evt.trk_pts.end(), prev, prev + 3);
+        for (size_t ipt = 1; ipt < npts; ++ipt) {
+          for (size_t c = 0; c < 3; ++c) {
+            if (quantized[i]) prev[c] = prev[c] + static_cast<float>(qsteps.at(iq++)) * _quantum;
+            else              prev[c] = prev[c] + rsteps.at(ir++);
+          }
+          evt.trk_pts.insert(evt.trk_pts.end(), prev, prev + 3);
+        }
+      }
+
+      // Rebuild the flash PMT offsets
+      evt.fl_first_pmt.resize(nfl);
+      size_t offset = 0;
+      for (size_t i = 0; i < nfl; ++i) {
+        evt.fl_first_pmt[i] = offset;
+        offset += evt.fl_npmt[i];
+      }
+      if (offset != n_pmt)
+        throw std::runtime_error("InputSummaryReader: inconsistent flash PMT count in event record!");
+
+      return true;
+    }
+
+    void InputSummaryReader::Close() {
+      if (_fp) std::fclose(_fp);
+      _fp = nullptr;
+    }
+
+  }
+}
+
+#endif
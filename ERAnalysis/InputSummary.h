@@ -0,0 +1,182 @@
+/**
+ * \file InputSummary.h
+ *
+ * \ingroup ERAnalysis
+ *
+ * \brief Compact flat-binary summary of the ERTool inputs (showers, tracks, flashes) of each event
+ *
+ * File layout (native endianness, all floats are 32 bit):
+ *  - file header : 8 byte magic "LEEISUM1", uint32 version, float trajectory quantum [cm]
+ *  - per event   : uint32 record size in bytes (excluding this word), followed by
+ *                  int32 run, subrun, event, uint32 # showers, # tracks, # flashes,
+ *                  # quantized track steps, # raw track steps, # flash PMT entries,
+ *                  and then one contiguous column per variable (see InputSummaryEvent).
+ *
+ * Track trajectories store their first point as floats and every following point as
+ * an int16 step (per coordinate) from the previous, already-quantized point, in units
+ * of the trajectory quantum, so the quantization error does not accumulate along the track.
+ * Tracks with a step too large for int16 are stored with float steps instead.
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ERAnalysis
+
+    @{*/
+
+#ifndef ERTOOL_INPUTSUMMARY_H
+#define ERTOOL_INPUTSUMMARY_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ertool {
+
+  namespace summary {
+
+    /// Current version of the file format
+    const uint32_t kVersion = 1;
+
+    /// Default trajectory quantum [cm]
+    const float kDefaultQuantum = 0.05;
+
+    /**
+       \struct InputSummaryEvent
+       Decoded, columnar content of one event in an input summary file.
+       Track points are flattened as (x,y,z) triplets, track i owning points
+       [trk_first_pt[i], trk_first_pt[i] + trk_npts[i]).
+       Flash i owns PMT entries [fl_first_pmt[i], fl_first_pmt[i] + fl_npmt[i]).
+    */
+    struct InputSummaryEvent {
+
+      int32_t run;
+      int32_t subrun;
+      int32_t event;
+
+      // Showers
+      std::vector<float> shr_x, shr_y, shr_z;
+      std::vector<float> shr_dx, shr_dy, shr_dz;
+      std::vector<float> shr_length, shr_radius;
+      std::vector<float> shr_energy, shr_dedx, shr_time;
+
+      // Tracks
+      std::vector<uint32_t> trk_npts;
+      std::vector<uint32_t> trk_first_pt;
+      std::vector<float> trk_energy, trk_dedx, trk_time;
+      std::vector<float> trk_pts;
+
+      // Flashes
+      std::vector<float> fl_t, fl_x, fl_y, fl_z;
+      std::vector<uint32_t> fl_npmt;
+      std::vector<uint32_t> fl_first_pmt;
+      std::vector<float> fl_npe;
+
+      /// Clear all columns
+      void Clear();
+
+      size_t NShowers() const { return shr_x.size(); }
+      size_t NTracks()  const { return trk_npts.size(); }
+      size_t NFlashes() const { return fl_t.size(); }
+
+      /// Add a shower (start point, direction, cone length/radius, energy, dE/dx, time)
+      void AddShower(float x, float y, float z, float dx, float dy, float dz,
+                     float length, float radius, float energy, float dedx, float time);
+
+      /// Add a track from a flat (x,y,z) point array of npts points
+      void AddTrack(const float* pts, size_t npts, float energy, float dedx, float time);
+
+      /// Add a flash from its per-PMT PE array
+      void AddFlash(float t, float x, float y, float z, const float* npe, size_t npmt);
+
+    };
+
+    /**
+       \class InputSummaryWriter
+       Appends InputSummaryEvent records to a summary file
+    */
+    class InputSummaryWriter {
+
+    public:
+
+      /// Default constructor
+      InputSummaryWriter();
+
+      /// Default destructor (closes the file)
+      ~InputSummaryWriter();
+
+      /// Open a new file (overwrites), with the trajectory quantum in cm
+      bool Open(const std::string& fname, float quantum = kDefaultQuantum);
+
+      /// Encode and write one event
+      bool Write(const InputSummaryEvent& evt);
+
+      /// Close the file
+      void Close();
+
+      /// Number of events written so far
+      size_t NEvents() const { return _n_events; }
+
+      /// Number of bytes written so far
+      size_t NBytes() const { return _n_bytes; }
+
+    private:
+
+      FILE* _fp;
+      float _quantum;
+      size_t _n_events;
+      size_t _n_bytes;
+
+      /// Encoding buffer, re-used between events
+      std::vector<char> _buf;
+
+    };
+
+    /**
+       \class InputSummaryReader
+       Sequentially reads and decodes InputSummaryEvent records from a summary file
+    */
+    class InputSummaryReader {
+
+    public:
+
+      /// Default constructor
+      InputSummaryReader();
+
+      /// Default destructor (closes the file)
+      ~InputSummaryReader();
+
+      /// Open an existing file and check its header
+      bool Open(const std::string& fname);
+
+      /// Read and decode the next event. Returns false at end of file.
+      bool Next(InputSummaryEvent& evt);
+
+      /// Skip the next event without decoding it. Returns false at end of file.
+      bool Skip();
+
+      /// Close the file
+      void Close();
+
+      /// Trajectory quantum of the open file [cm]
+      float Quantum() const { return _quantum; }
+
+    private:
+
+      /// Read the next record into _buf
+      bool ReadRecord();
+
+      FILE* _fp;
+      float _quantum;
+
+      /// Record buffer, re-used between events
+      std::vector<char> _buf;
+
+    };
+
+  }
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -14,6 +14,14 @@
 #pragma link C++ class ertool::ERAnaNCPi0Debug+;
 #pragma link C++ class ertool::ERAlgoTagEmulatedDeletionsCosmic+;
 #pragma link C++ class ertool::ERAnaCryCorsikaDebug+;
+#pragma link C++ class ertool::ERAnaRecoCache+;
+#pragma link C++ class ertool::ERCacheReplay+;
+#pragma link C++ class ertool::ERAnaInputSummary+;
+#pragma link C++ class ertool::ERInputSummaryDriver+;
+#pragma link C++ class ertool::summary::InputSummaryEvent;
+#pragma link C++ class ertool::summary::InputSummaryWriter;
+#pragma link C++ class ertool::summary::InputSummaryReader;
+#pragma link C++ class ertool::ERAlgoShowerPrePrune+;
 //ADD_NEW_CLASS ... do not change this line
 #endif
 
@@ -0,0 +1,51 @@
+import sys, os
+
+if len(sys.argv) < 3:
+    msg  = '\n'
+    msg += "Usage 1: %s $INPUT_ROOT_FILEs $OUTPUT_SUMMARY_FILE\n" % sys.argv[0]
+    msg += '\n'
+    sys.stderr.write(msg)
+    sys.exit(1)
+
+from ROOT import gSystem
+from ROOT import larlite as fmwk
+from ROOT import ertool
+
+# Create ana_processor instance
+my_proc = fmwk.ana_processor()
+
+# Set input root file
+for x in xrange(len(sys.argv)-2):
+    my_proc.add_input_file(sys.argv[x+1])
+
+# Specify IO mode
+my_proc.set_io_mode(fmwk.storage_manager.kREAD)
+
+my_proc.set_ana_output_file('')
+
+summary = ertool.ERAnaInputSummary()
+summary.SetSummaryFileName(sys.argv[-1])
+
+# Same ERTool input settings as GetERSelectionInstance in singleE_config.py,
+# but no algorithms: only the conversion to ertool objects is run
+anaunit = fmwk.ExampleERSelection()
+anaunit.SetShowerProducer(True,'mcreco')
+anaunit.SetTrackProducer(True,'mcreco')
+anaunit.SetFlashProducer('opflashSat')
+anaunit.setDisableXShift(False)
+anaunit.SetMinEDep(10)
+
+anaunit._mgr.ClearCfgFile()
+anaunit._mgr.AddCfgFile(os.environ['LARLITE_USERDEVDIR']+'/SelectionTool/ERTool/dat/ertool_default.cfg')
+anaunit._mgr.AddAna(summary)
+
+my_proc.add_process(anaunit)
+
+my_proc.run()
+
+# done!
+print
+print "Finished writing input summary file!"
+print
+
+sys.exit(0)
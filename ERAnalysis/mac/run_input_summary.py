@@ -0,0 +1,39 @@
+import sys, os
+
+if len(sys.argv) < 3:
+    msg  = '\n'
+    msg += "Usage 1: %s $INPUT_SUMMARY_FILEs $OUTPUT_ROOT_FILE\n" % sys.argv[0]
+    msg += '\n'
+    msg += "Summary files are made with make_input_summary.py\n"
+    msg += '\n'
+    sys.stderr.write(msg)
+    sys.exit(1)
+
+from ROOT import gSystem
+from ROOT import ertool
+from singleE_config import AddERSelectionAlgos
+
+driver = ertool.ERInputSummaryDriver()
+
+# Set input summary files
+for x in xrange(len(sys.argv)-2):
+    driver.AddInputFile(sys.argv[x+1])
+
+driver.SetOutputFile(sys.argv[-1])
+
+# Same algorithm chain as the usual selection instance.
+# There is no MC information in the summary, so only reco-level ana modules make sense here.
+AddERSelectionAlgos(driver._mgr)
+driver._mgr._profile_mode = True
+
+driver._mgr.ClearCfgFile()
+driver._mgr.AddCfgFile(os.environ['LARLITE_USERDEVDIR']+'/SelectionTool/ERTool/dat/ertool_default.cfg')
+
+driver.Run()
+
+# done!
+print
+print "Finished running over input summary files!"
+print
+
+sys.exit(0)
@@ -0,0 +1,37 @@
+import sys, os
+
+if len(sys.argv) < 3:
+    msg  = '\n'
+    msg += "Usage 1: %s $INPUT_CACHE_FILEs $OUTPUT_ROOT_FILE\n" % sys.argv[0]
+    msg += '\n'
+    msg += "Cache files are made by adding ertool.ERAnaRecoCache() to the ERTool manager\n"
+    msg += "of a normal selection job (see GetERSelectionInstance in singleE_config.py).\n"
+    msg += '\n'
+    sys.stderr.write(msg)
+    sys.exit(1)
+
+from ROOT import gSystem
+from ROOT import ertool
+
+# Create the replay driver (no algorithms run, only ana modules)
+replay = ertool.ERCacheReplay()
+
+# Set input cache files
+for x in xrange(len(sys.argv)-2):
+    replay.AddInputFile(sys.argv[x+1])
+
+replay.SetOutputFile(sys.argv[-1])
+
+LEEana = ertool.ERAnaLowEnergyExcess()
+LEEana.SetTreeName("beamNuE")
+
+replay._mgr.AddAna(LEEana)
+
+replay.Run()
+
+# done!
+print
+print "Finished replaying reco cache!"
+print
+
+sys.exit(0)
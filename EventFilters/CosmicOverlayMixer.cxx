@@ -0,0 +1,152 @@
+#ifndef LARLITE_COSMICOVERLAYMIXER_CXX
+#define LARLITE_COSMICOVERLAYMIXER_CXX
+
+#include "CosmicOverlayMixer.h"
+
+namespace larlite {
+
+  CosmicOverlayMixer::CosmicOverlayMixer()
+    : _mctruth_producer("generator")
+    , _mcshower_producer("mcreco")
+    , _mctrack_producer("mcreco")
+    , _flash_producer("opflashSat")
+    , _trackid_offset(10000000)
+    , _n_cosmic_entries(0)
+  {
+    _name = "CosmicOverlayMixer";
+    _fout = 0;
+  }
+
+  bool CosmicOverlayMixer::initialize() {
+
+    if (_cosmic_files.empty()) {
+      print(larlite::msg::kERROR, __FUNCTION__, Form("No cosmic input file given (use AddCosmicFile)!"));
+      return false;
+    }
+
+    _cosmic_io.set_io_mode(storage_manager::kREAD);
+    for (auto const& name : _cosmic_files)
+      _cosmic_io.add_in_filename(name);
+
+    // Only read the products that get mixed in
+    _cosmic_io.set_data_to_read(data::kMCTruth, _mctruth_producer);
+    _cosmic_io.set_data_to_read(data::kMCShower, _mcshower_producer);
+    _cosmic_io.set_data_to_read(data::kMCTrack, _mctrack_producer);
+    _cosmic_io.set_data_to_read(data::kOpFlash, _flash_producer);
+
+    if (!_cosmic_io.open()) {
+      print(larlite::msg::kERROR, __FUNCTION__, Form("Could not open the cosmic input!"));
+      return false;
+    }
+
+    _n_cosmic_entries = _cosmic_io.get_entries();
+    if (!_n_cosmic_entries) {
+      print(larlite::msg::kERROR, __FUNCTION__, Form("Cosmic input has no events!"));
+      return false;
+    }
+
+    _n_mixed_events = 0;
+
+    return true;
+  }
+
+  unsigned int CosmicOverlayMixer::OffsetID(unsigned int id) const {
+    return id == data::kINVALID_UINT ? id : id + _trackid_offset;
+  }
+
+  int CosmicOverlayMixer::OffsetID(int id) const {
+    return (id < 0 || id == data::kINVALID_INT) ? id : id + (int)_trackid_offset;
+  }
+
+  mcpart CosmicOverlayMixer::OffsetParticle(const mcpart& part) const {
+
+    // mcpart has no track ID setters: copy it field by field with the new IDs
+    mcpart mixed(OffsetID(part.TrackId()), part.PdgCode(), part.Process(), OffsetID(part.Mother()),
+                 part.Mass(), part.StatusCode());
+    mixed.SetPolarization(part.Polarization());
+    mixed.SetRescatter(part.Rescatter());
+    mixed.SetWeight(part.Weight());
+    mixed.SetGvtx(part.GetGvtx());
+    mixed.SetTrajectory(part.Trajectory());
+    for (auto const& daughter : part.Daughters())
+      mixed.AddDaughter(OffsetID(daughter));
+    return mixed;
+  }
+
+  bool CosmicOverlayMixer::analyze(storage_manager* storage) {
+
+    auto ev_mctruth  = storage->get_data<event_mctruth>(_mctruth_producer);
+    auto ev_mcshower = storage->get_data<event_mcshower>(_mcshower_producer);
+    auto ev_mctrack  = storage->get_data<event_mctrack>(_mctrack_producer);
+    auto ev_flash    = storage->get_data<event_opflash>(_flash_producer);
+    if (!ev_mctruth || !ev_mcshower || !ev_mctrack || !ev_flash) {
+      print(larlite::msg::kERROR, __FUNCTION__, Form("Did not find specified data products in the main input!"));
+      return false;
+    }
+
+    _rng.SetKey(storage->run_id(), storage->subrun_id(), storage->event_id(), ::lee::util::kCosmicOverlayStream);
+    _cosmic_io.go_to(_rng.Integer(_n_cosmic_entries));
+
+    auto cosmic_mctruth  = _cosmic_io.get_data<event_mctruth>(_mctruth_producer);
+    auto cosmic_mcshower = _cosmic_io.get_data<event_mcshower>(_mcshower_producer);
+    auto cosmic_mctrack  = _cosmic_io.get_data<event_mctrack>(_mctrack_producer);
+    auto cosmic_flash    = _cosmic_io.get_data<event_opflash>(_flash_producer);
+    if (!cosmic_mctruth || !cosmic_mcshower || !cosmic_mctrack || !cosmic_flash) {
+      print(larlite::msg::kERROR, __FUNCTION__, Form("Did not find specified data products in the cosmic input!"));
+      return false;
+    }
+
+    // after the neutrino mctruth, so the filters and the helper still find it first
+    ev_mctruth->reserve(ev_mctruth->size() + cosmic_mctruth->size());
+    for (auto const& truth : *cosmic_mctruth) {
+      mctruth mixed;
+      mixed.SetOrigin(truth.Origin());
+      for (auto const& part : truth.GetParticles()) {
+        auto mixed_part = OffsetParticle(part);
+        mixed.Add(mixed_part);
+      }
+      ev_mctruth->push_back(mixed);
+    }
+
+    ev_mcshower->reserve(ev_mcshower->size() + cosmic_mcshower->size());
+    for (auto mcs : *cosmic_mcshower) {
+      mcs.TrackID(OffsetID(mcs.TrackID()));
+      mcs.MotherTrackID(OffsetID(mcs.MotherTrackID()));
+      mcs.AncestorTrackID(OffsetID(mcs.AncestorTrackID()));
+      std::vector<unsigned int> daughters;
+      daughters.reserve(mcs.DaughterTrackID().size());
+      for (auto const& id : mcs.DaughterTrackID())
+        daughters.push_back(OffsetID(id));
+      mcs.DaughterTrackID(daughters);
+      ev_mcshower->push_back(mcs);
+    }
+
+    ev_mctrack->reserve(ev_mctrack->size() + cosmic_mctrack->size());
+    for (auto mct : *cosmic_mctrack) {
+      mct.TrackID(OffsetID(mct.TrackID()));
+      mct.MotherTrackID(OffsetID(mct.MotherTrackID()));
+      mct.AncestorTrackID(OffsetID(mct.AncestorTrackID()));
+      ev_mctrack->push_back(mct);
+    }
+
+    ev_flash->reserve(ev_flash->size() + cosmic_flash->size());
+    for (auto const& flash : *cosmic_flash)
+      ev_flash->push_back(flash);
+
+    _n_mixed_events++;
+
+    return true;
+  }
+
+  bool CosmicOverlayMixer::finalize() {
+
+    std::cout << _n_mixed_events << " events were mixed with one of "
+              << _n_cosmic_entries << " cosmic events by CosmicOverlayMixer." << std::endl;
+
+    _cosmic_io.close();
+
+    return true;
+  }
+
+}
+#endif
@@ -0,0 +1,113 @@
+/**
+ * \file CosmicOverlayMixer.h
+ *
+ * \ingroup EventFilters
+ * 
+ * \brief Class def header for a class CosmicOverlayMixer
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup EventFilters
+
+    @{*/
+
+#ifndef LARLITE_COSMICOVERLAYMIXER_H
+#define LARLITE_COSMICOVERLAYMIXER_H
+
+#include "Analysis/ana_base.h"
+#include "DataFormat/storage_manager.h"
+#include "DataFormat/mcshower.h"
+#include "DataFormat/mctrack.h"
+#include "DataFormat/mctruth.h"
+#include "DataFormat/opflash.h"
+#include "CounterRNG.h"
+
+namespace larlite {
+  /**
+     \class CosmicOverlayMixer
+     Overlays cosmics on the fly: for every event of the main (neutrino) input, a randomly
+     chosen event of a separate cosmic input (e.g. corsika) is read with its own
+     storage_manager, and its mctruth/mcshower/mctrack/opflash products are appended to the
+     main event's products (the cosmic mctruth after the neutrino one, which stays first).
+     Put it after the sample filter and before the ERTool selection unit, which then converts
+     the mixed products into one EventData.
+     The cosmic event is chosen with CounterRNG keyed by the main event's ids, so the
+     mixing is reproducible regardless of event order. Every cosmic track ID (own, mother,
+     ancestor and daughter IDs of the mcshowers, mctracks and mctruth particles) is offset
+     so they can't collide with the neutrino ones when building the MC graph; invalid IDs
+     (negative, or the larlite kINVALID values) are kept.
+   */
+  class CosmicOverlayMixer : public ana_base{
+  
+  public:
+
+    /// Default constructor
+    CosmicOverlayMixer();
+
+    /// Default destructor
+    virtual ~CosmicOverlayMixer(){}
+
+    /** IMPLEMENT in CosmicOverlayMixer.cc!
+        Initialization method to be called before the analysis event loop.
+    */ 
+    virtual bool initialize();
+
+    /** IMPLEMENT in CosmicOverlayMixer.cc! 
+        Analyze a data event-by-event  
+    */
+    virtual bool analyze(storage_manager* storage);
+
+    /** IMPLEMENT in CosmicOverlayMixer.cc! 
+        Finalize method to be called after all events processed.
+    */
+    virtual bool finalize();
+
+    /// Add a larlite file with the cosmic events to mix in
+    void AddCosmicFile(const std::string& name) { _cosmic_files.push_back(name); }
+
+    /// Producer names (same names are used for the main and the cosmic input)
+    void SetMCTruthProducer(const std::string& name)  { _mctruth_producer = name; }
+    void SetMCShowerProducer(const std::string& name) { _mcshower_producer = name; }
+    void SetMCTrackProducer(const std::string& name)  { _mctrack_producer = name; }
+    void SetFlashProducer(const std::string& name)    { _flash_producer = name; }
+
+    /// Offset added to the cosmic track IDs (and mother/ancestor/daughter IDs)
+    void SetTrackIDOffset(unsigned int offset) { _trackid_offset = offset; }
+
+  protected:
+
+    /// A cosmic track ID with the offset (invalid IDs are kept)
+    unsigned int OffsetID(unsigned int id) const;
+    int OffsetID(int id) const;
+
+    /// A cosmic mctruth particle with offset track, mother and daughter IDs
+    mcpart OffsetParticle(const mcpart& part) const;
+
+    std::vector<std::string> _cosmic_files;
+    std::string _mctruth_producer;
+    std::string _mcshower_producer;
+    std::string _mctrack_producer;
+    std::string _flash_producer;
+    unsigned int _trackid_offset;
+
+    storage_manager _cosmic_io;
+    size_t _n_cosmic_entries;
+
+    ::lee::util::CounterRNG _rng;
+
+    size_t _n_mixed_events;
+    
+  };
+}
+#endif
+
+//**************************************************************************
+// 
+// For Analysis framework documentation, read Manual.pdf here:
+//
+// http://microboone-docdb.fnal.gov:8080/cgi-bin/ShowDocument?docid=3183
+//
+//**************************************************************************
+
+/** @} */ // end of doxygen group 
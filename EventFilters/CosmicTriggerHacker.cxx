@@ -2,6 +2,7 @@
 #define LARLITE_COSMICTRIGGERHACKER_CXX
 
 #include "CosmicTriggerHacker.h"
+#include <algorithm>
 
 namespace larlite {
 
@@ -11,8 +12,12 @@ namespace larlite {
         if (!_trigger_hack_tree) {
             _trigger_hack_tree = new TTree("trigger_hack_tree", "trigger_hack_tree");
             _trigger_hack_tree->Branch("hacked_trig_time", &hacked_trig_time, "hacked_trig_time/D");
+            _trigger_hack_tree->Branch("replica", &replica, "replica/I");
+            _trigger_hack_tree->Branch("replica_weight", &replica_weight, "replica_weight/D");
         }
 
+        _n_events_no_tracks = 0;
+
         return true;
     }
 
@@ -36,15 +41,36 @@ namespace larlite {
             hacked_trig_times.push_back(mct.front().T());
         }
 
-        // Choose a random arrival time from the list
-        int randomIndex = rand() % hacked_trig_times.size();
-        hacked_trig_time = hacked_trig_times[randomIndex];
-        _trigger_hack_tree->Fill();
+        // Nothing to hack a trigger on: one entry without a hacked time, weight 1
+        // (as ERAnaLowEnergyExcess::FillReplicas does)
+        if (hacked_trig_times.empty()) {
+            _n_events_no_tracks++;
+            replica = 0;
+            replica_weight = 1.;
+            _trigger_hack_tree->Fill();
+            return true;
+        }
+
+        // Choose a random arrival time from the list, and the next ones for the other replicas:
+        // each track at most once, so an event with fewer tracks than _n_replicas gets one replica per track
+        _rng.SetKey(storage->run_id(), storage->subrun_id(), storage->event_id(), ::lee::util::kCosmicTriggerStream);
+        size_t randomIndex = _rng.Integer(hacked_trig_times.size());
+        size_t n_replicas = std::min(_n_replicas, hacked_trig_times.size());
+        for (size_t k = 0; k < n_replicas; ++k) {
+            hacked_trig_time = hacked_trig_times[(randomIndex + k) % hacked_trig_times.size()];
+            replica = k;
+            replica_weight = 1. / n_replicas;
+            _trigger_hack_tree->Fill();
+        }
 
         return true;
     }
 
     bool CosmicTriggerHacker::finalize() {
+
+        if (_n_events_no_tracks)
+            print(larlite::msg::kWARNING, __FUNCTION__, Form("%zu events had no mctrack in the TPC to hack a trigger on.", _n_events_no_tracks));
+
         if (_trigger_hack_tree && _fout) {
             _fout->cd();
             _trigger_hack_tree->Write();
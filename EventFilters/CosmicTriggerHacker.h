@@ -17,6 +17,7 @@
 
 #include "Analysis/ana_base.h"
  #include "DataFormat/mctrack.h"
+#include "CounterRNG.h"
 
 namespace larlite {
   /**
@@ -28,7 +29,7 @@ namespace larlite {
   public:
 
     /// Default constructor
-    CosmicTriggerHacker(){ _name="CosmicTriggerHacker"; _fout=0; _trigger_hack_tree=0;}
+    CosmicTriggerHacker(){ _name="CosmicTriggerHacker"; _fout=0; _trigger_hack_tree=0; _n_replicas=1;}
 
     /// Default destructor
     virtual ~CosmicTriggerHacker(){}
@@ -48,11 +49,22 @@ namespace larlite {
     */
     virtual bool finalize();
 
+    /// Oversampling: hack n_replicas different trigger times per event (one tree entry each, weight
+    /// 1/number of entries), at most one per track; an event without tracks gets one entry (weight 1)
+    /// with no hacked time
+    void SetNReplicas(size_t n) { _n_replicas = n ? n : 1; }
+
   protected:
 
+    size_t _n_replicas;
+    /// Random numbers keyed by (run, subrun, event), so the choice doesn't depend on event order
+    ::lee::util::CounterRNG _rng;
+    size_t _n_events_no_tracks;
 
     TTree* _trigger_hack_tree;
     double hacked_trig_time;
+    int replica;
+    double replica_weight;
     
   };
 }
@@ -0,0 +1,112 @@
+#ifndef LARLITE_EARLYVETOFILTER_CXX
+#define LARLITE_EARLYVETOFILTER_CXX
+
+#include "EarlyVetoFilter.h"
+
+namespace larlite {
+
+  EarlyVetoFilter::EarlyVetoFilter()
+    : _mc_shower(true)
+    , _shower_producer("mcreco")
+    , _min_shower_energy(10.)
+    , _flash_producer("opflashSat")
+    , _require_beam_flash(true)
+    , _bgw_start(0.)
+    , _bgw_end(10.)
+    , _min_flash_pe(10.)
+    , _flip(false)
+  {
+    _name = "EarlyVetoFilter";
+    _fout = 0;
+  }
+
+  bool EarlyVetoFilter::initialize() {
+
+    _n_total_events = 0;
+    _n_kept_events = 0;
+    ::lee::util::CutFlow::Shared().AddStage(_name);
+    _n_vetoed_no_shower = 0;
+    _n_vetoed_no_flash = 0;
+
+    return true;
+  }
+
+  bool EarlyVetoFilter::HasEnergeticShower(storage_manager* storage) {
+
+    if (_mc_shower) {
+      auto ev_mcshower = storage->get_data<event_mcshower>(_shower_producer);
+      if (!ev_mcshower) {
+        print(larlite::msg::kERROR, __FUNCTION__, Form("Did not find specified data product, mcshower by %s!", _shower_producer.c_str()));
+        return false;
+      }
+      for (auto const& mcs : *ev_mcshower)
+        if (mcs.DetProfile().E() >= _min_shower_energy) return true;
+      return false;
+    }
+
+    auto ev_shower = storage->get_data<event_shower>(_shower_producer);
+    if (!ev_shower) {
+      print(larlite::msg::kERROR, __FUNCTION__, Form("Did not find specified data product, shower by %s!", _shower_producer.c_str()));
+      return false;
+    }
+    // Keep the event if any plane's energy is above threshold
+    for (auto const& shr : *ev_shower)
+      for (auto const& e : shr.Energy_v())
+        if (e >= _min_shower_energy) return true;
+    return false;
+  }
+
+  bool EarlyVetoFilter::HasBeamFlash(storage_manager* storage) {
+
+    auto ev_flash = storage->get_data<event_opflash>(_flash_producer);
+    if (!ev_flash) {
+      print(larlite::msg::kERROR, __FUNCTION__, Form("Did not find specified data product, opflash by %s!", _flash_producer.c_str()));
+      return false;
+    }
+    for (auto const& flash : *ev_flash) {
+      if (flash.Time() < _bgw_start || flash.Time() > _bgw_end) continue;
+      if (flash.TotalPE() < _min_flash_pe) continue;
+      return true;
+    }
+    return false;
+  }
+
+  bool EarlyVetoFilter::analyze(storage_manager* storage) {
+
+    _n_total_events++;
+
+    bool ret = true;
+
+    // Cheapest check first
+    if (!HasEnergeticShower(storage)) {
+      _n_vetoed_no_shower++;
+      ret = false;
+    }
+    else if (_require_beam_flash && !HasBeamFlash(storage)) {
+      _n_vetoed_no_flash++;
+      ret = false;
+    }
+
+    if (_flip) ret = !ret;
+
+    if (ret) {
+      _n_kept_events++;
+      ::lee::util::CutFlow::Shared().Fill(_name);
+    }
+
+    return ret;
+  }
+
+  bool EarlyVetoFilter::finalize() {
+
+    std::cout << _n_total_events << " total events analyzed, " << _n_kept_events << " events passed EarlyVetoFilter." << std::endl;
+    std::cout << "  vetoed (no shower above " << _min_shower_energy << " MeV) : " << _n_vetoed_no_shower << std::endl;
+    std::cout << "  vetoed (no flash in [" << _bgw_start << "," << _bgw_end << "] us) : " << _n_vetoed_no_flash << std::endl;
+
+    ::lee::util::CutFlow::WriteShared(_fout);
+
+    return true;
+  }
+
+}
+#endif
@@ -0,0 +1,119 @@
+/**
+ * \file EarlyVetoFilter.h
+ *
+ * \ingroup EventFilters
+ * 
+ * \brief Class def header for a class EarlyVetoFilter
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup EventFilters
+
+    @{*/
+
+#ifndef LARLITE_EARLYVETOFILTER_H
+#define LARLITE_EARLYVETOFILTER_H
+
+#include "Analysis/ana_base.h"
+#include "CutFlow.h"
+#include "DataFormat/mcshower.h"
+#include "DataFormat/shower.h"
+#include "DataFormat/opflash.h"
+
+namespace larlite {
+  /**
+     \class EarlyVetoFilter
+     Cheap event-level gate to put right in front of the ERTool selection unit
+     (with ana_processor::enable_filter(True)). Events that can't possibly yield a
+     CCSingleE candidate are vetoed before any ERTool algorithm runs:
+     - no shower above the min energy (same cut as ERToolHelper's SetMinEDep, so
+       ERTool would not have made a single shower for this event anyway)
+     - no flash above 10 PE in a loose window around the beam gate, 0-10 us by default
+       (those events have no _flash_time there, see ERAnaLowEnergyExcess::FlashTimeClosestToBGW,
+       so they fail any flash time cut inside it). Keep the window a superset of the analysis
+       window so the flash time cut of stack_plotter.py can still be tuned on the ntuples.
+       Turn this off for samples whose flash times are hacked later (the in-time corsika cosmics).
+     Counters of what was vetoed are printed in finalize.
+   */
+  class EarlyVetoFilter : public ana_base{
+  
+  public:
+
+    /// Default constructor
+    EarlyVetoFilter();
+
+    /// Default destructor
+    virtual ~EarlyVetoFilter(){}
+
+    /** IMPLEMENT in EarlyVetoFilter.cc!
+        Initialization method to be called before the analysis event loop.
+    */ 
+    virtual bool initialize();
+
+    /** IMPLEMENT in EarlyVetoFilter.cc! 
+        Analyze a data event-by-event  
+    */
+    virtual bool analyze(storage_manager* storage);
+
+    /** IMPLEMENT in EarlyVetoFilter.cc! 
+        Finalize method to be called after all events processed.
+    */
+    virtual bool finalize();
+
+    /// Same arguments as ExampleERSelection::SetShowerProducer (mc = read mcshower)
+    void SetShowerProducer(bool mc, const std::string& name) { _mc_shower = mc; _shower_producer = name; }
+
+    /// Showers below this energy [MeV] don't count (use the same value as SetMinEDep)
+    void SetMinShowerEnergy(double e) { _min_shower_energy = e; }
+
+    void SetFlashProducer(const std::string& name) { _flash_producer = name; }
+
+    /// Whether an event needs a flash in the beam gate window to be kept
+    void SetRequireBeamFlash(bool flag) { _require_beam_flash = flag; }
+
+    /// Window [us] and min PE for a flash to count as in-beam (a superset of the analysis cuts)
+    void SetBeamWindow(double start, double end) { _bgw_start = start; _bgw_end = end; }
+    void SetMinFlashPE(double pe) { _min_flash_pe = pe; }
+
+    void flip(bool on) { _flip = on; }
+
+  protected:
+
+    /// Whether there is at least one shower above the min energy
+    bool HasEnergeticShower(storage_manager* storage);
+
+    /// Whether there is at least one flash in the beam gate window
+    bool HasBeamFlash(storage_manager* storage);
+
+    bool _mc_shower;
+    std::string _shower_producer;
+    double _min_shower_energy;
+
+    std::string _flash_producer;
+    bool _require_beam_flash;
+    double _bgw_start;
+    double _bgw_end;
+    double _min_flash_pe;
+
+    // boolean to flip logical operation of algorithm
+    bool _flip;
+
+    size_t _n_total_events;
+    size_t _n_kept_events;
+    size_t _n_vetoed_no_shower;
+    size_t _n_vetoed_no_flash;
+    
+  };
+}
+#endif
+
+//**************************************************************************
+// 
+// For Analysis framework documentation, read Manual.pdf here:
+//
+// http://microboone-docdb.fnal.gov:8080/cgi-bin/ShowDocument?docid=3183
+//
+//**************************************************************************
+
+/** @} */ // end of doxygen group 
@@ -0,0 +1,42 @@
+#ifndef LARLITE_EVENTCOUNTER_CXX
+#define LARLITE_EVENTCOUNTER_CXX
+
+#include "EventCounter.h"
+
+namespace larlite {
+
+  bool EventCounter::initialize() {
+
+    _n_events_seen = 0;
+    // first stage of the cut flow, the filters that follow add theirs
+    ::lee::util::CutFlow::Shared().AddStage("all events");
+
+    return true;
+  }
+
+  bool EventCounter::analyze(storage_manager* storage) {
+
+    _n_events_seen++;
+    ::lee::util::CutFlow::Shared().Fill("all events");
+
+    return true;
+  }
+
+  bool EventCounter::finalize() {
+
+    ::lee::util::JobCounters counters("job_counters");
+    counters.Set("n_jobs", 1);
+    counters.Set("n_events_seen", _n_events_seen);
+    counters.Set("pot", _pot_per_event * _n_events_seen);
+
+    if (_fout) {
+      _fout->cd();
+      counters.Write();
+    }
+    ::lee::util::CutFlow::WriteShared(_fout);
+
+    return true;
+  }
+
+}
+#endif
@@ -0,0 +1,76 @@
+/**
+ * \file EventCounter.h
+ *
+ * \ingroup EventFilters
+ * 
+ * \brief Class def header for a class EventCounter
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup EventFilters
+
+    @{*/
+
+#ifndef LARLITE_EVENTCOUNTER_H
+#define LARLITE_EVENTCOUNTER_H
+
+#include "Analysis/ana_base.h"
+#include "JobCounters.h"
+#include "CutFlow.h"
+
+namespace larlite {
+  /**
+     \class EventCounter
+     Counts every event the job reads (put it first, before any filter) and writes a
+     lee::util::JobCounters "job_counters" with n_jobs, n_events_seen and pot
+     (= pot per event x events seen) to the ana output file. These add up when the
+     outputs of many jobs are merged.
+     It also opens the shared lee::util::CutFlow with the "all events" stage.
+   */
+  class EventCounter : public ana_base{
+  
+  public:
+
+    /// Default constructor
+    EventCounter(){ _name="EventCounter"; _fout=0; _pot_per_event=0.;}
+
+    /// Default destructor
+    virtual ~EventCounter(){}
+
+    /** IMPLEMENT in EventCounter.cc!
+        Initialization method to be called before the analysis event loop.
+    */ 
+    virtual bool initialize();
+
+    /** IMPLEMENT in EventCounter.cc! 
+        Analyze a data event-by-event  
+    */
+    virtual bool analyze(storage_manager* storage);
+
+    /** IMPLEMENT in EventCounter.cc! 
+        Finalize method to be called after all events processed.
+    */
+    virtual bool finalize();
+
+    /// POT corresponding to one event of the sample (0 if unknown/not relevant)
+    void SetPOTPerEvent(double pot) { _pot_per_event = pot; }
+
+  protected:
+
+    double _pot_per_event;
+    size_t _n_events_seen;
+    
+  };
+}
+#endif
+
+//**************************************************************************
+// 
+// For Analysis framework documentation, read Manual.pdf here:
+//
+// http://microboone-docdb.fnal.gov:8080/cgi-bin/ShowDocument?docid=3183
+//
+//**************************************************************************
+
+/** @} */ // end of doxygen group 
@@ -19,6 +19,10 @@
 #pragma link C++ class larlite::MC_LEE_Filter+;
 #pragma link C++ class larlite::MC_LEE_1e1p_Filter+;
 #pragma link C++ class larlite::CosmicTriggerHacker+;
+#pragma link C++ class larlite::EarlyVetoFilter+;
+#pragma link C++ class larlite::MC_cosmicoutoftime_Filter+;
+#pragma link C++ class larlite::CosmicOverlayMixer+;
+#pragma link C++ class larlite::EventCounter+;
 //ADD_NEW_CLASS ... do not change this line
 #endif
 
@@ -17,6 +17,7 @@ bool MC_CCnue_Filter::initialize() {
 
   _n_total_events = 0;
   _n_kept_events = 0;
+  ::lee::util::CutFlow::Shared().AddStage(_name);
 
   return true;
 }
@@ -57,7 +58,10 @@ bool MC_CCnue_Filter::analyze(storage_manager* storage) {
   if (CC && nue) {ret = true;}
   else {ret = false;}
 
-  if (ret) _n_kept_events++;
+  if (ret) {
+    _n_kept_events++;
+    ::lee::util::CutFlow::Shared().Fill(_name);
+  }
   return ret;
 
 
@@ -66,6 +70,8 @@ bool MC_CCnue_Filter::analyze(storage_manager* storage) {
 bool MC_CCnue_Filter::finalize() {
   std::cout << _n_total_events << " total events analyzed, " << _n_kept_events << " events passed MC_CCnue_Filter." << std::endl;
 
+  ::lee::util::CutFlow::WriteShared(_fout);
+
   return true;
 }
 
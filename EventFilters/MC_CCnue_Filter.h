@@ -16,6 +16,7 @@
 #define LARLITE_MC_CCNUE_FILTER_H
 
 #include "Analysis/ana_base.h"
+#include "CutFlow.h"
 #include "DataFormat/mctruth.h"
 #include "GeoAlgo/GeoAABox.h"
 #include "LArUtil/Geometry.h"
@@ -9,6 +9,8 @@ namespace larlite {
 
     total_events = 0;
     kept_events = 0;
+    ::lee::util::LEETopology::Shared().Reset();
+    if (!_tag_only) ::lee::util::CutFlow::Shared().AddStage(_name);
 
     return true;
 
@@ -26,71 +28,27 @@ namespace larlite {
     total_events++;
 
 
-    //Enforce that there is exactly 1 electron, above 20MeV kinetic energy
-    //Don't care about neutrons, protons.
-    //Don't care about other particles if they are below 20MeV KE
-    //I don't care about neutrons, weird quarks, the neutrino, etc.
-    size_t n_electrons = 0;
-
-    for (auto const& particle : ev_mctruth->at(0).GetParticles()) {
-
-      // Only particles with status code 1 are relevant
-      if ( particle.StatusCode() != 1 ) continue;
-
-      //Note: this KE is in units of GEV!
-      double KE = particle.Trajectory().at(0).E() - particle.Mass();
-
-      //Don't care about any particles with less than 20 MeV KE
-      if ( KE < 0.02 ) continue;
-
-      //Count up the number of electrons, skip all events with > 1.5 GeV electron
-      //Also skip events with < 100 MeV electron since they will get zero weight
-      // (out of energy range we care about... LEERW weights only computed from 0.1 to 2 GEV)
-      if ( abs(particle.PdgCode()) == 11 ){
-        n_electrons++;
-        if ( KE > 1.5 || KE < 0.1 )
-          return false;
-      }
-
-      //Skip this event if any other particles exist... this filter
-      //is to pick out 1eNpNn events!
-      // 22  => gammas
-      // 211 => charged pions
-      // 111 => pi0s
-      // 13  => muons
-      // 321 => kaons
-      if ( abs(particle.PdgCode()) == 22  ||
-           abs(particle.PdgCode()) == 211 ||
-           abs(particle.PdgCode()) == 111 ||
-           abs(particle.PdgCode()) == 13  ||
-           abs(particle.PdgCode()) == 321 )
-        return false;
-
-      /*
-      //temp cout to check for unexpected particles
-      if (abs(particle.PdgCode()) != 2212 && //proton
-      abs(particle.PdgCode()) != 2112 && //neutron
-      abs(particle.PdgCode()) != 11  &&  //electron
-      abs(particle.PdgCode()) != 12  &&  //nue
-      abs(particle.PdgCode()) != 2000000101 && //bindino
-      abs(particle.PdgCode()) != 311  &&  //K0
-      abs(particle.PdgCode()) != 3222  &&  //sigma+
-      abs(particle.PdgCode()) != 3122 )  //lamda+
-      std::cout<<"Found particle with pdg = "<<particle.PdgCode()<<std::endl;
-      */
-    }
+    //Exactly 1 electron and no gammas, pions, muons or kaons (see lee::util::LEETopology)
+    bool passed = ::lee::util::LEETopology::Passes(ev_mctruth->at(0));
+    ::lee::util::LEETopology::Shared().Fill(passed);
+
+    //In tag only mode every event is kept, the decision is only recorded
+    if (_tag_only) return true;
 
-    //Skip this event if the number of electrons is not 1
-    if ( n_electrons != 1 )
+    if (!passed)
       return false;
 
     kept_events++;
+    ::lee::util::CutFlow::Shared().Fill(_name);
     return true;
   }
 
   bool MC_LEE_Filter::finalize() {
 
-  std::cout << total_events << " total events analyzed, " << kept_events << " events passed MC_LEE_Filter." << std::endl;
+  std::cout << total_events << " total events analyzed, " << ::lee::util::LEETopology::Shared().NPassed()
+            << " events passed MC_LEE_Filter" << (_tag_only ? " (tag only, all kept)." : ".") << std::endl;
+    ::lee::util::CutFlow::WriteShared(_fout);
+
     return true;
   }
 
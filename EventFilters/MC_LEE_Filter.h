@@ -16,6 +16,8 @@
 #define LARLITE_MC_LEE_FILTER_H
 
 #include "Analysis/ana_base.h"
+#include "CutFlow.h"
+#include "LEETopology.h"
 #include "DataFormat/mctruth.h"
 
 namespace larlite {
@@ -28,7 +30,7 @@ namespace larlite {
   public:
 
     /// Default constructor
-    MC_LEE_Filter(){ _name="MC_LEE_Filter"; _fout=0; _flip=false;};
+    MC_LEE_Filter(){ _name="MC_LEE_Filter"; _fout=0; _flip=false; _tag_only=false;};
 
     /// Default destructor
     virtual ~MC_LEE_Filter(){};
@@ -50,6 +52,10 @@ namespace larlite {
 
     void flip(bool on) { _flip = on; }
 
+    /// Keep every event, only recording its LEE topology in lee::util::LEETopology::Shared()
+    /// (for ERAnaLowEnergyExcess::SetLEEWeightColumnMode; run it before any other filter)
+    void SetTagOnly(bool on) { _tag_only = on; }
+
     protected:
 
     size_t total_events;
@@ -57,6 +63,8 @@ namespace larlite {
 
     // boolean to flip logical operation of algorithm
     bool _flip;
+
+    bool _tag_only;
     
   };
 }
@@ -17,6 +17,7 @@ bool MC_NC_Filter::initialize() {
 
   _n_total_events = 0;
   _n_kept_events = 0;
+  ::lee::util::CutFlow::Shared().AddStage(_name);
 
   return true;
 }
@@ -54,7 +55,10 @@ bool MC_NC_Filter::analyze(storage_manager* storage) {
   else {ret = false;}
 
   //check the status of the ret variable
-  if (ret) _n_kept_events++;
+  if (ret) {
+    _n_kept_events++;
+    ::lee::util::CutFlow::Shared().Fill(_name);
+  }
   return ret;
 
 
@@ -64,6 +68,8 @@ bool MC_NC_Filter::finalize() {
 
   std::cout << _n_total_events << " total events analyzed, " << _n_kept_events << " events passed MC_NC_Filter." << std::endl;
 
+  ::lee::util::CutFlow::WriteShared(_fout);
+
   return true;
 }
 
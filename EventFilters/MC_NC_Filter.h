@@ -16,6 +16,7 @@
 #define LARLITE_MC_NC_FILTER_H
 
 #include "Analysis/ana_base.h"
+#include "CutFlow.h"
 #include "DataFormat/mctruth.h"
 #include "DataFormat/mcshower.h"
 #include "GeoAlgo/GeoAABox.h"
@@ -10,6 +10,7 @@ bool MC_cosmic_Filter::initialize() {
 
   _n_total_events = 0;
   _n_kept_events = 0;
+  ::lee::util::CutFlow::Shared().AddStage(_name);
 
   return true;
 }
@@ -42,7 +43,10 @@ bool MC_cosmic_Filter::analyze(storage_manager* storage) {
   }
   
 
-  if (ret) _n_kept_events++;
+  if (ret) {
+    _n_kept_events++;
+    ::lee::util::CutFlow::Shared().Fill(_name);
+  }
 return ret;
 
   return true;
@@ -54,6 +58,8 @@ bool MC_cosmic_Filter::finalize() {
   std::cout << _n_total_events << " total events analyzed, " << _n_kept_events << " events passed MC_cosmic_Filter." << std::endl;
 
  
+  ::lee::util::CutFlow::WriteShared(_fout);
+
   return true;
 }
 
@@ -0,0 +1,83 @@
+#ifndef LARLITE_MC_COSMICOUTOFTIME_FILTER_CXX
+#define LARLITE_MC_COSMICOUTOFTIME_FILTER_CXX
+
+#include "MC_cosmicoutoftime_Filter.h"
+
+namespace larlite {
+
+  MC_cosmicoutoftime_Filter::MC_cosmicoutoftime_Filter()
+    : _shower_producer("mcreco")
+    , _t_start(3100.)
+    , _t_end(4700.)
+    , _min_shower_energy(0.)
+    , _flip(false)
+  {
+    _name = "MC_cosmicoutoftime_Filter";
+    _fout = 0;
+  }
+
+  bool MC_cosmicoutoftime_Filter::initialize() {
+
+    _n_total_events = 0;
+    _n_kept_events = 0;
+    ::lee::util::CutFlow::Shared().AddStage(_name);
+    _n_no_cosmic_shower = 0;
+    _n_all_in_time = 0;
+
+    return true;
+  }
+
+  bool MC_cosmicoutoftime_Filter::analyze(storage_manager* storage) {
+
+    auto ev_mcshower = storage->get_data<event_mcshower>(_shower_producer);
+    if (!ev_mcshower) {
+      print(larlite::msg::kERROR, __FUNCTION__, Form("Did not find specified data product, mcshower!"));
+      return false;
+    }
+
+    _n_total_events++;
+
+    bool has_cosmic_shower = false;
+    bool ret = false;
+
+    for (auto const& mcs : *ev_mcshower) {
+
+      if (mcs.Origin() != simb::Origin_t::kCosmicRay) continue;
+      if (mcs.DetProfile().E() < _min_shower_energy) continue;
+
+      has_cosmic_shower = true;
+
+      // Same time ertool::Shower::_time gets for mcshowers (what ends up in _mc_time)
+      double t = mcs.DetProfile().T();
+      if (t < _t_start || t > _t_end) {
+        ret = true;
+        break;
+      }
+    }
+
+    if (!has_cosmic_shower) _n_no_cosmic_shower++;
+    else if (!ret) _n_all_in_time++;
+
+    if (_flip) ret = !ret;
+
+    if (ret) {
+      _n_kept_events++;
+      ::lee::util::CutFlow::Shared().Fill(_name);
+    }
+
+    return ret;
+  }
+
+  bool MC_cosmicoutoftime_Filter::finalize() {
+
+    std::cout << _n_total_events << " total events analyzed, " << _n_kept_events << " events passed MC_cosmicoutoftime_Filter." << std::endl;
+    std::cout << "  dropped (no cosmic shower above " << _min_shower_energy << " MeV) : " << _n_no_cosmic_shower << std::endl;
+    std::cout << "  dropped (all cosmic showers in [" << _t_start << "," << _t_end << "] ns) : " << _n_all_in_time << std::endl;
+
+    ::lee::util::CutFlow::WriteShared(_fout);
+
+    return true;
+  }
+
+}
+#endif
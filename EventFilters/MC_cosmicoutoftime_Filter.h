@@ -0,0 +1,96 @@
+/**
+ * \file MC_cosmicoutoftime_Filter.h
+ *
+ * \ingroup EventFilters
+ * 
+ * \brief Class def header for a class MC_cosmicoutoftime_Filter
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup EventFilters
+
+    @{*/
+
+#ifndef LARLITE_MC_COSMICOUTOFTIME_FILTER_H
+#define LARLITE_MC_COSMICOUTOFTIME_FILTER_H
+
+#include "Analysis/ana_base.h"
+#include "CutFlow.h"
+#include "DataFormat/mcshower.h"
+
+namespace larlite {
+  /**
+     \class MC_cosmicoutoftime_Filter
+     Truth-level pre-filter for the "cosmic out of time, nu in time" sample.
+     stack_plotter.py only keeps cosmicoutoftime rows whose single electron is a cosmic
+     (_mc_origin == 2) shower with time (_mc_time) outside of [3100,4700] ns.
+     This filter drops events in which no mcshower could ever satisfy that, i.e. no
+     cosmic-origin mcshower above the ERTool shower energy cut outside the time window,
+     so they never go through the ERTool chain. The per-row cuts in stack_plotter.py
+     are still needed, since a kept event may also have in-time showers.
+   */
+  class MC_cosmicoutoftime_Filter : public ana_base{
+  
+  public:
+
+    /// Default constructor
+    MC_cosmicoutoftime_Filter();
+
+    /// Default destructor
+    virtual ~MC_cosmicoutoftime_Filter(){}
+
+    /** IMPLEMENT in MC_cosmicoutoftime_Filter.cc!
+        Initialization method to be called before the analysis event loop.
+    */ 
+    virtual bool initialize();
+
+    /** IMPLEMENT in MC_cosmicoutoftime_Filter.cc! 
+        Analyze a data event-by-event  
+    */
+    virtual bool analyze(storage_manager* storage);
+
+    /** IMPLEMENT in MC_cosmicoutoftime_Filter.cc! 
+        Finalize method to be called after all events processed.
+    */
+    virtual bool finalize();
+
+    /// Showers with time [ns] inside [start,end] are "in time" and don't count
+    void SetInTimeWindow(double start, double end) { _t_start = start; _t_end = end; }
+
+    /// Showers below this deposited energy [MeV] don't count (default 0: with reco emulation a
+    /// smeared reco shower can come from a truth shower below the ERTool energy cut)
+    void SetMinShowerEnergy(double e) { _min_shower_energy = e; }
+
+    void SetShowerProducer(const std::string& name) { _shower_producer = name; }
+
+    void flip(bool on) { _flip = on; }
+
+  protected:
+
+    std::string _shower_producer;
+    double _t_start;
+    double _t_end;
+    double _min_shower_energy;
+
+    // boolean to flip logical operation of algorithm
+    bool _flip;
+
+    size_t _n_total_events;
+    size_t _n_kept_events;
+    size_t _n_no_cosmic_shower;
+    size_t _n_all_in_time;
+    
+  };
+}
+#endif
+
+//**************************************************************************
+// 
+// For Analysis framework documentation, read Manual.pdf here:
+//
+// http://microboone-docdb.fnal.gov:8080/cgi-bin/ShowDocument?docid=3183
+//
+//**************************************************************************
+
+/** @} */ // end of doxygen group 
@@ -18,6 +18,7 @@ namespace larlite {
 
     _n_total_events = 0;
     _n_kept_events = 0;
+    ::lee::util::CutFlow::Shared().AddStage(_name);
 
     return true;
   }
@@ -47,7 +48,10 @@ namespace larlite {
       if(ret == false) continue;
     }
 
-    if (ret) _n_kept_events++;
+    if (ret) {
+      _n_kept_events++;
+      ::lee::util::CutFlow::Shared().Fill(_name);
+    }
 
       return ret;  
 
@@ -56,6 +60,8 @@ namespace larlite {
   bool MC_dirt_Filter::finalize() {
   std::cout << _n_total_events << " total events analyzed, " << _n_kept_events << " events passed MC_dirt_Filter." << std::endl;
   
+    ::lee::util::CutFlow::WriteShared(_fout);
+
     return true;
   }
 
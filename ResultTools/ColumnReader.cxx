@@ -0,0 +1,85 @@
+#ifndef LEE_COLUMNREADER_CXX
+#define LEE_COLUMNREADER_CXX
+
+#include "ColumnReader.h"
+#include "TreeCutEvaluator.h"
+#include "TFile.h"
+#include <iostream>
+#include <memory>
+#include <algorithm>
+
+namespace lee {
+
+  bool ColumnReader::Read(TTree* tree, const std::vector<std::string>& columns, const std::string& cut)
+  {
+    Clear();
+    if (!tree) {
+      std::cout << "ERROR!! ColumnReader: no tree!" << std::endl;
+      return false;
+    }
+    TreeCutEvaluator evaluator(tree, _block_size);
+    for (auto const& def : _defines)
+      if (!evaluator.Define(def.first, def.second)) return false;
+
+    _columns = columns.empty() ? evaluator.ScalarColumns() : columns;
+    _data.resize(_columns.size());
+    bool ok = evaluator.ScanSelected(cut, _columns, [this](size_t n, const Long64_t* entries, const std::vector<const double*>& v) {
+        _entries.insert(_entries.end(), entries, entries + n);
+        for (size_t j = 0; j < _data.size(); ++j) _data[j].insert(_data[j].end(), v[j], v[j] + n);
+      });
+    if (!ok) {
+      std::cout << "ERROR!! ColumnReader could not read " << tree->GetName() << std::endl;
+      Clear();
+    }
+    return ok;
+  }
+
+  bool ColumnReader::Read(const std::string& filename, const std::string& treename,
+                          const std::vector<std::string>& columns, const std::string& cut)
+  {
+    std::unique_ptr<TFile> f(TFile::Open(filename.c_str(), "READ"));
+    auto tree = f ? dynamic_cast<TTree*>(f->Get(treename.c_str())) : nullptr;
+    if (!tree) {
+      Clear();
+      std::cout << "ERROR!! ColumnReader: no tree " << treename << " in " << filename << std::endl;
+      return false;
+    }
+    return Read(tree, columns, cut);
+  }
+
+  void ColumnReader::Clear()
+  {
+    _columns.clear();
+    _data.clear();
+    _entries.clear();
+  }
+
+  size_t ColumnReader::Index(const std::string& column) const
+  {
+    return std::find(_columns.begin(), _columns.end(), column) - _columns.begin();
+  }
+
+  const double* ColumnReader::Data(const std::string& column) const
+  {
+    size_t j = Index(column);
+    if (j == _columns.size()) {
+      std::cout << "ERROR!! ColumnReader has no column " << column << std::endl;
+      return nullptr;
+    }
+    return _data[j].data();
+  }
+
+  const std::vector<double>& ColumnReader::Column(const std::string& column) const
+  {
+    static const std::vector<double> empty;
+    size_t j = Index(column);
+    if (j == _columns.size()) {
+      std::cout << "ERROR!! ColumnReader has no column " << column << std::endl;
+      return empty;
+    }
+    return _data[j];
+  }
+
+}
+
+#endif
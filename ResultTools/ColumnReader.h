@@ -0,0 +1,87 @@
+/**
+ * \file ColumnReader.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class ColumnReader
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_COLUMNREADER_H
+#define LEE_COLUMNREADER_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include "TTree.h"
+
+namespace lee {
+
+  /**
+     \class ColumnReader
+     Reads some columns of a result tree (branches or expressions of branches) for the
+     entries passing a cut, into one contiguous array of doubles per column, instead of
+     root2array loading every branch of every entry (stack_plotter.py).
+     The cut is evaluated while reading (TreeCutEvaluator::ScanSelected): the branches used
+     only by the columns are read for the passing entries only, and only the passing rows
+     are stored, so memory and time follow the selected rows and columns.
+     Data(column) is the address of the array, valid until the next Read or Clear, for
+     numpy.frombuffer without a copy (see read_columns in stack_plotter.py).
+   */
+  class ColumnReader {
+
+  public:
+
+    /// Default constructor
+    ColumnReader(size_t block_size = 4096) : _block_size(block_size) {}
+
+    /// Default destructor
+    virtual ~ColumnReader() {}
+
+    /// Define a column for the next reads (see TreeCutEvaluator::Define)
+    void Define(const std::string& name, const std::string& expr) { _defines.emplace_back(name, expr); }
+
+    /// Read the columns (all numeric scalar branches if none) of the entries passing cut.
+    /// Replaces the previous content. Returns false on error.
+    bool Read(TTree* tree, const std::vector<std::string>& columns = std::vector<std::string>(),
+              const std::string& cut = "");
+    bool Read(const std::string& filename, const std::string& treename,
+              const std::vector<std::string>& columns = std::vector<std::string>(), const std::string& cut = "");
+
+    void Clear();
+
+    /// Number of rows (entries passing the cut) of the last Read
+    size_t NRows() const { return _entries.size(); }
+
+    const std::vector<std::string>& Columns() const { return _columns; }
+
+    /// Tree entry number of each row
+    const std::vector<Long64_t>& Entries() const { return _entries; }
+
+    /// Values of a column, NRows() doubles (nullptr if there is no such column)
+    const double* Data(const std::string& column) const;
+
+    /// Values of a column (empty if there is no such column)
+    const std::vector<double>& Column(const std::string& column) const;
+
+  private:
+
+    /// Index of a column, Columns().size() if there is none
+    size_t Index(const std::string& column) const;
+
+    size_t _block_size;
+    std::vector<std::pair<std::string, std::string> > _defines;
+    std::vector<std::string> _columns;
+    std::vector<std::vector<double> > _data;
+    std::vector<Long64_t> _entries;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,165 @@
+#ifndef LEE_CUTBITMAPSTORE_CXX
+#define LEE_CUTBITMAPSTORE_CXX
+
+#include "CutBitmapStore.h"
+#include "TreeCutEvaluator.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+namespace lee {
+
+  void CutBitmapStore::AddCut(const std::string& name, const std::string& expr, const std::string& nminus1_var)
+  {
+    _cut_names.push_back(name);
+    _cut_exprs.push_back(expr);
+    _nminus1_vars.push_back(nminus1_var);
+  }
+
+  size_t CutBitmapStore::SampleIndex(const std::string& sample) const
+  {
+    size_t i = std::find(_sample_names.begin(), _sample_names.end(), sample) - _sample_names.begin();
+    if (i == _sample_names.size()) throw std::invalid_argument("CutBitmapStore: no bitmaps for sample " + sample);
+    return i;
+  }
+
+  size_t CutBitmapStore::CutIndex(const std::string& cut) const
+  {
+    size_t i = std::find(_cut_names.begin(), _cut_names.end(), cut) - _cut_names.begin();
+    if (i == _cut_names.size()) throw std::invalid_argument("CutBitmapStore: unknown cut " + cut);
+    return i;
+  }
+
+  bool CutBitmapStore::Build(const std::string& base_cut)
+  {
+    size_t ncuts = _cut_names.size();
+    _sample_names = _samples->Samples();
+    _bitmaps.assign(_sample_names.size(), SampleBitmaps_t());
+
+    // expressions of the pass: base cut, weight, the cuts, then the N-1 variables
+    std::vector<std::string> cut_exprs(_cut_exprs);
+    std::vector<size_t> nminus1_column(ncuts, 0);
+    for (size_t c = 0; c < ncuts; ++c) {
+      if (_nminus1_vars[c].empty()) continue;
+      nminus1_column[c] = 2 + cut_exprs.size();
+      cut_exprs.push_back(_nminus1_vars[c]);
+    }
+
+    return _samples->ForEachSample(base_cut, [&](StackBuilder::Sample_t& sample, size_t i,
+                                                 TreeCutEvaluator& evaluator, const std::string& mycut) {
+        auto& bitmaps = _bitmaps[i];
+        bitmaps.cuts.assign(ncuts, EventBitmap());
+        bitmaps.nminus1.assign(ncuts, std::vector<double>());
+
+        std::vector<std::string> exprs = { mycut, sample.weight };
+        exprs.insert(exprs.end(), cut_exprs.begin(), cut_exprs.end());
+
+        return evaluator.Scan(exprs, [&](size_t first, size_t n, const std::vector<const double*>& v) {
+            for (size_t k = 0; k < n; ++k) {
+              bitmaps.weights.push_back(v[1][k] * sample.scale);
+              for (size_t c = 0; c < ncuts; ++c)
+                if (nminus1_column[c]) bitmaps.nminus1[c].push_back(v[nminus1_column[c]][k]);
+              if (v[0][k] == 0.) continue;
+              uint32_t row = first + k;
+              bitmaps.base.Add(row);
+              for (size_t c = 0; c < ncuts; ++c)
+                if (v[2 + c][k] != 0.) bitmaps.cuts[c].Add(row);
+            }
+          });
+      });
+  }
+
+  const EventBitmap& CutBitmapStore::Bitmap(const std::string& sample, const std::string& cut) const
+  {
+    return _bitmaps[SampleIndex(sample)].cuts[CutIndex(cut)];
+  }
+
+  EventBitmap CutBitmapStore::Passing(const std::string& sample, const std::vector<std::string>& cuts) const
+  {
+    auto const& bitmaps = _bitmaps[SampleIndex(sample)];
+    EventBitmap passing = bitmaps.base;
+    for (auto const& cut : cuts) passing = passing.And(bitmaps.cuts[CutIndex(cut)]);
+    return passing;
+  }
+
+  double CutBitmapStore::Yield(const std::string& sample, const std::vector<std::string>& cuts) const
+  {
+    return Passing(sample, cuts).WeightedSum(_bitmaps[SampleIndex(sample)].weights);
+  }
+
+  std::vector<double> CutBitmapStore::CutFlow(const std::string& sample) const
+  {
+    auto const& bitmaps = _bitmaps[SampleIndex(sample)];
+    std::vector<double> flow;
+    EventBitmap passing = bitmaps.base;
+    flow.push_back(passing.WeightedSum(bitmaps.weights));
+    for (auto const& cut : bitmaps.cuts) {
+      passing = passing.And(cut);
+      flow.push_back(passing.WeightedSum(bitmaps.weights));
+    }
+    return flow;
+  }
+
+  double CutBitmapStore::NMinusOneYield(const std::string& sample, const std::string& cut) const
+  {
+    std::vector<std::string> others;
+    for (auto const& name : _cut_names)
+      if (name != cut) others.push_back(name);
+    CutIndex(cut); // throws for an unknown cut
+    return Yield(sample, others);
+  }
+
+  std::vector<double> CutBitmapStore::NMinusOneHistogram(const std::string& sample, const std::string& cut,
+                                                         const std::vector<double>& edges) const
+  {
+    size_t nbins = edges.size() > 1 ? edges.size() - 1 : 0;
+    std::vector<double> hist(nbins, 0.);
+    auto const& bitmaps = _bitmaps[SampleIndex(sample)];
+    auto const& values = bitmaps.nminus1[CutIndex(cut)];
+    if (values.empty()) {
+      std::cout << "ERROR!! CutBitmapStore: cut " << cut << " was added without an N-1 variable" << std::endl;
+      return hist;
+    }
+    if (!nbins) return hist;
+
+    std::vector<std::string> others;
+    for (auto const& name : _cut_names)
+      if (name != cut) others.push_back(name);
+    Passing(sample, others).ForEach([&](uint32_t row) {
+        double x = values[row];
+        if (!(x >= edges.front() && x <= edges.back())) return;
+        size_t bin = std::upper_bound(edges.begin(), edges.end(), x) - edges.begin() - 1;
+        hist[std::min(bin, nbins - 1)] += bitmaps.weights[row];
+      });
+    return hist;
+  }
+
+  std::vector<double> CutBitmapStore::Overlap(const std::string& sample, const std::string& a, const std::string& b) const
+  {
+    auto const& bitmaps = _bitmaps[SampleIndex(sample)];
+    EventBitmap bits_a = bitmaps.base.And(bitmaps.cuts[CutIndex(a)]);
+    EventBitmap bits_b = bitmaps.base.And(bitmaps.cuts[CutIndex(b)]);
+    return { bits_a.And(bits_b).WeightedSum(bitmaps.weights),
+             bits_a.AndNot(bits_b).WeightedSum(bitmaps.weights),
+             bits_b.AndNot(bits_a).WeightedSum(bitmaps.weights) };
+  }
+
+  void CutBitmapStore::PrintCutFlow() const
+  {
+    std::cout << std::setw(20) << std::left << "cut";
+    for (auto const& sample : _sample_names) std::cout << std::setw(14) << std::right << sample;
+    std::cout << std::endl;
+
+    std::vector<std::vector<double> > flows;
+    for (auto const& sample : _sample_names) flows.push_back(CutFlow(sample));
+    for (size_t c = 0; c <= _cut_names.size(); ++c) {
+      std::cout << std::setw(20) << std::left << (c ? "+ " + _cut_names[c - 1] : std::string("base"));
+      for (auto const& flow : flows) std::cout << std::setw(14) << std::right << flow[c];
+      std::cout << std::endl;
+    }
+  }
+
+}
+
+#endif
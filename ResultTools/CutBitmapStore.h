@@ -0,0 +1,96 @@
+/**
+ * \file CutBitmapStore.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class CutBitmapStore
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_CUTBITMAPSTORE_H
+#define LEE_CUTBITMAPSTORE_H
+
+#include <string>
+#include <vector>
+#include "StackBuilder.h"
+#include "EventBitmap.h"
+
+namespace lee {
+
+  /**
+     \class CutBitmapStore
+     For every sample of a StackBuilder, one EventBitmap (over tree entries) per elementary
+     cut (IE "Edep" : "_e_Edep > 60.", "BGW" : ..., "fidvol" : ...), plus the scaled weights
+     of the entries, filled in one pass per sample (samples in parallel).
+     Cut flows, N-1 yields/plots and cut overlaps are then intersections of bitmaps and
+     weighted counts, without reading the trees again.
+     Only entries passing the base cut (and the sample cut) are in any bitmap.
+   */
+  class CutBitmapStore {
+
+  public:
+
+    /// Default constructor
+    CutBitmapStore(StackBuilder& samples) : _samples(&samples) {}
+
+    /// Default destructor
+    virtual ~CutBitmapStore() {}
+
+    /// Add an elementary cut. If nminus1_var is given, its values are kept for NMinusOneHistogram.
+    void AddCut(const std::string& name, const std::string& expr, const std::string& nminus1_var = "");
+
+    /// Fill the bitmaps (entries passing base_cut only). Returns false on error.
+    bool Build(const std::string& base_cut = "");
+
+    /// Entries of a sample passing one cut
+    const EventBitmap& Bitmap(const std::string& sample, const std::string& cut) const;
+
+    /// Entries of a sample passing all the given cuts (all entries passing the base cut if none)
+    EventBitmap Passing(const std::string& sample, const std::vector<std::string>& cuts) const;
+
+    /// Scaled yield of the entries passing all the given cuts
+    double Yield(const std::string& sample, const std::vector<std::string>& cuts) const;
+
+    /// Yields after each cut, in AddCut order (first entry: base cut only)
+    std::vector<double> CutFlow(const std::string& sample) const;
+
+    /// Scaled yield of the entries passing all cuts but this one
+    double NMinusOneYield(const std::string& sample, const std::string& cut) const;
+
+    /// numpy-style histogram of the cut's nminus1_var for the entries passing all cuts but this one
+    std::vector<double> NMinusOneHistogram(const std::string& sample, const std::string& cut,
+                                           const std::vector<double>& edges) const;
+
+    /// Scaled yields of the entries passing {a and b, a only, b only}
+    std::vector<double> Overlap(const std::string& sample, const std::string& a, const std::string& b) const;
+
+    /// Print the cut flow table of all samples
+    void PrintCutFlow() const;
+
+  private:
+
+    struct SampleBitmaps_t {
+      EventBitmap base;
+      std::vector<EventBitmap> cuts;
+      std::vector<double> weights;                ///< scaled weight of every entry
+      std::vector<std::vector<double> > nminus1;  ///< nminus1_var values of every entry (per cut, may be empty)
+    };
+
+    size_t SampleIndex(const std::string& sample) const;
+    size_t CutIndex(const std::string& cut) const;
+
+    StackBuilder* _samples; //!
+    std::vector<std::string> _cut_names, _cut_exprs, _nminus1_vars;
+    std::vector<std::string> _sample_names;
+    std::vector<SampleBitmaps_t> _bitmaps; //!
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
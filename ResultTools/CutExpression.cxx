@@ -0,0 +1,454 @@
+#ifndef LEE_CUTEXPRESSION_CXX
+#define LEE_CUTEXPRESSION_CXX
+
+#include "CutExpression.h"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+
+namespace lee {
+
+  namespace {
+
+    const char* OpName(CutExpression::OpCode_t op)
+    {
+      switch (op) {
+      case CutExpression::kPushColumn: return "column";
+      case CutExpression::kPushConst:  return "const";
+      case CutExpression::kAdd:  return "add";
+      case CutExpression::kSub:  return "sub";
+      case CutExpression::kMul:  return "mul";
+      case CutExpression::kDiv:  return "div";
+      case CutExpression::kLT:   return "lt";
+      case CutExpression::kLE:   return "le";
+      case CutExpression::kGT:   return "gt";
+      case CutExpression::kGE:   return "ge";
+      case CutExpression::kEQ:   return "eq";
+      case CutExpression::kNE:   return "ne";
+      case CutExpression::kAnd:  return "and";
+      case CutExpression::kOr:   return "or";
+      case CutExpression::kNeg:  return "neg";
+      case CutExpression::kNot:  return "not";
+      case CutExpression::kAbs:  return "abs";
+      case CutExpression::kSqrt: return "sqrt";
+      }
+      return "?";
+    }
+
+    bool IsUnary(CutExpression::OpCode_t op)
+    { return op == CutExpression::kNeg || op == CutExpression::kNot || op == CutExpression::kAbs || op == CutExpression::kSqrt; }
+
+    double ApplyUnary(CutExpression::OpCode_t op, double a)
+    {
+      switch (op) {
+      case CutExpression::kNeg:  return -a;
+      case CutExpression::kNot:  return a == 0. ? 1. : 0.;
+      case CutExpression::kAbs:  return std::fabs(a);
+      case CutExpression::kSqrt: return std::sqrt(a);
+      default: return a;
+      }
+    }
+
+    double ApplyBinary(CutExpression::OpCode_t op, double a, double b)
+    {
+      switch (op) {
+      case CutExpression::kAdd: return a + b;
+      case CutExpression::kSub: return a - b;
+      case CutExpression::kMul: return a * b;
+      case CutExpression::kDiv: return a / b;
+      case CutExpression::kLT:  return a <  b ? 1. : 0.;
+      case CutExpression::kLE:  return a <= b ? 1. : 0.;
+      case CutExpression::kGT:  return a >  b ? 1. : 0.;
+      case CutExpression::kGE:  return a >= b ? 1. : 0.;
+      case CutExpression::kEQ:  return a == b ? 1. : 0.;
+      case CutExpression::kNE:  return a != b ? 1. : 0.;
+      case CutExpression::kAnd: return (a != 0. && b != 0.) ? 1. : 0.;
+      case CutExpression::kOr:  return (a != 0. || b != 0.) ? 1. : 0.;
+      default: return a;
+      }
+    }
+
+    /// out[k] = lhs[k] OP rhs[k] over a block; one simple loop per op so the compiler can vectorize it
+    template <class RHS>
+    void BinaryLoop(CutExpression::OpCode_t op, const double* lhs, RHS rhs, size_t n, double* out)
+    {
+      switch (op) {
+      case CutExpression::kAdd: for (size_t k = 0; k < n; ++k) out[k] = lhs[k] + rhs(k); break;
+      case CutExpression::kSub: for (size_t k = 0; k < n; ++k) out[k] = lhs[k] - rhs(k); break;
+      case CutExpression::kMul: for (size_t k = 0; k < n; ++k) out[k] = lhs[k] * rhs(k); break;
+      case CutExpression::kDiv: for (size_t k = 0; k < n; ++k) out[k] = lhs[k] / rhs(k); break;
+      case CutExpression::kLT:  for (size_t k = 0; k < n; ++k) out[k] = lhs[k] <  rhs(k); break;
+      case CutExpression::kLE:  for (size_t k = 0; k < n; ++k) out[k] = lhs[k] <= rhs(k); break;
+      case CutExpression::kGT:  for (size_t k = 0; k < n; ++k) out[k] = lhs[k] >  rhs(k); break;
+      case CutExpression::kGE:  for (size_t k = 0; k < n; ++k) out[k] = lhs[k] >= rhs(k); break;
+      case CutExpression::kEQ:  for (size_t k = 0; k < n; ++k) out[k] = lhs[k] == rhs(k); break;
+      case CutExpression::kNE:  for (size_t k = 0; k < n; ++k) out[k] = lhs[k] != rhs(k); break;
+      case CutExpression::kAnd: for (size_t k = 0; k < n; ++k) out[k] = (lhs[k] != 0.) & (rhs(k) != 0.); break;
+      case CutExpression::kOr:  for (size_t k = 0; k < n; ++k) out[k] = (lhs[k] != 0.) | (rhs(k) != 0.); break;
+      default: break;
+      }
+    }
+
+  }
+
+  /// Grammar, lowest precedence first:
+  ///   or  : and  ( ("or"|"||"|"|") and )*
+  ///   and : not  ( ("and"|"&&"|"&") not )*
+  ///   not : ("not"|"!"|"~") not | cmp
+  ///   cmp : sum  ( ("<"|"<="|">"|">="|"=="|"!=") sum )?
+  ///   sum : prod ( ("+"|"-") prod )*
+  ///   prod: unary ( ("*"|"/") unary )*
+  ///   unary: ("-"|"+") unary | primary
+  ///   primary: number | True | False | column | abs(or) | sqrt(or) | (or)
+  class CutExpression::Parser {
+
+  public:
+
+    Parser(CutExpression& expr, const std::string& text) : _expr(expr), _text(text), _pos(0) {}
+
+    void Parse()
+    {
+      ParseOr();
+      SkipSpace();
+      if (_pos != _text.size()) Fail("unexpected '" + _text.substr(_pos) + "'");
+    }
+
+  private:
+
+    void Fail(const std::string& msg) const
+    {
+      std::ostringstream ss;
+      ss << msg << " (at character " << _pos << ")";
+      throw std::runtime_error(ss.str());
+    }
+
+    void SkipSpace()
+    { while (_pos < _text.size() && std::isspace((unsigned char)_text[_pos])) ++_pos; }
+
+    static bool IsIdentChar(char c)
+    { return std::isalnum((unsigned char)c) || c == '_' || c == '.'; }
+
+    /// Consume a symbol (IE "<=") if it comes next
+    bool Accept(const char* symbol)
+    {
+      SkipSpace();
+      size_t len = std::string(symbol).size();
+      if (_text.compare(_pos, len, symbol) != 0) return false;
+      _pos += len;
+      return true;
+    }
+
+    /// Consume a keyword (IE "and") if it comes next as a whole word
+    bool AcceptWord(const char* word)
+    {
+      SkipSpace();
+      size_t len = std::string(word).size();
+      if (_text.compare(_pos, len, word) != 0) return false;
+      if (_pos + len < _text.size() && IsIdentChar(_text[_pos + len])) return false;
+      _pos += len;
+      return true;
+    }
+
+    void ParseOr()
+    {
+      ParseAnd();
+      while (AcceptWord("or") || Accept("||") || Accept("|")) {
+        ParseAnd();
+        _expr.Emit(kOr);
+      }
+    }
+
+    void ParseAnd()
+    {
+      ParseNot();
+      while (AcceptWord("and") || Accept("&&") || Accept("&")) {
+        ParseNot();
+        _expr.Emit(kAnd);
+      }
+    }
+
+    void ParseNot()
+    {
+      SkipSpace();
+      if (AcceptWord("not") || (_text.compare(_pos, 2, "!=") != 0 && Accept("!")) || Accept("~")) {
+        ParseNot();
+        _expr.Emit(kNot);
+        return;
+      }
+      ParseCmp();
+    }
+
+    bool AcceptCmp(OpCode_t& op)
+    {
+      if (Accept("<="))      op = kLE;
+      else if (Accept(">=")) op = kGE;
+      else if (Accept("==")) op = kEQ;
+      else if (Accept("!=")) op = kNE;
+      else if (Accept("<"))  op = kLT;
+      else if (Accept(">"))  op = kGT;
+      else return false;
+      return true;
+    }
+
+    void ParseCmp()
+    {
+      ParseSum();
+      OpCode_t op;
+      if (!AcceptCmp(op)) return;
+      ParseSum();
+      _expr.Emit(op);
+      if (AcceptCmp(op)) Fail("chained comparisons are not supported, use 'and'");
+    }
+
+    void ParseSum()
+    {
+      ParseProd();
+      while (true) {
+        if (Accept("+"))      { ParseProd(); _expr.Emit(kAdd); }
+        else if (Accept("-")) { ParseProd(); _expr.Emit(kSub); }
+        else return;
+      }
+    }
+
+    void ParseProd()
+    {
+      ParseUnary();
+      while (true) {
+        if (Accept("*"))      { ParseUnary(); _expr.Emit(kMul); }
+        else if (Accept("/")) { ParseUnary(); _expr.Emit(kDiv); }
+        else return;
+      }
+    }
+
+    void ParseUnary()
+    {
+      if (Accept("-")) { ParseUnary(); _expr.Emit(kNeg); return; }
+      if (Accept("+")) { ParseUnary(); return; }
+      ParsePrimary();
+    }
+
+    void ParseFunction(OpCode_t op)
+    {
+      if (!Accept("(")) Fail("expected '(' after function name");
+      ParseOr();
+      if (!Accept(")")) Fail("expected ')'");
+      _expr.Emit(op);
+    }
+
+    void ParsePrimary()
+    {
+      SkipSpace();
+      if (_pos >= _text.size()) Fail("unexpected end of expression");
+
+      if (Accept("(")) {
+        ParseOr();
+        if (!Accept(")")) Fail("expected ')'");
+        return;
+      }
+
+      char c = _text[_pos];
+      if (std::isdigit((unsigned char)c) || c == '.') {
+        const char* begin = _text.c_str() + _pos;
+        char* end = nullptr;
+        double value = std::strtod(begin, &end);
+        if (end == begin) Fail("bad number");
+        _pos += (end - begin);
+        _expr.EmitConst(value);
+        return;
+      }
+
+      if (std::isalpha((unsigned char)c) || c == '_') {
+        size_t start = _pos;
+        while (_pos < _text.size() && IsIdentChar(_text[_pos])) ++_pos;
+        std::string name = _text.substr(start, _pos - start);
+        if (name == "True"  || name == "true")  { _expr.EmitConst(1.); return; }
+        if (name == "False" || name == "false") { _expr.EmitConst(0.); return; }
+        if (name == "abs")  { ParseFunction(kAbs);  return; }
+        if (name == "sqrt") { ParseFunction(kSqrt); return; }
+        if (name == "and" || name == "or" || name == "not") Fail("misplaced '" + name + "'");
+        _expr.EmitColumn(name);
+        return;
+      }
+
+      Fail(std::string("unexpected '") + c + "'");
+    }
+
+    CutExpression& _expr;
+    const std::string& _text;
+    size_t _pos;
+  };
+
+  CutExpression::CutExpression(const std::string& expr)
+    : _valid(false), _max_depth(0)
+  {
+    Compile(expr);
+  }
+
+  void CutExpression::EmitConst(double value)
+  {
+    Instruction_t instr = { kPushConst, false, 0, value };
+    _code.push_back(instr);
+  }
+
+  void CutExpression::EmitColumn(const std::string& name)
+  {
+    size_t index = std::find(_columns.begin(), _columns.end(), name) - _columns.begin();
+    if (index == _columns.size()) _columns.push_back(name);
+    Instruction_t instr = { kPushColumn, false, index, 0. };
+    _code.push_back(instr);
+  }
+
+  void CutExpression::Emit(OpCode_t op)
+  {
+    // An operand that is a single kPushConst is always the last instruction(s) of the code
+    auto is_const = [this](size_t from_end) {
+      return _code.size() >= from_end && _code[_code.size() - from_end].op == kPushConst;
+    };
+
+    if (IsUnary(op)) {
+      if (is_const(1)) { _code.back().value = ApplyUnary(op, _code.back().value); return; }
+      Instruction_t instr = { op, false, 0, 0. };
+      _code.push_back(instr);
+      return;
+    }
+
+    // constant folding
+    if (is_const(1) && is_const(2)) {
+      double b = _code.back().value;
+      _code.pop_back();
+      _code.back().value = ApplyBinary(op, _code.back().value, b);
+      return;
+    }
+    // fuse a constant right operand into the operation
+    if (is_const(1)) {
+      Instruction_t instr = { op, true, 0, _code.back().value };
+      _code.back() = instr;
+      return;
+    }
+    Instruction_t instr = { op, false, 0, 0. };
+    _code.push_back(instr);
+  }
+
+  bool CutExpression::Compile(const std::string& expr)
+  {
+    _expr = expr;
+    _code.clear();
+    _columns.clear();
+    _max_depth = 0;
+    _valid = false;
+
+    bool blank = std::all_of(expr.begin(), expr.end(), [](char c) { return std::isspace((unsigned char)c); });
+    if (blank) {
+      EmitConst(1.);
+    }
+    else {
+      try {
+        Parser parser(*this, expr);
+        parser.Parse();
+      }
+      catch (const std::exception& e) {
+        std::cout << "ERROR!! CutExpression: can't parse \"" << expr << "\": " << e.what() << std::endl;
+        _code.clear();
+        _columns.clear();
+        return false;
+      }
+    }
+
+    // stack depth needed by Evaluate
+    size_t depth = 0;
+    for (auto const& instr : _code) {
+      if (instr.op == kPushColumn || instr.op == kPushConst) ++depth;
+      else if (!IsUnary(instr.op) && !instr.with_const) --depth;
+      _max_depth = std::max(_max_depth, depth);
+    }
+
+    _valid = true;
+    return true;
+  }
+
+  void CutExpression::Evaluate(const std::vector<const double*>& columns, size_t n, double* out) const
+  {
+    // nothing to evaluate (and no stack buffer to index)
+    if (!n) return;
+    if (!_valid) {
+      std::fill(out, out + n, 0.);
+      return;
+    }
+    if (columns.size() < _columns.size())
+      throw std::runtime_error("CutExpression::Evaluate: expected " + std::to_string(_columns.size()) + " columns");
+
+    // stack slot i is either a column (no copy) or its own buffer
+    std::vector<double> buffer(_max_depth * n);
+    std::vector<const double*> slot(_max_depth, nullptr);
+    size_t top = 0;
+
+    for (auto const& instr : _code) {
+      double* dest = nullptr;
+      switch (instr.op) {
+      case kPushColumn:
+        slot[top++] = columns[instr.column];
+        break;
+      case kPushConst:
+        dest = &buffer[top * n];
+        std::fill(dest, dest + n, instr.value);
+        slot[top++] = dest;
+        break;
+      case kNeg: case kNot: case kAbs: case kSqrt: {
+        const double* a = slot[top - 1];
+        dest = &buffer[(top - 1) * n];
+        if (instr.op == kNeg)       for (size_t k = 0; k < n; ++k) dest[k] = -a[k];
+        else if (instr.op == kNot)  for (size_t k = 0; k < n; ++k) dest[k] = (a[k] == 0.);
+        else if (instr.op == kAbs)  for (size_t k = 0; k < n; ++k) dest[k] = std::fabs(a[k]);
+        else                        for (size_t k = 0; k < n; ++k) dest[k] = std::sqrt(a[k]);
+        slot[top - 1] = dest;
+        break;
+      }
+      default:
+        if (instr.with_const) {
+          dest = &buffer[(top - 1) * n];
+          double b = instr.value;
+          BinaryLoop(instr.op, slot[top - 1], [b](size_t) { return b; }, n, dest);
+          slot[top - 1] = dest;
+        }
+        else {
+          dest = &buffer[(top - 2) * n];
+          const double* b = slot[top - 1];
+          BinaryLoop(instr.op, slot[top - 2], [b](size_t k) { return b[k]; }, n, dest);
+          slot[top - 2] = dest;
+          --top;
+        }
+        break;
+      }
+    }
+
+    std::copy(slot[0], slot[0] + n, out);
+  }
+
+  void CutExpression::EvaluateMask(const std::vector<const double*>& columns, size_t n, char* mask) const
+  {
+    std::vector<double> values(n);
+    Evaluate(columns, n, values.data());
+    for (size_t k = 0; k < n; ++k) mask[k] = (values[k] != 0.);
+  }
+
+  std::string CutExpression::Disassemble() const
+  {
+    std::ostringstream ss;
+    ss << "\"" << _expr << "\"" << (_valid ? "" : " (invalid)") << std::endl;
+    for (size_t i = 0; i < _code.size(); ++i) {
+      auto const& instr = _code[i];
+      ss << "  " << i << "  " << OpName(instr.op);
+      if (instr.op == kPushColumn) ss << " " << _columns[instr.column];
+      else if (instr.op == kPushConst || instr.with_const) ss << " " << instr.value;
+      ss << std::endl;
+    }
+    return ss.str();
+  }
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * \file CutExpression.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class CutExpression
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_CUTEXPRESSION_H
+#define LEE_CUTEXPRESSION_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace lee {
+
+  /**
+     \class CutExpression
+     An analysis cut/variable expression over result tree columns, in the pandas df.query
+     syntax used by stack_plotter.py (IE "_e_Edep > 60. and _flash_time > 3.5").
+     The string is parsed once into a small stack-machine bytecode, which is then evaluated
+     column-wise on blocks of rows: every instruction is one tight loop over the block.
+     A binary operation whose right operand is a constant (IE "_x_vtx > 10.") is fused into a
+     single instruction, and constant sub-expressions are folded at compile time.
+
+     Supported: numbers, True/False, column names, + - * /, unary -, < <= > >= == !=,
+     and/&&/&, or/||/|, not/!/~, abs(), sqrt(), parentheses. Comparisons are 1. or 0.
+   */
+  class CutExpression {
+
+  public:
+
+    /// Default constructor (an empty expression is always true)
+    CutExpression(const std::string& expr = "");
+
+    /// Default destructor
+    ~CutExpression() {}
+
+    /// Parse and compile an expression. Returns false (and prints why) if it can't be parsed.
+    bool Compile(const std::string& expr);
+
+    bool IsValid() const { return _valid; }
+
+    const std::string& Expression() const { return _expr; }
+
+    /// Columns used by the expression, in the order Evaluate expects them
+    const std::vector<std::string>& Columns() const { return _columns; }
+
+    /// Evaluate n rows: columns[i] points to the n values of Columns()[i]
+    void Evaluate(const std::vector<const double*>& columns, size_t n, double* out) const;
+
+    /// Evaluate n rows as a cut: mask[k] = (value != 0)
+    void EvaluateMask(const std::vector<const double*>& columns, size_t n, char* mask) const;
+
+    /// Human readable bytecode
+    std::string Disassemble() const;
+
+    /// Instructions of the bytecode
+    enum OpCode_t {
+      kPushColumn = 0,
+      kPushConst,
+      kAdd, kSub, kMul, kDiv,
+      kLT, kLE, kGT, kGE, kEQ, kNE,
+      kAnd, kOr,
+      kNeg, kNot, kAbs, kSqrt
+    };
+
+    struct Instruction_t {
+      OpCode_t op;
+      bool     with_const; ///< binary op with the constant value as right operand
+      size_t   column;     ///< kPushColumn: index in Columns()
+      double   value;      ///< kPushConst, or the right operand if with_const
+    };
+
+  private:
+
+    /// Recursive descent parser, emitting the bytecode
+    class Parser;
+
+    void Emit(OpCode_t op);
+    void EmitConst(double value);
+    void EmitColumn(const std::string& name);
+
+    std::string _expr;
+    bool _valid;
+    std::vector<Instruction_t> _code; //!
+    std::vector<std::string> _columns;
+    size_t _max_depth;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,151 @@
+#ifndef LEE_CUTSCANNER_CXX
+#define LEE_CUTSCANNER_CXX
+
+#include "CutScanner.h"
+#include "TreeCutEvaluator.h"
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+
+namespace lee {
+
+  void CutScanner::SetSignal(const std::string& sample, bool is_signal)
+  {
+    if (is_signal) _signal_samples.insert(sample);
+    else _signal_samples.erase(sample);
+  }
+
+  bool CutScanner::Scan(const std::string& var, const std::vector<double>& thresholds, bool keep_above,
+                        const std::string& cut)
+  {
+    // a second variable that every row passes
+    return Scan2D(var, thresholds, keep_above, "0", { -std::numeric_limits<double>::infinity() }, true, cut);
+  }
+
+  void CutScanner::GridYields(std::vector<Row_t>& rows, const std::vector<double>& t1, const std::vector<double>& t2,
+                              std::vector<double>& yields)
+  {
+    size_t n1 = t1.size(), n2 = t2.size();
+    yields.assign(n1 * n2, 0.);
+
+    // thresholds in sweep order: t1 descending, t2 ascending
+    std::vector<size_t> order1(n1), order2(n2);
+    std::iota(order1.begin(), order1.end(), 0);
+    std::iota(order2.begin(), order2.end(), 0);
+    std::sort(order1.begin(), order1.end(), [&t1](size_t i, size_t j) { return t1[i] > t1[j]; });
+    std::sort(order2.begin(), order2.end(), [&t2](size_t i, size_t j) { return t2[i] < t2[j]; });
+    std::vector<double> t2_sorted;
+    for (auto i : order2) t2_sorted.push_back(t2[i]);
+
+    // a row passes the sorted t2 thresholds [0, k), k = number of t2 thresholds below b
+    std::sort(rows.begin(), rows.end(), [](const Row_t& x, const Row_t& y) { return x.a > y.a; });
+    std::vector<size_t> k(rows.size());
+    for (size_t r = 0; r < rows.size(); ++r)
+      k[r] = std::lower_bound(t2_sorted.begin(), t2_sorted.end(), rows[r].b) - t2_sorted.begin();
+
+    // sweep t1 downwards, adding the rows that now pass it
+    std::vector<double> added(n2 + 1, 0.);
+    size_t next = 0;
+    for (auto i1 : order1) {
+      while (next < rows.size() && rows[next].a > t1[i1]) {
+        added[k[next]] += rows[next].w;
+        ++next;
+      }
+      double passing = 0.;
+      for (size_t j = n2; j-- > 0;) {
+        passing += added[j + 1];
+        yields[i1 * n2 + order2[j]] = passing;
+      }
+    }
+  }
+
+  bool CutScanner::Scan2D(const std::string& var1, const std::vector<double>& thresholds1, bool keep_above1,
+                          const std::string& var2, const std::vector<double>& thresholds2, bool keep_above2,
+                          const std::string& cut)
+  {
+    _var1 = var1 + (keep_above1 ? " > " : " < ");
+    _var2 = var2 == "0" ? "" : var2 + (keep_above2 ? " > " : " < ");
+    _thresholds1 = thresholds1;
+    _thresholds2 = thresholds2;
+    _n2 = thresholds2.size();
+    size_t ngrid = thresholds1.size() * _n2;
+
+    // "x < t" is cut as "-x > -t"
+    double s1 = keep_above1 ? 1. : -1.;
+    double s2 = keep_above2 ? 1. : -1.;
+    std::vector<double> t1, t2;
+    for (auto t : thresholds1) t1.push_back(s1 * t);
+    for (auto t : thresholds2) t2.push_back(s2 * t);
+
+    std::vector<std::vector<double> > sample_yields(_samples->NSamples());
+    std::vector<double> sample_totals(_samples->NSamples(), 0.);
+
+    bool ok = _samples->ForEachSample(cut, [&](StackBuilder::Sample_t& sample, size_t i,
+                                              TreeCutEvaluator& evaluator, const std::string& mycut) {
+        std::vector<Row_t> rows;
+        bool scanned = evaluator.Scan({ var1, var2, mycut, sample.weight },
+                                      [&](size_t, size_t n, const std::vector<const double*>& v) {
+            for (size_t k = 0; k < n; ++k) {
+              if (v[2][k] == 0. || std::isnan(v[0][k]) || std::isnan(v[1][k])) continue;
+              Row_t row = { s1 * v[0][k], s2 * v[1][k], v[3][k] * sample.scale };
+              rows.push_back(row);
+            }
+          });
+        if (!scanned) return false;
+        for (auto const& row : rows) sample_totals[i] += row.w;
+        GridYields(rows, t1, t2, sample_yields[i]);
+        return true;
+      });
+    if (!ok) return false;
+
+    _signal.assign(ngrid, 0.);
+    _background.assign(ngrid, 0.);
+    double signal_total = 0.;
+    auto names = _samples->Samples();
+    for (size_t i = 0; i < names.size(); ++i) {
+      bool is_signal = _signal_samples.count(names[i]);
+      auto& sum = is_signal ? _signal : _background;
+      for (size_t g = 0; g < ngrid; ++g) sum[g] += sample_yields[i][g];
+      if (is_signal) signal_total += sample_totals[i];
+    }
+    if (_signal_samples.empty())
+      std::cout << "WARNING: CutScanner has no signal sample (SetSignal)!" << std::endl;
+
+    _efficiency.assign(ngrid, 0.);
+    _purity.assign(ngrid, 0.);
+    _fom.assign(ngrid, 0.);
+    for (size_t g = 0; g < ngrid; ++g) {
+      double s = _signal[g], b = _background[g];
+      if (signal_total > 0.) _efficiency[g] = s / signal_total;
+      if (s + b > 0.) _purity[g] = s / (s + b);
+      switch (_fom_type) {
+      case kSOverSqrtB:     _fom[g] = b > 0. ? s / std::sqrt(b) : 0.; break;
+      case kSOverSqrtSB:    _fom[g] = s + b > 0. ? s / std::sqrt(s + b) : 0.; break;
+      case kEffTimesPurity: _fom[g] = _efficiency[g] * _purity[g]; break;
+      }
+    }
+    return true;
+  }
+
+  size_t CutScanner::Best() const
+  {
+    return std::max_element(_fom.begin(), _fom.end()) - _fom.begin();
+  }
+
+  void CutScanner::Print() const
+  {
+    if (_fom.empty()) return;
+    size_t best = Best();
+    std::cout << "CutScanner best cut: " << _var1 << _thresholds1[best / _n2];
+    if (!_var2.empty()) std::cout << " and " << _var2 << _thresholds2[best % _n2];
+    std::cout << std::endl
+              << "  signal " << _signal[best] << " background " << _background[best]
+              << " efficiency " << _efficiency[best] << " purity " << _purity[best]
+              << " FOM " << _fom[best] << std::endl;
+  }
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * \file CutScanner.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class CutScanner
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_CUTSCANNER_H
+#define LEE_CUTSCANNER_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include "StackBuilder.h"
+
+namespace lee {
+
+  /**
+     \class CutScanner
+     Scans cut thresholds on the samples of a StackBuilder (IE _e_Edep > t, or
+     _dist_2wall_shr > t1 and _vertex_energy < t2), instead of one plot per guess.
+     Each sample is read once (samples in parallel): its rows passing the base cut are sorted
+     by the first variable, and the thresholds are swept in order while the rows are added to
+     cumulative sums over the second variable's thresholds, so every grid point costs O(1).
+     For each grid point: signal and background yields (scaled, summed over the signal /
+     other samples), signal efficiency (w.r.t. the base cut), purity and the figure of merit.
+     2D results are flattened: index = i1 * n2 + i2.
+   */
+  class CutScanner {
+
+  public:
+
+    /// Figures of merit
+    enum FOM_t {
+      kSOverSqrtB = 0,   ///< S/sqrt(B)
+      kSOverSqrtSB,      ///< S/sqrt(S+B)
+      kEffTimesPurity    ///< efficiency * purity
+    };
+
+    /// Default constructor
+    CutScanner(StackBuilder& samples) : _samples(&samples), _fom_type(kSOverSqrtB), _n2(1) {}
+
+    /// Default destructor
+    virtual ~CutScanner() {}
+
+    /// Count this sample as signal (the others are background)
+    void SetSignal(const std::string& sample, bool is_signal = true);
+
+    void SetFigureOfMerit(FOM_t fom) { _fom_type = fom; }
+
+    /// 1D scan: keep var > threshold (keep_above) or var < threshold, on top of cut
+    bool Scan(const std::string& var, const std::vector<double>& thresholds, bool keep_above = true,
+              const std::string& cut = "");
+
+    /// 2D scan of (var1, var2) thresholds
+    bool Scan2D(const std::string& var1, const std::vector<double>& thresholds1, bool keep_above1,
+                const std::string& var2, const std::vector<double>& thresholds2, bool keep_above2,
+                const std::string& cut = "");
+
+    const std::vector<double>& Signal() const     { return _signal; }
+    const std::vector<double>& Background() const { return _background; }
+    const std::vector<double>& Efficiency() const { return _efficiency; }
+    const std::vector<double>& Purity() const     { return _purity; }
+    const std::vector<double>& FOM() const        { return _fom; }
+
+    /// Index of the grid point with the best figure of merit
+    size_t Best() const;
+
+    /// Print the best grid point of the last scan
+    void Print() const;
+
+  private:
+
+    /// One row passing the base cut: the two variables, signed so that both cuts are ">", and its weight
+    struct Row_t { double a, b, w; };
+
+    /// Yields of the rows on the grid of signed thresholds t1 x t2 (sorts rows)
+    static void GridYields(std::vector<Row_t>& rows, const std::vector<double>& t1, const std::vector<double>& t2,
+                           std::vector<double>& yields);
+
+    StackBuilder* _samples; //!
+    std::set<std::string> _signal_samples;
+    FOM_t _fom_type;
+
+    std::vector<double> _thresholds1, _thresholds2;
+    std::string _var1, _var2;
+    size_t _n2;
+    std::vector<double> _signal, _background, _efficiency, _purity, _fom;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,99 @@
+#ifndef LEE_DISCRIMINANTSCORER_CXX
+#define LEE_DISCRIMINANTSCORER_CXX
+
+#include "DiscriminantScorer.h"
+#include "TreeCutEvaluator.h"
+#include "TFile.h"
+#include <iostream>
+#include <memory>
+
+namespace lee {
+
+  bool DiscriminantScorer::Loop(TTree* tree, const std::string& cut, const std::function<void(size_t, double)>& func) const
+  {
+    auto const& features = _bdt ? _bdt->Features() : _logistic->Features();
+    std::vector<std::string> exprs = { cut };
+    exprs.insert(exprs.end(), features.begin(), features.end());
+    if (_bdt && !_bdt->Compiled()) {
+      std::cout << "ERROR!! DiscriminantScorer: BDTModel " << _bdt->GetName() << " is not compiled (use BDTModel::Load or Compile)" << std::endl;
+      return false;
+    }
+
+    std::vector<const double*> columns(features.size());
+    std::vector<double> scores, row(features.size());
+    TreeCutEvaluator evaluator(tree);
+    return evaluator.Scan(exprs, [&](size_t first, size_t n, const std::vector<const double*>& v) {
+        scores.resize(n);
+        if (_bdt) {
+          for (size_t j = 0; j < columns.size(); ++j) columns[j] = v[j + 1];
+          _bdt->Score(columns, n, scores.data());
+        }
+        else
+          for (size_t k = 0; k < n; ++k) {
+            for (size_t j = 0; j < row.size(); ++j) row[j] = v[j + 1][k];
+            scores[k] = _logistic->Probability(row.data());
+          }
+        for (size_t k = 0; k < n; ++k)
+          if (v[0][k] != 0.) func(first + k, scores[k]);
+      });
+  }
+
+  std::vector<double> DiscriminantScorer::Scores(TTree* tree, const std::string& cut) const
+  {
+    std::vector<double> scores;
+    if (!tree) return scores;
+    scores.reserve(tree->GetEntries());
+    if (!Loop(tree, cut, [&scores](size_t, double score) { scores.push_back(score); }))
+      std::cout << "ERROR!! DiscriminantScorer could not score " << tree->GetName() << std::endl;
+    return scores;
+  }
+
+  std::vector<double> DiscriminantScorer::Scores(const std::string& filename, const std::string& treename,
+                                                 const std::string& cut) const
+  {
+    std::unique_ptr<TFile> f(TFile::Open(filename.c_str(), "READ"));
+    auto tree = f ? dynamic_cast<TTree*>(f->Get(treename.c_str())) : nullptr;
+    if (!tree) {
+      std::cout << "ERROR!! DiscriminantScorer: no tree " << treename << " in " << filename << std::endl;
+      return std::vector<double>();
+    }
+    return Scores(tree, cut);
+  }
+
+  bool DiscriminantScorer::WriteFriend(const std::string& filename, const std::string& treename, const std::string& outfile,
+                                       const std::string& friend_name, const std::string& branch) const
+  {
+    std::unique_ptr<TFile> fin(TFile::Open(filename.c_str(), "READ"));
+    auto input = fin ? dynamic_cast<TTree*>(fin->Get(treename.c_str())) : nullptr;
+    if (!input) {
+      std::cout << "ERROR!! DiscriminantScorer: no tree " << treename << " in " << filename << std::endl;
+      return false;
+    }
+    std::vector<double> scores;
+    scores.reserve(input->GetEntries());
+    if (!Loop(input, "", [&scores](size_t, double score) { scores.push_back(score); })) {
+      std::cout << "ERROR!! DiscriminantScorer could not score " << treename << " of " << filename << std::endl;
+      return false;
+    }
+
+    std::unique_ptr<TFile> fout(TFile::Open(outfile.c_str(), "RECREATE"));
+    if (!fout || fout->IsZombie()) {
+      std::cout << "ERROR!! DiscriminantScorer could not open " << outfile << std::endl;
+      return false;
+    }
+    fout->cd();
+    double score = 0.;
+    auto tree = new TTree(friend_name.c_str(), ("scores of " + treename).c_str());
+    tree->Branch(branch.c_str(), &score, (branch + "/D").c_str());
+    for (auto s : scores) {
+      score = s;
+      tree->Fill();
+    }
+    tree->Write();
+    fout->Close();
+    return true;
+  }
+
+}
+
+#endif
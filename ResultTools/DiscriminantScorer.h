@@ -0,0 +1,69 @@
+/**
+ * \file DiscriminantScorer.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class DiscriminantScorer
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_DISCRIMINANTSCORER_H
+#define LEE_DISCRIMINANTSCORER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "TTree.h"
+#include "BDTModel.h"
+#include "LogisticModel.h"
+
+namespace lee {
+
+  /**
+     \class DiscriminantScorer
+     Scores finished result trees with a discriminant model (lee::util::BDTModel or
+     lee::util::LogisticModel): the model features are read as TreeCutEvaluator expressions,
+     block by block, and a BDTModel scores each block at once (column-wise).
+     The scores are returned for the entries passing a cut, or written for every entry as
+     a friend tree (IE to cut on the score in stack_plotter.py without running the analysis again).
+   */
+  class DiscriminantScorer {
+
+  public:
+
+    /// Score with a BDT (the model must outlive the scorer)
+    DiscriminantScorer(const util::BDTModel& model) : _bdt(&model), _logistic(nullptr) {}
+
+    /// Score with a logistic regression (the model must outlive the scorer)
+    DiscriminantScorer(const util::LogisticModel& model) : _bdt(nullptr), _logistic(&model) {}
+
+    /// Default destructor
+    virtual ~DiscriminantScorer() {}
+
+    /// Scores of the entries passing cut
+    std::vector<double> Scores(TTree* tree, const std::string& cut = "") const;
+    std::vector<double> Scores(const std::string& filename, const std::string& treename, const std::string& cut = "") const;
+
+    /// Write the score of every entry of the tree (branch "<branch>/D") to a tree friend_name in outfile
+    /// (recreated). Returns false on error.
+    bool WriteFriend(const std::string& filename, const std::string& treename, const std::string& outfile,
+                     const std::string& friend_name = "scores", const std::string& branch = "_discriminant") const;
+
+  private:
+
+    /// Score every entry passing cut, in entry order: func(entry, score)
+    bool Loop(TTree* tree, const std::string& cut, const std::function<void(size_t, double)>& func) const;
+
+    const util::BDTModel* _bdt;
+    const util::LogisticModel* _logistic;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
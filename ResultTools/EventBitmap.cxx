@@ -0,0 +1,273 @@
+#ifndef LEE_EVENTBITMAP_CXX
+#define LEE_EVENTBITMAP_CXX
+
+#include "EventBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+namespace lee {
+
+  const uint32_t EventBitmap::kMaxArraySize;
+
+  EventBitmap EventBitmap::Range(uint32_t n)
+  {
+    EventBitmap bitmap;
+    for (uint32_t start = 0; start < n; start += 65536) {
+      Container_t c;
+      c.key = start >> 16;
+      c.cardinality = std::min<uint32_t>(n - start, 65536);
+      c.bits.assign(1024, 0);
+      for (uint32_t w = 0; w < c.cardinality / 64; ++w) c.bits[w] = ~(uint64_t)0;
+      if (c.cardinality % 64) c.bits[c.cardinality / 64] = ((uint64_t)1 << (c.cardinality % 64)) - 1;
+      Optimize(c);
+      bitmap._containers.push_back(c);
+    }
+    return bitmap;
+  }
+
+  void EventBitmap::ToBits(Container_t& c)
+  {
+    if (!c.bits.empty()) return;
+    c.bits.assign(1024, 0);
+    for (auto low : c.array) c.bits[low >> 6] |= (uint64_t)1 << (low & 63);
+    c.array.clear();
+    c.array.shrink_to_fit();
+  }
+
+  void EventBitmap::Optimize(Container_t& c)
+  {
+    if (c.bits.empty() && c.cardinality > kMaxArraySize) ToBits(c);
+    else if (!c.bits.empty() && c.cardinality <= kMaxArraySize) {
+      c.array.clear();
+      c.array.reserve(c.cardinality);
+      for (size_t w = 0; w < c.bits.size(); ++w) {
+        uint64_t word = c.bits[w];
+        while (word) {
+          c.array.push_back((uint16_t)(w * 64 + __builtin_ctzll(word)));
+          word &= word - 1;
+        }
+      }
+      c.bits.clear();
+      c.bits.shrink_to_fit();
+    }
+  }
+
+  void EventBitmap::Add(uint32_t row)
+  {
+    uint16_t key = row >> 16;
+    uint16_t low = row & 0xFFFF;
+
+    auto it = _containers.end();
+    if (_containers.empty() || _containers.back().key < key) {
+      Container_t c;
+      c.key = key;
+      c.cardinality = 0;
+      _containers.push_back(c);
+      it = _containers.end() - 1;
+    }
+    else if (_containers.back().key == key)
+      it = _containers.end() - 1;
+    else {
+      it = std::lower_bound(_containers.begin(), _containers.end(), key,
+                            [](const Container_t& c, uint16_t k) { return c.key < k; });
+      if (it == _containers.end() || it->key != key) {
+        Container_t c;
+        c.key = key;
+        c.cardinality = 0;
+        it = _containers.insert(it, c);
+      }
+    }
+
+    auto& c = *it;
+    if (!c.bits.empty()) {
+      uint64_t mask = (uint64_t)1 << (low & 63);
+      if (!(c.bits[low >> 6] & mask)) {
+        c.bits[low >> 6] |= mask;
+        ++c.cardinality;
+      }
+      return;
+    }
+    if (c.array.empty() || c.array.back() < low) c.array.push_back(low);
+    else {
+      auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+      if (pos != c.array.end() && *pos == low) return;
+      c.array.insert(pos, low);
+    }
+    ++c.cardinality;
+    if (c.cardinality > kMaxArraySize) ToBits(c);
+  }
+
+  bool EventBitmap::Contains(uint32_t row) const
+  {
+    uint16_t key = row >> 16;
+    uint16_t low = row & 0xFFFF;
+    auto it = std::lower_bound(_containers.begin(), _containers.end(), key,
+                               [](const Container_t& c, uint16_t k) { return c.key < k; });
+    if (it == _containers.end() || it->key != key) return false;
+    if (!it->bits.empty()) return it->bits[low >> 6] & ((uint64_t)1 << (low & 63));
+    return std::binary_search(it->array.begin(), it->array.end(), low);
+  }
+
+  uint64_t EventBitmap::Cardinality() const
+  {
+    uint64_t n = 0;
+    for (auto const& c : _containers) n += c.cardinality;
+    return n;
+  }
+
+  EventBitmap::Container_t EventBitmap::And(const Container_t& a, const Container_t& b)
+  {
+    Container_t r;
+    r.key = a.key;
+    if (a.bits.empty() && b.bits.empty()) {
+      std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                            std::back_inserter(r.array));
+    }
+    else if (a.bits.empty() || b.bits.empty()) {
+      auto const& arr = a.bits.empty() ? a : b;
+      auto const& bit = a.bits.empty() ? b : a;
+      for (auto low : arr.array)
+        if (bit.bits[low >> 6] & ((uint64_t)1 << (low & 63))) r.array.push_back(low);
+    }
+    else {
+      r.bits.resize(1024);
+      uint32_t n = 0;
+      for (size_t w = 0; w < 1024; ++w) {
+        r.bits[w] = a.bits[w] & b.bits[w];
+        n += __builtin_popcountll(r.bits[w]);
+      }
+      r.cardinality = n;
+      Optimize(r);
+      return r;
+    }
+    r.cardinality = r.array.size();
+    return r;
+  }
+
+  EventBitmap::Container_t EventBitmap::Or(const Container_t& a, const Container_t& b)
+  {
+    Container_t r;
+    r.key = a.key;
+    if (a.bits.empty() && b.bits.empty() && a.cardinality + b.cardinality <= kMaxArraySize) {
+      std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                     std::back_inserter(r.array));
+      r.cardinality = r.array.size();
+      return r;
+    }
+    Container_t a_bits = a, b_bits = b;
+    ToBits(a_bits);
+    ToBits(b_bits);
+    r.bits.resize(1024);
+    uint32_t n = 0;
+    for (size_t w = 0; w < 1024; ++w) {
+      r.bits[w] = a_bits.bits[w] | b_bits.bits[w];
+      n += __builtin_popcountll(r.bits[w]);
+    }
+    r.cardinality = n;
+    Optimize(r);
+    return r;
+  }
+
+  EventBitmap::Container_t EventBitmap::AndNot(const Container_t& a, const Container_t& b)
+  {
+    Container_t r;
+    r.key = a.key;
+    if (a.bits.empty()) {
+      if (b.bits.empty())
+        std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                            std::back_inserter(r.array));
+      else
+        for (auto low : a.array)
+          if (!(b.bits[low >> 6] & ((uint64_t)1 << (low & 63)))) r.array.push_back(low);
+      r.cardinality = r.array.size();
+      return r;
+    }
+    r.bits = a.bits;
+    if (b.bits.empty()) {
+      for (auto low : b.array) r.bits[low >> 6] &= ~((uint64_t)1 << (low & 63));
+    }
+    else {
+      for (size_t w = 0; w < 1024; ++w) r.bits[w] &= ~b.bits[w];
+    }
+    uint32_t n = 0;
+    for (auto word : r.bits) n += __builtin_popcountll(word);
+    r.cardinality = n;
+    Optimize(r);
+    return r;
+  }
+
+  EventBitmap EventBitmap::And(const EventBitmap& other) const
+  {
+    EventBitmap result;
+    size_t i = 0, j = 0;
+    while (i < _containers.size() && j < other._containers.size()) {
+      auto const& a = _containers[i];
+      auto const& b = other._containers[j];
+      if (a.key < b.key) ++i;
+      else if (b.key < a.key) ++j;
+      else {
+        auto c = And(a, b);
+        if (c.cardinality) result._containers.push_back(std::move(c));
+        ++i; ++j;
+      }
+    }
+    return result;
+  }
+
+  EventBitmap EventBitmap::Or(const EventBitmap& other) const
+  {
+    EventBitmap result;
+    size_t i = 0, j = 0;
+    while (i < _containers.size() || j < other._containers.size()) {
+      if (j == other._containers.size() || (i < _containers.size() && _containers[i].key < other._containers[j].key))
+        result._containers.push_back(_containers[i++]);
+      else if (i == _containers.size() || other._containers[j].key < _containers[i].key)
+        result._containers.push_back(other._containers[j++]);
+      else
+        result._containers.push_back(Or(_containers[i++], other._containers[j++]));
+    }
+    return result;
+  }
+
+  EventBitmap EventBitmap::AndNot(const EventBitmap& other) const
+  {
+    EventBitmap result;
+    size_t j = 0;
+    for (auto const& a : _containers) {
+      while (j < other._containers.size() && other._containers[j].key < a.key) ++j;
+      if (j == other._containers.size() || other._containers[j].key != a.key) {
+        result._containers.push_back(a);
+        continue;
+      }
+      auto c = AndNot(a, other._containers[j]);
+      if (c.cardinality) result._containers.push_back(std::move(c));
+    }
+    return result;
+  }
+
+  double EventBitmap::WeightedSum(const std::vector<double>& weights) const
+  {
+    double sum = 0.;
+    ForEach([&sum, &weights](uint32_t row) { if (row < weights.size()) sum += weights[row]; });
+    return sum;
+  }
+
+  std::vector<uint32_t> EventBitmap::Rows() const
+  {
+    std::vector<uint32_t> rows;
+    rows.reserve(Cardinality());
+    ForEach([&rows](uint32_t row) { rows.push_back(row); });
+    return rows;
+  }
+
+  size_t EventBitmap::SizeInBytes() const
+  {
+    size_t size = sizeof(*this);
+    for (auto const& c : _containers)
+      size += sizeof(c) + c.array.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+    return size;
+  }
+
+}
+
+#endif
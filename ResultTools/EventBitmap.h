@@ -0,0 +1,117 @@
+/**
+ * \file EventBitmap.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class EventBitmap
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_EVENTBITMAP_H
+#define LEE_EVENTBITMAP_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace lee {
+
+  /**
+     \class EventBitmap
+     Compressed set of row indices (roaring bitmap layout): rows are grouped by their high
+     16 bits into containers, and each container is either a sorted array of the low 16 bits
+     (up to 4096 rows) or a 65536-bit bitset. Sets of rows passing a cut are then stored in
+     about 2 bytes per row when sparse and 1 bit per row when dense, and intersections /
+     unions / differences and counts work container by container.
+   */
+  class EventBitmap {
+
+  public:
+
+    /// Default constructor (empty set)
+    EventBitmap() {}
+
+    /// Default destructor
+    ~EventBitmap() {}
+
+    /// Rows [0, n)
+    static EventBitmap Range(uint32_t n);
+
+    /// Add a row (fastest when rows are added in increasing order)
+    void Add(uint32_t row);
+
+    bool Contains(uint32_t row) const;
+
+    /// Number of rows in the set
+    uint64_t Cardinality() const;
+
+    bool Empty() const { return _containers.empty(); }
+
+    /// Set operations
+    EventBitmap And(const EventBitmap& other) const;
+    EventBitmap Or(const EventBitmap& other) const;
+    EventBitmap AndNot(const EventBitmap& other) const;
+
+    /// Sum of weights[row] over the rows in the set
+    double WeightedSum(const std::vector<double>& weights) const;
+
+    /// Rows in the set, increasing
+    std::vector<uint32_t> Rows() const;
+
+    /// Memory used by the containers
+    size_t SizeInBytes() const;
+
+    /// Call func(row) for every row in the set, increasing
+    template <class Func>
+    void ForEach(Func func) const
+    {
+      for (auto const& c : _containers) {
+        uint32_t high = (uint32_t)c.key << 16;
+        if (c.bits.empty()) {
+          for (auto low : c.array) func(high | low);
+        }
+        else {
+          for (size_t w = 0; w < c.bits.size(); ++w) {
+            uint64_t word = c.bits[w];
+            while (word) {
+              func(high | (uint32_t)(w * 64 + __builtin_ctzll(word)));
+              word &= word - 1;
+            }
+          }
+        }
+      }
+    }
+
+  private:
+
+    /// Rows sharing the same high 16 bits
+    struct Container_t {
+      uint16_t key;
+      uint32_t cardinality;
+      std::vector<uint16_t> array; ///< sorted low bits (if bits is empty)
+      std::vector<uint64_t> bits;  ///< 1024 words bitset (if not empty)
+    };
+
+    /// Array containers above this size become bitsets
+    static const uint32_t kMaxArraySize = 4096;
+
+    /// Convert to the cheaper representation for its cardinality
+    static void Optimize(Container_t& c);
+    static void ToBits(Container_t& c);
+
+    static Container_t And(const Container_t& a, const Container_t& b);
+    static Container_t Or(const Container_t& a, const Container_t& b);
+    static Container_t AndNot(const Container_t& a, const Container_t& b);
+
+    std::vector<Container_t> _containers; //! sorted by key, never empty containers
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,282 @@
+#ifndef LEE_HISTCUBE_CXX
+#define LEE_HISTCUBE_CXX
+
+#include "HistCube.h"
+#include "TreeCutEvaluator.h"
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+
+ClassImp(lee::HistCube)
+
+namespace lee {
+
+  const size_t HistCube::kMaxDenseCells;
+
+  namespace {
+    /// Bin index with underflow (0) and overflow (n+1)
+    int FindBin(const std::vector<double>& edges, double x)
+    { return std::upper_bound(edges.begin(), edges.end(), x) - edges.begin(); }
+
+    /// Index of the edge nearest to x
+    size_t NearestEdge(const std::vector<double>& edges, double x)
+    {
+      size_t best = 0;
+      for (size_t k = 1; k < edges.size(); ++k)
+        if (std::fabs(edges[k] - x) < std::fabs(edges[best] - x)) best = k;
+      return best;
+    }
+  }
+
+  HistCube::HistCube(const char* name, const char* title)
+    : TNamed(name, title), _prefix_built(false)
+  {}
+
+  void HistCube::AddAxis(const std::string& expr, const std::vector<double>& edges)
+  {
+    _axis_exprs.push_back(expr);
+    _axis_edges.push_back(edges);
+    ResetRanges();
+    _prefix_built = false;
+  }
+
+  void HistCube::SetPlotAxis(const std::string& expr, const std::vector<double>& edges)
+  {
+    _plot_expr = expr;
+    _plot_edges = edges;
+    _prefix_built = false;
+  }
+
+  size_t HistCube::DenseSize() const
+  {
+    size_t size = _plot_edges.size() > 1 ? _plot_edges.size() - 1 : 0;
+    for (auto const& edges : _axis_edges) size *= edges.size() + 1;
+    return size;
+  }
+
+  bool HistCube::Fill(TreeCutEvaluator& evaluator, const std::string& weight, const std::string& cut, double scale)
+  {
+    if (_plot_edges.size() < 2) {
+      std::cout << "ERROR!! HistCube " << GetName() << " has no plot axis!" << std::endl;
+      return false;
+    }
+    size_t naxes = _axis_exprs.size();
+    size_t nplot = _plot_edges.size() - 1;
+
+    std::vector<std::string> exprs(_axis_exprs);
+    exprs.push_back(_plot_expr);
+    exprs.push_back(cut);
+    exprs.push_back(weight);
+
+    std::unordered_map<Long64_t, std::pair<double, double> > filled;
+    bool ok = evaluator.Scan(exprs, [&](size_t, size_t n, const std::vector<const double*>& v) {
+        for (size_t k = 0; k < n; ++k) {
+          if (v[naxes + 1][k] == 0.) continue;
+          double x = v[naxes][k];
+          if (!(x >= _plot_edges.front() && x <= _plot_edges.back())) continue;
+          Long64_t cell = 0;
+          for (size_t a = 0; a < naxes; ++a)
+            cell = cell * (_axis_edges[a].size() + 1) + FindBin(_axis_edges[a], v[a][k]);
+          cell = cell * nplot + std::min((size_t)(FindBin(_plot_edges, x) - 1), nplot - 1);
+          double w = v[naxes + 2][k] * scale;
+          auto& sums = filled[cell];
+          sums.first += w;
+          sums.second += w * w;
+        }
+      });
+    if (!ok) return false;
+
+    std::vector<Long64_t> cells;
+    for (auto const& c : filled) cells.push_back(c.first);
+    std::sort(cells.begin(), cells.end());
+    std::vector<double> sumw, sumw2;
+    for (auto const& c : cells) {
+      sumw.push_back(filled[c].first);
+      sumw2.push_back(filled[c].second);
+    }
+    AddCells(cells, sumw, sumw2);
+    return true;
+  }
+
+  void HistCube::AddCells(const std::vector<Long64_t>& cells, const std::vector<double>& sumw, const std::vector<double>& sumw2)
+  {
+    std::vector<Long64_t> merged_cells;
+    std::vector<double> merged_sumw, merged_sumw2;
+    size_t i = 0, j = 0;
+    while (i < _cells.size() || j < cells.size()) {
+      if (j == cells.size() || (i < _cells.size() && _cells[i] < cells[j])) {
+        merged_cells.push_back(_cells[i]); merged_sumw.push_back(_sumw[i]); merged_sumw2.push_back(_sumw2[i]);
+        ++i;
+      }
+      else if (i == _cells.size() || cells[j] < _cells[i]) {
+        merged_cells.push_back(cells[j]); merged_sumw.push_back(sumw[j]); merged_sumw2.push_back(sumw2[j]);
+        ++j;
+      }
+      else {
+        merged_cells.push_back(cells[j]);
+        merged_sumw.push_back(_sumw[i] + sumw[j]);
+        merged_sumw2.push_back(_sumw2[i] + sumw2[j]);
+        ++i; ++j;
+      }
+    }
+    _cells.swap(merged_cells);
+    _sumw.swap(merged_sumw);
+    _sumw2.swap(merged_sumw2);
+    _prefix_built = false;
+  }
+
+  void HistCube::SetRange(const std::string& expr, double lo, double hi)
+  {
+    size_t a = std::find(_axis_exprs.begin(), _axis_exprs.end(), expr) - _axis_exprs.begin();
+    if (a == _axis_exprs.size()) {
+      std::cout << "ERROR!! HistCube " << GetName() << " has no axis " << expr << std::endl;
+      return;
+    }
+    if (_range_lo.size() != _axis_exprs.size()) ResetRanges();
+
+    auto const& edges = _axis_edges[a];
+    auto snap = [&edges, &expr](double x) {
+      size_t k = NearestEdge(edges, x);
+      if (std::fabs(edges[k] - x) > 1.e-9 * std::max(1., std::fabs(x)))
+        std::cout << "HistCube: " << expr << " cut at " << x << " is done at the bin edge " << edges[k] << std::endl;
+      return (int)k;
+    };
+    _range_lo[a] = (std::isinf(lo) && lo < 0) ? 0 : snap(lo) + 1;
+    _range_hi[a] = (std::isinf(hi) && hi > 0) ? (int)edges.size() : snap(hi);
+  }
+
+  void HistCube::ResetRanges()
+  {
+    _range_lo.assign(_axis_exprs.size(), 0);
+    _range_hi.clear();
+    for (auto const& edges : _axis_edges) _range_hi.push_back(edges.size());
+  }
+
+  void HistCube::BuildPrefixSums() const
+  {
+    _prefix_built = true;
+    _prefix_sumw.clear();
+    _prefix_sumw2.clear();
+    size_t size = DenseSize();
+    if (!size || size > kMaxDenseCells) return;
+
+    _prefix_sumw.assign(size, 0.);
+    _prefix_sumw2.assign(size, 0.);
+    for (size_t i = 0; i < _cells.size(); ++i) {
+      _prefix_sumw[_cells[i]] = _sumw[i];
+      _prefix_sumw2[_cells[i]] = _sumw2[i];
+    }
+
+    // cumulative sums along each cut axis in turn
+    size_t stride = _plot_edges.size() - 1;
+    for (size_t a = _axis_edges.size(); a-- > 0;) {
+      size_t nbins = _axis_edges[a].size() + 1;
+      for (size_t i = 0; i < size; ++i) {
+        if ((i / stride) % nbins == 0) continue;
+        _prefix_sumw[i] += _prefix_sumw[i - stride];
+        _prefix_sumw2[i] += _prefix_sumw2[i - stride];
+      }
+      stride *= nbins;
+    }
+  }
+
+  std::vector<double> HistCube::Query(bool sumw2) const
+  {
+    size_t naxes = _axis_exprs.size();
+    size_t nplot = _plot_edges.size() > 1 ? _plot_edges.size() - 1 : 0;
+    std::vector<double> result(nplot, 0.);
+    if (!nplot) return result;
+
+    std::vector<int> lo(naxes), hi(naxes);
+    for (size_t a = 0; a < naxes; ++a) {
+      bool has_range = _range_lo.size() == naxes;
+      lo[a] = has_range ? _range_lo[a] : 0;
+      hi[a] = has_range ? _range_hi[a] : (int)_axis_edges[a].size();
+      if (lo[a] > hi[a]) return result;
+    }
+
+    if (!_prefix_built) BuildPrefixSums();
+
+    // sparse cube: scan the filled cells
+    if (_prefix_sumw.empty()) {
+      auto const& values = sumw2 ? _sumw2 : _sumw;
+      for (size_t i = 0; i < _cells.size(); ++i) {
+        Long64_t cell = _cells[i];
+        size_t bin = cell % nplot;
+        cell /= nplot;
+        bool in_range = true;
+        for (size_t a = naxes; a-- > 0 && in_range;) {
+          int c = cell % (_axis_edges[a].size() + 1);
+          cell /= (_axis_edges[a].size() + 1);
+          in_range = (c >= lo[a] && c <= hi[a]);
+        }
+        if (in_range) result[bin] += values[i];
+      }
+      return result;
+    }
+
+    // prefix sums: inclusion-exclusion over the 2^naxes corners of the range box
+    auto const& prefix = sumw2 ? _prefix_sumw2 : _prefix_sumw;
+    for (size_t corner = 0; corner < ((size_t)1 << naxes); ++corner) {
+      size_t index = 0;
+      double sign = 1.;
+      bool valid = true;
+      for (size_t a = 0; a < naxes; ++a) {
+        int c = hi[a];
+        if (corner & ((size_t)1 << a)) {
+          c = lo[a] - 1;
+          sign = -sign;
+        }
+        if (c < 0) { valid = false; break; }
+        index = index * (_axis_edges[a].size() + 1) + c;
+      }
+      if (!valid) continue;
+      index *= nplot;
+      for (size_t b = 0; b < nplot; ++b) result[b] += sign * prefix[index + b];
+    }
+    return result;
+  }
+
+  std::vector<double> HistCube::Project() const { return Query(false); }
+
+  std::vector<double> HistCube::ProjectSumW2() const { return Query(true); }
+
+  double HistCube::Yield() const
+  {
+    double sum = 0.;
+    for (auto const& c : Project()) sum += c;
+    return sum;
+  }
+
+  Long64_t HistCube::Merge(TCollection* list)
+  {
+    if (!list) return 0;
+    TIter next(list);
+    while (TObject* obj = next()) {
+      auto other = dynamic_cast<HistCube*>(obj);
+      if (!other) continue;
+      if (other->_axis_exprs != _axis_exprs || other->_axis_edges != _axis_edges ||
+          other->_plot_expr != _plot_expr || other->_plot_edges != _plot_edges) {
+        std::cout << "ERROR!! HistCube::Merge: " << other->GetName() << " has different axes than "
+                  << GetName() << ", not merged" << std::endl;
+        continue;
+      }
+      AddCells(other->_cells, other->_sumw, other->_sumw2);
+    }
+    return (Long64_t)_cells.size();
+  }
+
+  void HistCube::Print(Option_t*) const
+  {
+    std::cout << "HistCube " << GetName() << ": " << _plot_expr << " (" << (_plot_edges.size() > 1 ? _plot_edges.size() - 1 : 0)
+              << " bins) vs";
+    for (size_t a = 0; a < _axis_exprs.size(); ++a)
+      std::cout << " " << _axis_exprs[a] << " (" << _axis_edges[a].size() - 1 << " bins)";
+    std::cout << std::endl << "  " << _cells.size() << " filled cells of " << DenseSize()
+              << ", yield in the current ranges " << Yield() << std::endl;
+  }
+
+}
+
+#endif
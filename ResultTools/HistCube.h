@@ -0,0 +1,122 @@
+/**
+ * \file HistCube.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class HistCube
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_HISTCUBE_H
+#define LEE_HISTCUBE_H
+
+#include <string>
+#include <vector>
+#include "TNamed.h"
+#include "TCollection.h"
+
+namespace lee {
+
+  class TreeCutEvaluator;
+
+  /**
+     \class HistCube
+     Sparse weighted histogram over several cut variables (the cut axes, each with underflow
+     and overflow bins) and one plot variable, filled in one pass over a result tree.
+     It is saved in a ROOT file, so cut tuning doesn't need to re-read the samples:
+     SetRange("_e_Edep", 60., inf) etc. and Project() give the plot variable histogram for
+     any cuts on bin edges of the cut axes (cut values are snapped to the nearest edge).
+
+     Projections use prefix sums over the cut axes (built once, on the first query), so a
+     query costs 2^(number of cut axes) lookups per plot bin. If that dense table would be
+     too large (DenseSize() > kMaxDenseCells), the filled cells are scanned instead.
+     Only the non-empty cells are stored; cubes with the same axes can be merged (hadd, ResultMerger).
+   */
+  class HistCube : public TNamed {
+
+  public:
+
+    /// Largest dense cube (cells) for which prefix sums are built
+    static const size_t kMaxDenseCells = 1 << 22;
+
+    /// Default constructor
+    HistCube(const char* name = "hist_cube", const char* title = "");
+
+    /// Default destructor
+    virtual ~HistCube() {}
+
+    /// Add a cut axis: an expression of the tree columns and its bin edges
+    void AddAxis(const std::string& expr, const std::vector<double>& edges);
+
+    /// Set the plot axis (values outside of the edges are not stored)
+    void SetPlotAxis(const std::string& expr, const std::vector<double>& edges);
+
+    /// Fill from the entries of the evaluator's tree passing cut, weighted by weight * scale
+    bool Fill(TreeCutEvaluator& evaluator, const std::string& weight = "", const std::string& cut = "", double scale = 1.);
+
+    /// Restrict a cut axis to [lo, hi) (+-inf for no limit), snapped to the nearest bin edges
+    void SetRange(const std::string& expr, double lo, double hi);
+
+    /// Remove all the ranges
+    void ResetRanges();
+
+    /// Plot axis histogram within the current ranges
+    std::vector<double> Project() const;
+
+    /// Plot axis sum of weight^2 within the current ranges
+    std::vector<double> ProjectSumW2() const;
+
+    /// Sum of Project()
+    double Yield() const;
+
+    /// Number of cells of the full (dense) cube, cut axes with under/overflow times plot bins
+    size_t DenseSize() const;
+
+    size_t NAxes() const { return _axis_exprs.size(); }
+    size_t NFilledCells() const { return _cells.size(); }
+    const std::vector<double>& PlotEdges() const { return _plot_edges; }
+
+    /// Called by ROOT (hadd, TClass::GetMerge): add the cells of cubes with the same axes
+    Long64_t Merge(TCollection* list);
+
+    void Print(Option_t* option = "") const;
+
+  private:
+
+    /// Add (cell, sumw, sumw2) entries, sorted by cell, into the stored cells
+    void AddCells(const std::vector<Long64_t>& cells, const std::vector<double>& sumw, const std::vector<double>& sumw2);
+
+    /// Build the prefix sums (if the dense cube isn't too large)
+    void BuildPrefixSums() const;
+
+    std::vector<double> Query(bool sumw2) const;
+
+    std::vector<std::string> _axis_exprs;
+    std::vector<std::vector<double> > _axis_edges;
+    std::string _plot_expr;
+    std::vector<double> _plot_edges;
+
+    /// Filled cells, sorted: index = (((axis0 bin)*(n1+2) + axis1 bin)*... )*n_plot + plot bin
+    std::vector<Long64_t> _cells;
+    std::vector<double> _sumw;
+    std::vector<double> _sumw2;
+
+    /// Current ranges, as inclusive bin index ranges per cut axis
+    std::vector<int> _range_lo; //!
+    std::vector<int> _range_hi; //!
+
+    mutable std::vector<double> _prefix_sumw;  //!
+    mutable std::vector<double> _prefix_sumw2; //!
+    mutable bool _prefix_built;                //!
+
+    ClassDef(HistCube, 1)
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,62 @@
+#ifndef LEE_INPUTLEDGER_CXX
+#define LEE_INPUTLEDGER_CXX
+
+#include "InputLedger.h"
+#include "TMD5.h"
+#include <iostream>
+#include <memory>
+
+ClassImp(lee::InputLedger)
+
+namespace lee {
+
+  void InputLedger::Add(const std::string& path, const std::string& checksum)
+  {
+    if (Contains(path, checksum)) return;
+    _paths.push_back(path);
+    _checksums.push_back(checksum);
+  }
+
+  bool InputLedger::Contains(const std::string& path, const std::string& checksum) const
+  {
+    for (size_t i = 0; i < _paths.size(); ++i)
+      if (_paths[i] == path && _checksums[i] == checksum) return true;
+    return false;
+  }
+
+  bool InputLedger::ContainsPath(const std::string& path) const
+  {
+    for (auto const& p : _paths)
+      if (p == path) return true;
+    return false;
+  }
+
+  std::string InputLedger::Checksum(const std::string& path)
+  {
+    std::unique_ptr<TMD5> md5(TMD5::FileChecksum(path.c_str()));
+    return md5 ? std::string(md5->AsString()) : std::string();
+  }
+
+  Long64_t InputLedger::Merge(TCollection* list)
+  {
+    if (!list) return 0;
+    TIter next(list);
+    while (TObject* obj = next()) {
+      auto other = dynamic_cast<InputLedger*>(obj);
+      if (!other) continue;
+      for (size_t i = 0; i < other->_paths.size(); ++i)
+        Add(other->_paths[i], other->_checksums[i]);
+    }
+    return 1;
+  }
+
+  void InputLedger::Print(Option_t*) const
+  {
+    std::cout << GetName() << ": " << _paths.size() << " input files" << std::endl;
+    for (size_t i = 0; i < _paths.size(); ++i)
+      std::cout << "  " << _checksums[i] << "  " << _paths[i] << std::endl;
+  }
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * \file InputLedger.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class InputLedger
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_INPUTLEDGER_H
+#define LEE_INPUTLEDGER_H
+
+#include <string>
+#include <vector>
+#include "TNamed.h"
+#include "TCollection.h"
+
+namespace lee {
+
+  /**
+     \class InputLedger
+     List of the input files (path + MD5 checksum) that already contributed to a merged
+     result file. It is stored in the result file itself ("input_ledger"), and merging two
+     ledgers gives the union, so incremental updates (bin/singleE_runner -u) can tell which
+     input files are new and only process those.
+   */
+  class InputLedger : public TNamed {
+
+  public:
+
+    /// Default constructor
+    InputLedger(const char* name = "input_ledger", const char* title = "input files of this result")
+      : TNamed(name, title) {}
+
+    /// Default destructor
+    virtual ~InputLedger() {}
+
+    /// Record a file with its checksum (no-op if it is already there)
+    void Add(const std::string& path, const std::string& checksum);
+
+    /// Whether this exact file (path and checksum) is already in the ledger
+    bool Contains(const std::string& path, const std::string& checksum) const;
+
+    /// Whether the path is in the ledger (with any checksum)
+    bool ContainsPath(const std::string& path) const;
+
+    size_t Size() const { return _paths.size(); }
+
+    /// MD5 checksum of a file (empty string if it can't be read)
+    static std::string Checksum(const std::string& path);
+
+    /// Called by ROOT (hadd, TClass::GetMerge): union with the other ledgers
+    Long64_t Merge(TCollection* list);
+
+    void Print(Option_t* option = "") const;
+
+  private:
+
+    std::vector<std::string> _paths;
+    std::vector<std::string> _checksums;
+
+    ClassDef(InputLedger, 1)
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,358 @@
+#ifndef LEE_LIKELIHOODFITTER_CXX
+#define LEE_LIKELIHOODFITTER_CXX
+
+#include "LikelihoodFitter.h"
+#include "TMath.h"
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <sstream>
+
+namespace lee {
+
+  void LikelihoodFitter::SetBackground(const std::vector<double>& background)
+  {
+    _background = background;
+    UpdateSigma();
+  }
+
+  bool LikelihoodFitter::SetFromStack(const StackBuilder& stack, const std::string& signal_sample, int replica)
+  {
+    auto samples = stack.Samples();
+    if (std::find(samples.begin(), samples.end(), signal_sample) == samples.end()) {
+      std::cout << "ERROR!! LikelihoodFitter: no sample " << signal_sample << " in the stack!" << std::endl;
+      return false;
+    }
+    size_t nreplicas = stack.Replicas(signal_sample).size();
+    if (replica >= (int)nreplicas) {
+      std::cout << "ERROR!! LikelihoodFitter: no bootstrap replica " << replica << " in the stack ("
+                << nreplicas << " replicas)" << std::endl;
+      return false;
+    }
+    auto histogram = [&stack, replica](const std::string& sample) -> const std::vector<double>& {
+      return replica < 0 ? stack.Histogram(sample) : stack.Replicas(sample)[replica];
+    };
+    std::vector<double> background, sumw2;
+    for (auto const& sample : samples) {
+      if (sample == signal_sample) {
+        _signal = histogram(sample);
+        continue;
+      }
+      auto const& hist = histogram(sample);
+      auto const& w2 = stack.SumW2(sample);
+      background.resize(hist.size(), 0.);
+      sumw2.resize(hist.size(), 0.);
+      for (size_t i = 0; i < hist.size(); ++i) {
+        background[i] += hist[i];
+        sumw2[i] += w2[i];
+      }
+    }
+    _background = background;
+    _sumw2 = sumw2;
+    UpdateSigma();
+    return true;
+  }
+
+  void LikelihoodFitter::AddBackgroundUniverse(const std::vector<double>& background)
+  {
+    if (background.size() != _background.size()) {
+      std::cout << "ERROR!! LikelihoodFitter: universe with " << background.size() << " bins, the background has "
+                << _background.size() << " (SetBackground first)" << std::endl;
+      return;
+    }
+    _universes.push_back(background);
+    UpdateSigma();
+  }
+
+  void LikelihoodFitter::SetBackgroundSumW2(const std::vector<double>& sumw2)
+  {
+    _sumw2 = sumw2;
+    UpdateSigma();
+  }
+
+  void LikelihoodFitter::ClearUniverses()
+  {
+    _universes.clear();
+    UpdateSigma();
+  }
+
+  void LikelihoodFitter::UpdateSigma()
+  {
+    _sigma.assign(_background.size(), 0.);
+    for (size_t i = 0; i < _background.size(); ++i) {
+      double b = _background[i];
+      if (b <= 0.) continue;
+      double var = 0.;
+      for (auto const& u : _universes) var += (u[i] - b) * (u[i] - b);
+      if (!_universes.empty()) var /= _universes.size();
+      if (i < _sumw2.size()) var += _sumw2[i];
+      _sigma[i] = std::sqrt(var) / b;
+    }
+  }
+
+  void LikelihoodFitter::SetData(const std::vector<double>& data)
+  {
+    _data = data;
+    _has_data = true;
+  }
+
+  void LikelihoodFitter::SetAsimovData(double mu)
+  {
+    SetData(Asimov(mu));
+  }
+
+  std::vector<double> LikelihoodFitter::Asimov(double mu) const
+  {
+    std::vector<double> data(_background);
+    for (size_t i = 0; i < data.size() && i < _signal.size(); ++i) data[i] += mu * _signal[i];
+    return data;
+  }
+
+  std::vector<double> LikelihoodFitter::Observed() const
+  {
+    return _has_data ? _data : Asimov(1.);
+  }
+
+  double LikelihoodFitter::NLL(double mu, const std::vector<double>& theta, std::vector<double>* grad) const
+  {
+    auto const data = Observed();
+    size_t nbins = _signal.size();
+    if (grad) grad->assign(nbins + 1, 0.);
+    double nll = 0.;
+    for (size_t i = 0; i < nbins; ++i) {
+      double s = _signal[i], b = _background[i], n = data[i], sigma = _sigma[i];
+      double t = sigma > 0. ? theta[i] : 0.;
+      double lambda = mu * s + b * (1. + t);
+      if (lambda < 0. || (lambda == 0. && n > 0.)) return std::numeric_limits<double>::infinity();
+      nll += lambda - n + (n > 0. ? n * std::log(n / lambda) : 0.);
+      if (sigma > 0.) nll += t * t / (2. * sigma * sigma);
+      if (!grad) continue;
+      double r = 1. - (n > 0. ? n / lambda : 0.);
+      (*grad)[0] += s * r;
+      if (sigma > 0.) (*grad)[i + 1] = b * r + t / (sigma * sigma);
+    }
+    return nll;
+  }
+
+  double LikelihoodFitter::ProfileNLL(double mu, double* dnll, double* d2nll, std::vector<double>* theta) const
+  {
+    return ProfileNLL(Observed(), mu, dnll, d2nll, theta);
+  }
+
+  double LikelihoodFitter::ProfileNLL(const std::vector<double>& data, double mu, double* dnll, double* d2nll,
+                                      std::vector<double>* theta) const
+  {
+    size_t nbins = _signal.size();
+    if (theta) theta->assign(nbins, 0.);
+    double nll = 0., g = 0., h = 0.;
+    for (size_t i = 0; i < nbins; ++i) {
+      double s = _signal[i], b = _background[i], n = data[i], sigma = _sigma[i];
+      double c = mu * s + b;
+      double t = 0.;
+      if (b > 0. && sigma > 0.) {
+        // dNLL/dtheta = 0, times the expectation: A t^2 + B t + C = 0,
+        // the largest root is the one with a positive expectation
+        double inv_var = 1. / (sigma * sigma);
+        double A = b * inv_var, B = b * b + c * inv_var, C = b * (c - n);
+        double D = std::sqrt(std::max(B * B - 4. * A * C, 0.));
+        if (B >= 0.) t = B + D > 0. ? -2. * C / (B + D) : 0.;
+        else t = (D - B) / (2. * A);
+      }
+      double lambda = c + b * t;
+      if (b > 0. && sigma > 0.) lambda = std::max(lambda, 0.);
+      if (lambda < 0. || (lambda == 0. && n > 0.)) return std::numeric_limits<double>::infinity();
+      if (theta) (*theta)[i] = t;
+
+      nll += lambda - n + (n > 0. ? n * std::log(n / lambda) : 0.);
+      if (sigma > 0.) nll += t * t / (2. * sigma * sigma);
+
+      // the derivative of the profile is the partial derivative at the profiled theta
+      g += s * (1. - (n > 0. ? n / lambda : 0.));
+      // d2/dmu2 - (d2/dmu dtheta)^2 / (d2/dtheta2)
+      if (n > 0.) {
+        double w = n / (lambda * lambda);
+        double h_mm = w * s * s;
+        if (b > 0. && sigma > 0.) {
+          double h_mt = w * s * b, h_tt = w * b * b + 1. / (sigma * sigma);
+          h_mm -= h_mt * h_mt / h_tt;
+        }
+        h += h_mm;
+      }
+    }
+    if (dnll) *dnll = g;
+    if (d2nll) *d2nll = h;
+    return nll;
+  }
+
+  double LikelihoodFitter::FindRoot(const std::function<double(double, double*)>& f, double x0, double lo, double hi,
+                                    size_t* iterations) const
+  {
+    double df = 0.;
+    if (iterations) *iterations = 0;
+    if (f(lo, &df) >= 0.) return lo;
+    if (f(hi, &df) <= 0.) return hi;
+
+    // newton steps, falling back to bisection when a step leaves the bracket
+    double x = (x0 > lo && x0 < hi) ? x0 : 0.5 * (lo + hi);
+    for (size_t it = 1; it <= 200; ++it) {
+      if (iterations) *iterations = it;
+      double fx = f(x, &df);
+      if (fx == 0.) return x;
+      if (fx < 0.) lo = x;
+      else hi = x;
+      double next = (std::isfinite(fx) && df > 0.) ? x - fx / df : lo;
+      bool newton = next > lo && next < hi;
+      if (!newton) next = 0.5 * (lo + hi);
+      // when bisecting, hi is on the valid side (f(hi) is finite, IE the expectations are positive)
+      if (std::fabs(next - x) < _tolerance * (1. + std::fabs(x))) return newton ? next : hi;
+      x = next;
+    }
+    return x;
+  }
+
+  LikelihoodFitter::Result_t LikelihoodFitter::Fit() const
+  {
+    return Fit(Observed());
+  }
+
+  LikelihoodFitter::Result_t LikelihoodFitter::Fit(const std::vector<double>& data) const
+  {
+    Result_t result = { 0., 0., std::numeric_limits<double>::infinity(), 0, false };
+    if (_signal.empty() || _background.size() != _signal.size() || data.size() != _signal.size()) {
+      std::cout << "ERROR!! LikelihoodFitter: signal, background and data must have the same (non zero) number of bins"
+                << std::endl;
+      return result;
+    }
+
+    // dNLL/dmu is increasing; where the expectation is negative (too low mu) it counts as -inf
+    auto gradient = [this, &data](double mu, double* d2nll) {
+      double g = 0.;
+      double nll = ProfileNLL(data, mu, &g, d2nll, nullptr);
+      return std::isfinite(nll) ? g : -std::numeric_limits<double>::infinity();
+    };
+    result.mu = FindRoot(gradient, 1., _mu_min, _mu_max, &result.iterations);
+
+    double h = 0.;
+    result.nll = ProfileNLL(data, result.mu, nullptr, &h, nullptr);
+    result.mu_err = h > 0. ? 1. / std::sqrt(h) : 0.;
+    result.ok = std::isfinite(result.nll);
+    return result;
+  }
+
+  std::vector<double> LikelihoodFitter::Scan(const std::vector<double>& mus) const
+  {
+    auto const data = Observed();
+    auto best = Fit(data);
+    std::vector<double> q;
+    q.reserve(mus.size());
+    for (auto mu : mus) q.push_back(2. * (ProfileNLL(data, mu, nullptr, nullptr, nullptr) - best.nll));
+    return q;
+  }
+
+  double LikelihoodFitter::AsimovSignificance(double mu) const
+  {
+    auto const data = Asimov(mu);
+    auto best = Fit(data);
+    if (!best.ok || best.mu <= 0.) return 0.;
+    double q0 = 2. * (ProfileNLL(data, 0., nullptr, nullptr, nullptr) - best.nll);
+    return q0 > 0. ? std::sqrt(q0) : 0.;
+  }
+
+  double LikelihoodFitter::AsimovUpperLimit(double cl) const
+  {
+    auto const data = Asimov(0.);
+    auto best = Fit(data);
+    if (!best.ok) return 0.;
+    double q_crit = std::pow(TMath::NormQuantile(cl), 2);
+
+    // q(mu) - q_crit is increasing above the best fit, start from its parabolic approximation
+    auto excess = [this, &data, &best, q_crit](double mu, double* dq) {
+      double g = 0.;
+      double nll = ProfileNLL(data, mu, &g, nullptr, nullptr);
+      *dq = 2. * g;
+      return std::isfinite(nll) ? 2. * (nll - best.nll) - q_crit : std::numeric_limits<double>::infinity();
+    };
+    double x0 = best.mu + std::sqrt(q_crit) * best.mu_err;
+    return FindRoot(excess, x0, best.mu, _mu_max);
+  }
+
+  LikelihoodFitter::Sensitivity_t LikelihoodFitter::Run() const
+  {
+    Sensitivity_t result;
+    result.fit = Fit();
+    result.significance = AsimovSignificance(1.);
+    result.upper_limit = AsimovUpperLimit(0.95);
+    return result;
+  }
+
+  std::vector<LikelihoodFitter::Sensitivity_t> LikelihoodFitter::RunAll(const std::vector<LikelihoodFitter>& configs,
+                                                                        size_t nthreads)
+  {
+    std::vector<Sensitivity_t> results(configs.size());
+    nthreads = std::max<size_t>(1, std::min(nthreads, configs.size()));
+
+    // configurations are handed out one at a time
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < nthreads; ++t)
+      workers.emplace_back([&configs, &results, &next]() {
+          for (size_t i = next++; i < configs.size(); i = next++) results[i] = configs[i].Run();
+        });
+    for (auto& w : workers) w.join();
+    return results;
+  }
+
+  std::vector<LikelihoodFitter::Sensitivity_t> LikelihoodFitter::RunBootstrap(const StackBuilder& stack,
+                                                                             const std::string& signal_sample,
+                                                                             size_t nthreads) const
+  {
+    auto samples = stack.Samples();
+    if (std::find(samples.begin(), samples.end(), signal_sample) == samples.end()) {
+      std::cout << "ERROR!! LikelihoodFitter: no sample " << signal_sample << " in the stack!" << std::endl;
+      return std::vector<Sensitivity_t>();
+    }
+    std::vector<LikelihoodFitter> configs(stack.Replicas(signal_sample).size(), *this);
+    for (size_t r = 0; r < configs.size(); ++r)
+      if (!configs[r].SetFromStack(stack, signal_sample, r)) return std::vector<Sensitivity_t>();
+    return RunAll(configs, nthreads);
+  }
+
+  void LikelihoodFitter::Print(const Sensitivity_t& result) const
+  {
+    std::cout << "LikelihoodFitter: mu = " << result.fit.mu << " +- " << result.fit.mu_err
+              << (_has_data ? "" : " (Asimov)") << " in " << result.fit.iterations << " iterations" << std::endl
+              << "  median significance of mu = 1 : " << result.significance << " sigma" << std::endl
+              << "  median 95% CL upper limit on mu : " << result.upper_limit << std::endl;
+  }
+
+  void LikelihoodFitter::PrintSpread(const std::vector<Sensitivity_t>& results) const
+  {
+    if (results.empty()) return;
+    auto spread = [&results](const std::function<double(const Sensitivity_t&)>& get) {
+      double sum = 0., sum2 = 0.;
+      for (auto const& r : results) {
+        sum += get(r);
+        sum2 += get(r) * get(r);
+      }
+      double mean = sum / results.size();
+      std::ostringstream ss;
+      ss << mean << " +- " << std::sqrt(std::max(sum2 / results.size() - mean * mean, 0.));
+      return ss.str();
+    };
+    size_t failed = 0;
+    for (auto const& r : results) failed += !r.fit.ok;
+    std::cout << "LikelihoodFitter spread of " << results.size() << " results"
+              << (failed ? " (" + std::to_string(failed) + " failed fits)" : "") << ":" << std::endl
+              << "  mu = " << spread([](const Sensitivity_t& r) { return r.fit.mu; }) << std::endl
+              << "  median significance of mu = 1 : " << spread([](const Sensitivity_t& r) { return r.significance; })
+              << " sigma" << std::endl
+              << "  median 95% CL upper limit on mu : " << spread([](const Sensitivity_t& r) { return r.upper_limit; })
+              << std::endl;
+  }
+
+}
+
+#endif
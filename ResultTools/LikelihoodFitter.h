@@ -0,0 +1,171 @@
+/**
+ * \file LikelihoodFitter.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class LikelihoodFitter
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_LIKELIHOODFITTER_H
+#define LEE_LIKELIHOODFITTER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "StackBuilder.h"
+
+namespace lee {
+
+  /**
+     \class LikelihoodFitter
+     Binned Poisson likelihood fit of the LEE signal strength mu, on top of the stacked
+     background histograms (IE from StackBuilder or HistCube projections):
+       expected_i = mu * s_i + b_i * (1 + theta_i)
+     with one nuisance parameter theta_i per bin, constrained by a gaussian of width sigma_i =
+     relative background uncertainty of the bin (RMS of the flux universes around the central
+     background, and the MC statistics, in quadrature).
+     For a given mu each theta_i is profiled in closed form (root of a quadratic), so the
+     profile likelihood and its analytic derivatives in mu cost one pass over the bins, and a
+     fit is a few safeguarded Newton steps (the profile likelihood is convex in mu).
+     NLL is the deviance / 2: sum(expected - n + n log(n / expected)) + sum(theta^2 / 2 sigma^2).
+     Without data (SetData), fits use the Asimov data of mu = 1.
+     RunBootstrap repeats Run on every bootstrap replica of the signal and background
+     (StackBuilder::SetBootstrapReplicas), their spread is the statistical uncertainty of
+     the fit and sensitivity due to the limited selected MC.
+   */
+  class LikelihoodFitter {
+
+  public:
+
+    /// Result of a fit
+    struct Result_t {
+      double mu;      ///< best fit signal strength
+      double mu_err;  ///< 1 / sqrt(d2NLL/dmu2) at the best fit
+      double nll;     ///< profile NLL at the best fit
+      size_t iterations;
+      bool ok;
+    };
+
+    /// Sensitivity of one configuration (see Run)
+    struct Sensitivity_t {
+      Result_t fit;        ///< fit to the data (Asimov mu = 1 without data)
+      double significance; ///< median discovery significance of mu = 1 (Asimov)
+      double upper_limit;  ///< median upper limit on mu without signal (Asimov)
+    };
+
+    /// Default constructor
+    LikelihoodFitter() : _has_data(false), _mu_min(0.), _mu_max(1000.), _tolerance(1.e-8) {}
+
+    /// Default destructor
+    virtual ~LikelihoodFitter() {}
+
+    /// Signal (mu = 1) histogram
+    void SetSignal(const std::vector<double>& signal) { _signal = signal; }
+
+    /// Central total background histogram
+    void SetBackground(const std::vector<double>& background);
+
+    /// Signal = signal_sample, background = sum of the other samples of the last StackBuilder::Build
+    /// (with their MC statistics). replica >= 0 takes this bootstrap replica of every sample instead
+    /// of the central histograms. Returns false if there is no such sample or replica.
+    bool SetFromStack(const StackBuilder& stack, const std::string& signal_sample = "lee", int replica = -1);
+
+    /// Total background histogram of one flux universe
+    void AddBackgroundUniverse(const std::vector<double>& background);
+
+    /// Sum of weight^2 of the background (MC statistics)
+    void SetBackgroundSumW2(const std::vector<double>& sumw2);
+
+    void ClearUniverses();
+
+    /// Observed counts
+    void SetData(const std::vector<double>& data);
+
+    /// Use the Asimov data of signal strength mu (mu * s + b) as the observed counts
+    void SetAsimovData(double mu = 1.);
+
+    void ClearData() { _has_data = false; _data.clear(); }
+
+    /// Range of mu allowed in fits and limits (default [0, 1000])
+    void SetMuRange(double mu_min, double mu_max) { _mu_min = mu_min; _mu_max = mu_max; }
+
+    /// Relative background uncertainty of each bin (gaussian width of the nuisance parameters)
+    const std::vector<double>& Sigma() const { return _sigma; }
+
+    size_t NBins() const { return _signal.size(); }
+
+    /// NLL at (mu, theta), with its analytic gradient (d/dmu, d/dtheta_0, ...) if grad is given
+    double NLL(double mu, const std::vector<double>& theta, std::vector<double>* grad = nullptr) const;
+
+    /// NLL at mu with the nuisance parameters profiled, with dNLL/dmu and d2NLL/dmu2 if given.
+    /// The profiled nuisance parameters are returned in theta if given.
+    double ProfileNLL(double mu, double* dnll = nullptr, double* d2nll = nullptr,
+                      std::vector<double>* theta = nullptr) const;
+
+    /// Best fit signal strength
+    Result_t Fit() const;
+
+    /// Profile likelihood ratio scan: 2 * (ProfileNLL(mu) - ProfileNLL(best fit)) at each mu
+    std::vector<double> Scan(const std::vector<double>& mus) const;
+
+    /// Median discovery significance of signal strength mu: sqrt(q0) on the Asimov data of mu
+    double AsimovSignificance(double mu = 1.) const;
+
+    /// Median upper limit on mu at this CL (one sided) on the Asimov data without signal
+    double AsimovUpperLimit(double cl = 0.95) const;
+
+    /// Fit, significance and upper limit
+    Sensitivity_t Run() const;
+
+    /// Run every configuration (IE one per set of cuts), nthreads at a time
+    static std::vector<Sensitivity_t> RunAll(const std::vector<LikelihoodFitter>& configs, size_t nthreads = 1);
+
+    /// Run with the signal and background of every bootstrap replica of the last stack Build
+    /// (keeping the data, universes and mu range of this fitter), nthreads at a time
+    std::vector<Sensitivity_t> RunBootstrap(const StackBuilder& stack, const std::string& signal_sample = "lee",
+                                            size_t nthreads = 1) const;
+
+    void Print(const Sensitivity_t& result) const;
+
+    /// Print the mean and RMS of the fitted mu, significance and upper limit of several results
+    /// (IE of RunBootstrap)
+    void PrintSpread(const std::vector<Sensitivity_t>& results) const;
+
+  private:
+
+    /// Profile NLL on the given counts
+    double ProfileNLL(const std::vector<double>& data, double mu, double* dnll, double* d2nll,
+                      std::vector<double>* theta) const;
+
+    /// Best fit on the given counts
+    Result_t Fit(const std::vector<double>& data) const;
+
+    /// Root of an increasing function f(x, &df/dx) in [lo, hi] (lo or hi if there is none)
+    double FindRoot(const std::function<double(double, double*)>& f, double x0, double lo, double hi,
+                    size_t* iterations = nullptr) const;
+
+    /// Counts used by Fit/Scan: the data, or the Asimov data of mu = 1
+    std::vector<double> Observed() const;
+
+    std::vector<double> Asimov(double mu) const;
+
+    void UpdateSigma();
+
+    std::vector<double> _signal, _background, _sumw2, _data;
+    std::vector<std::vector<double> > _universes;
+    std::vector<double> _sigma;
+    bool _has_data;
+    double _mu_min, _mu_max;
+    double _tolerance;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
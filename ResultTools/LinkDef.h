@@ -0,0 +1,31 @@
+//
+// cint script to generate libraries
+// Declaire namespace & classes you defined
+// #pragma statement: order matters! Google it ;)
+//
+
+#ifdef __CINT__
+#pragma link off all globals;
+#pragma link off all classes;
+#pragma link off all functions;
+
+#pragma link C++ class lee::ResultMerger+;
+#pragma link C++ class lee::InputLedger+;
+#pragma link C++ class lee::CutExpression+;
+#pragma link C++ class lee::TreeCutEvaluator+;
+#pragma link C++ class lee::StackBuilder+;
+#pragma link C++ class lee::HistCube+;
+#pragma link C++ class lee::CutScanner+;
+#pragma link C++ class lee::EventBitmap+;
+#pragma link C++ class lee::CutBitmapStore+;
+#pragma link C++ class lee::LikelihoodFitter+;
+#pragma link C++ class lee::LikelihoodFitter::Result_t+;
+#pragma link C++ class lee::LikelihoodFitter::Sensitivity_t+;
+#pragma link C++ class std::vector<lee::LikelihoodFitter>+;
+#pragma link C++ class std::vector<lee::LikelihoodFitter::Sensitivity_t>+;
+#pragma link C++ class lee::LogisticTrainer+;
+#pragma link C++ class lee::DiscriminantScorer+;
+#pragma link C++ class lee::ColumnReader+;
+//ADD_NEW_CLASS ... do not change this line
+#endif
+
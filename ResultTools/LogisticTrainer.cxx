@@ -0,0 +1,264 @@
+#ifndef LEE_LOGISTICTRAINER_CXX
+#define LEE_LOGISTICTRAINER_CXX
+
+#include "LogisticTrainer.h"
+#include "TreeCutEvaluator.h"
+#include "TFile.h"
+#include <iostream>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+namespace lee {
+
+  void LogisticTrainer::AddFeature(const std::string& expr)
+  {
+    if (!_y.empty()) {
+      std::cout << "ERROR!! LogisticTrainer: add the features (" << expr << ") before the rows" << std::endl;
+      return;
+    }
+    _features.push_back(expr);
+  }
+
+  bool LogisticTrainer::AddSample(const std::string& filename, const std::string& treename, int label,
+                                  const std::string& cut, const std::string& weight)
+  {
+    if (_features.empty()) {
+      std::cout << "ERROR!! LogisticTrainer has no features!" << std::endl;
+      return false;
+    }
+    std::unique_ptr<TFile> f(TFile::Open(filename.c_str(), "READ"));
+    auto tree = f ? dynamic_cast<TTree*>(f->Get(treename.c_str())) : nullptr;
+    if (!tree) {
+      std::cout << "ERROR!! LogisticTrainer: no tree " << treename << " in " << filename << std::endl;
+      return false;
+    }
+
+    size_t nf = _features.size();
+    size_t dropped = 0, kept = 0;
+    std::vector<std::string> exprs = { cut, weight };
+    exprs.insert(exprs.end(), _features.begin(), _features.end());
+    TreeCutEvaluator evaluator(tree);
+    bool ok = evaluator.Scan(exprs, [&](size_t, size_t n, const std::vector<const double*>& v) {
+        for (size_t k = 0; k < n; ++k) {
+          if (v[0][k] == 0.) continue;
+          bool finite = true;
+          for (size_t j = 0; j < nf; ++j) finite = finite && std::isfinite(v[2 + j][k]);
+          if (!finite) {
+            ++dropped;
+            continue;
+          }
+          for (size_t j = 0; j < nf; ++j) _x.push_back(v[2 + j][k]);
+          _y.push_back(label ? 1. : 0.);
+          _w.push_back(v[1][k]);
+          ++kept;
+        }
+      });
+    if (dropped)
+      std::cout << "NOTE! LogisticTrainer dropped " << dropped << " rows of " << treename
+                << " with a non finite feature (kept " << kept << ")." << std::endl;
+    return ok;
+  }
+
+  void LogisticTrainer::AddRow(const std::vector<double>& features, int label, double weight)
+  {
+    if (features.size() != _features.size()) {
+      std::cout << "ERROR!! LogisticTrainer: row with " << features.size() << " values for "
+                << _features.size() << " features" << std::endl;
+      return;
+    }
+    _x.insert(_x.end(), features.begin(), features.end());
+    _y.push_back(label ? 1. : 0.);
+    _w.push_back(weight);
+  }
+
+  void LogisticTrainer::Standardize()
+  {
+    size_t nf = _features.size(), nrows = _y.size();
+    _means.assign(nf, 0.);
+    _stds.assign(nf, 0.);
+    double sumw = 0.;
+    for (size_t i = 0; i < nrows; ++i) {
+      sumw += _w[i];
+      for (size_t j = 0; j < nf; ++j) _means[j] += _w[i] * _x[i * nf + j];
+    }
+    for (auto& m : _means) m /= sumw;
+    for (size_t i = 0; i < nrows; ++i)
+      for (size_t j = 0; j < nf; ++j) {
+        double d = _x[i * nf + j] - _means[j];
+        _stds[j] += _w[i] * d * d;
+      }
+    for (size_t j = 0; j < nf; ++j) {
+      _stds[j] = std::sqrt(_stds[j] / sumw);
+      if (!(_stds[j] > 0.)) {
+        std::cout << "WARNING: LogisticTrainer feature " << _features[j] << " is constant!" << std::endl;
+        _stds[j] = 1.;
+      }
+    }
+
+    _z.resize(_x.size());
+    for (size_t i = 0; i < nrows; ++i)
+      for (size_t j = 0; j < nf; ++j) _z[i * nf + j] = (_x[i * nf + j] - _means[j]) / _stds[j];
+  }
+
+  double LogisticTrainer::PartialCost(const std::vector<double>& theta, size_t first, size_t last,
+                                      std::vector<double>& grad) const
+  {
+    size_t nf = _features.size();
+    grad.assign(nf + 1, 0.);
+    double cost = 0.;
+    for (size_t i = first; i < last; ++i) {
+      const double* x = &_z[i * nf];
+      double z = theta[0];
+      for (size_t j = 0; j < nf; ++j) z += theta[j + 1] * x[j];
+      // -y log(h) - (1 - y) log(1 - h) = log(1 + exp(z)) - y z, computed without overflow
+      double softplus = z > 0. ? z + std::log1p(std::exp(-z)) : std::log1p(std::exp(z));
+      cost += _w[i] * (softplus - _y[i] * z);
+      double r = _w[i] * (1. / (1. + std::exp(-z)) - _y[i]);
+      grad[0] += r;
+      for (size_t j = 0; j < nf; ++j) grad[j + 1] += r * x[j];
+    }
+    return cost;
+  }
+
+  double LogisticTrainer::Cost(const std::vector<double>& theta, std::vector<double>* grad)
+  {
+    size_t nf = _features.size(), nrows = _y.size();
+    if (_z.size() != _x.size()) Standardize();
+
+    size_t nthreads = std::max<size_t>(1, std::min(_nthreads, nrows / 10000));
+    std::vector<double> costs(nthreads, 0.);
+    std::vector<std::vector<double> > grads(nthreads);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < nthreads; ++t) {
+      size_t first = nrows * t / nthreads, last = nrows * (t + 1) / nthreads;
+      if (nthreads == 1) costs[t] = PartialCost(theta, first, last, grads[t]);
+      else workers.emplace_back([&, t, first, last]() { costs[t] = PartialCost(theta, first, last, grads[t]); });
+    }
+    for (auto& w : workers) w.join();
+
+    double sumw = 0.;
+    for (auto w : _w) sumw += w;
+    double cost = 0., penalty = 0.;
+    for (auto c : costs) cost += c;
+    // the penalty is on the coefficients of the raw features, theta[j] / std[j], as in computeCost
+    for (size_t j = 1; j <= nf; ++j) penalty += theta[j] * theta[j] / (_stds[j - 1] * _stds[j - 1]);
+    cost = (cost + 0.5 * _l2 * penalty) / sumw;
+
+    if (grad) {
+      grad->assign(nf + 1, 0.);
+      for (auto const& g : grads)
+        for (size_t j = 0; j <= nf; ++j) (*grad)[j] += g[j];
+      for (size_t j = 0; j <= nf; ++j)
+        (*grad)[j] = ((*grad)[j] + (j ? _l2 * theta[j] / (_stds[j - 1] * _stds[j - 1]) : 0.)) / sumw;
+    }
+    return cost;
+  }
+
+  bool LogisticTrainer::Train()
+  {
+    size_t nf = _features.size(), nrows = _y.size();
+    size_t nsignal = std::count(_y.begin(), _y.end(), 1.);
+    if (!nrows || !nsignal || nsignal == nrows) {
+      std::cout << "ERROR!! LogisticTrainer needs rows of both labels (" << nsignal << " signal, "
+                << nrows - nsignal << " background)" << std::endl;
+      return false;
+    }
+    Standardize();
+
+    auto dot = [](const std::vector<double>& a, const std::vector<double>& b) {
+      double d = 0.;
+      for (size_t j = 0; j < a.size(); ++j) d += a[j] * b[j];
+      return d;
+    };
+
+    std::vector<double> theta(nf + 1, 0.), grad, new_theta(nf + 1), new_grad, dir(nf + 1);
+    double cost = Cost(theta, &grad);
+    std::deque<std::vector<double> > s_hist, y_hist;
+    std::deque<double> rho_hist;
+    bool converged = false;
+
+    for (_iterations = 0; _iterations < _max_iterations; ++_iterations) {
+      double gmax = 0.;
+      for (auto g : grad) gmax = std::max(gmax, std::fabs(g));
+      if (gmax < _tolerance) {
+        converged = true;
+        break;
+      }
+
+      // two loop recursion: dir = -H grad
+      dir = grad;
+      std::vector<double> alpha(s_hist.size());
+      for (size_t k = s_hist.size(); k-- > 0;) {
+        alpha[k] = rho_hist[k] * dot(s_hist[k], dir);
+        for (size_t j = 0; j <= nf; ++j) dir[j] -= alpha[k] * y_hist[k][j];
+      }
+      double gamma = s_hist.empty() ? 1. : dot(s_hist.back(), y_hist.back()) / dot(y_hist.back(), y_hist.back());
+      for (auto& d : dir) d *= gamma;
+      for (size_t k = 0; k < s_hist.size(); ++k) {
+        double beta = rho_hist[k] * dot(y_hist[k], dir);
+        for (size_t j = 0; j <= nf; ++j) dir[j] += s_hist[k][j] * (alpha[k] - beta);
+      }
+      for (auto& d : dir) d = -d;
+      double slope = dot(grad, dir);
+      if (!(slope < 0.)) {
+        // not a descent direction: restart from steepest descent
+        s_hist.clear(); y_hist.clear(); rho_hist.clear();
+        for (size_t j = 0; j <= nf; ++j) dir[j] = -grad[j];
+        slope = dot(grad, dir);
+      }
+
+      // backtracking line search (Armijo condition)
+      double step = 1., new_cost = cost;
+      bool accepted = false;
+      for (size_t ls = 0; ls < 60; ++ls, step *= 0.5) {
+        for (size_t j = 0; j <= nf; ++j) new_theta[j] = theta[j] + step * dir[j];
+        new_cost = Cost(new_theta, &new_grad);
+        if (std::isfinite(new_cost) && new_cost <= cost + 1.e-4 * step * slope) {
+          accepted = true;
+          break;
+        }
+      }
+      if (!accepted) {
+        std::cout << "WARNING: LogisticTrainer line search failed at iteration " << _iterations << std::endl;
+        converged = gmax < 100. * _tolerance;
+        break;
+      }
+
+      std::vector<double> s(nf + 1), y(nf + 1);
+      for (size_t j = 0; j <= nf; ++j) {
+        s[j] = new_theta[j] - theta[j];
+        y[j] = new_grad[j] - grad[j];
+      }
+      double sy = dot(s, y);
+      if (sy > 1.e-12) {
+        s_hist.push_back(s);
+        y_hist.push_back(y);
+        rho_hist.push_back(1. / sy);
+        if (s_hist.size() > _history) {
+          s_hist.pop_front(); y_hist.pop_front(); rho_hist.pop_front();
+        }
+      }
+      theta.swap(new_theta);
+      grad.swap(new_grad);
+      double change = cost - new_cost;
+      cost = new_cost;
+      if (change <= 1.e-15 * std::max(1., std::fabs(cost))) {
+        ++_iterations;
+        converged = true;
+        break;
+      }
+    }
+    if (!converged && _iterations == _max_iterations)
+      std::cout << "WARNING: LogisticTrainer did not converge in " << _max_iterations << " iterations" << std::endl;
+
+    _model.Set(_features, _means, _stds, theta);
+    _model.SetTrainingInfo(_l2, cost, nrows, _iterations);
+    return converged;
+  }
+
+}
+
+#endif
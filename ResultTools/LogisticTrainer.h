@@ -0,0 +1,111 @@
+/**
+ * \file LogisticTrainer.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class LogisticTrainer
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_LOGISTICTRAINER_H
+#define LEE_LOGISTICTRAINER_H
+
+#include <string>
+#include <vector>
+#include "LogisticModel.h"
+
+namespace lee {
+
+  /**
+     \class LogisticTrainer
+     Trains the logistic regression of likelihood_fitter.py (cosmic = 0 vs nue = 1) in C++:
+     the features are expressions of the result tree columns (IE "_nu_pt/_nu_p", "_y_vtx",
+     "_dedx", ...), read with a TreeCutEvaluator for the entries passing each sample's cut,
+     standardized (weighted mean and standard deviation) and fitted by L-BFGS with the
+     analytic gradient of the weighted cross entropy plus an L2 penalty on the non-intercept
+     coefficients of the raw (not standardized) features, (1/W) * (sum_i w_i * loss_i + l2/2 * |beta_1..n|^2)
+     with beta_j = theta_j / std_j, the same cost as computeCost in likelihood_fitter.py.
+     The cost and gradient are one pass over the rows, split over SetNThreads threads.
+     The result is a lee::util::LogisticModel, that can be saved to a versioned model file.
+   */
+  class LogisticTrainer {
+
+  public:
+
+    /// Default constructor
+    LogisticTrainer() : _l2(0.), _max_iterations(200), _tolerance(1.e-6), _history(10), _nthreads(1),
+                        _iterations(0) {}
+
+    /// Default destructor
+    virtual ~LogisticTrainer() {}
+
+    /// Add a feature (before any row)
+    void AddFeature(const std::string& expr);
+
+    /// Add the entries of a tree passing cut as rows of this label (1 = signal, 0 = background),
+    /// weighted by the weight expression ("" = 1). Rows with a non finite feature are dropped.
+    bool AddSample(const std::string& filename, const std::string& treename, int label,
+                   const std::string& cut = "", const std::string& weight = "");
+
+    /// Add one row (one value per feature)
+    void AddRow(const std::vector<double>& features, int label, double weight = 1.);
+
+    /// L2 regularization strength (lambda of likelihood_fitter.py)
+    void SetL2(double l2) { _l2 = l2; }
+
+    void SetMaxIterations(size_t n) { _max_iterations = n; }
+
+    /// Stop when the largest gradient component is below this
+    void SetTolerance(double tolerance) { _tolerance = tolerance; }
+
+    /// Number of past steps kept by L-BFGS
+    void SetHistory(size_t m) { _history = m ? m : 1; }
+
+    void SetNThreads(size_t n) { _nthreads = n ? n : 1; }
+
+    size_t NRows() const { return _y.size(); }
+
+    /// Cost and its gradient at theta (theta[0] = intercept), on the standardized features of the
+    /// last Train (or of the current rows if not trained yet)
+    double Cost(const std::vector<double>& theta, std::vector<double>* grad = nullptr);
+
+    /// Standardize the features and minimize the cost. Returns false if there are no rows,
+    /// only one label, or the minimization failed or did not converge within SetMaxIterations
+    /// (the model is then the last iterate).
+    bool Train();
+
+    const util::LogisticModel& Model() const { return _model; }
+
+    size_t Iterations() const { return _iterations; }
+
+  private:
+
+    /// Compute the standardization and the standardized rows
+    void Standardize();
+
+    /// Cost and gradient of the rows [first, last)
+    double PartialCost(const std::vector<double>& theta, size_t first, size_t last, std::vector<double>& grad) const;
+
+    std::vector<std::string> _features;
+    std::vector<double> _x;  ///< raw features, row major
+    std::vector<double> _y, _w;
+    std::vector<double> _means, _stds;
+    std::vector<double> _z;  ///< standardized features, row major
+    double _l2;
+    size_t _max_iterations;
+    double _tolerance;
+    size_t _history;
+    size_t _nthreads;
+    size_t _iterations;
+    util::LogisticModel _model;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
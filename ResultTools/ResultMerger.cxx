@@ -0,0 +1,178 @@
+#ifndef LEE_RESULTMERGER_CXX
+#define LEE_RESULTMERGER_CXX
+
+#include "ResultMerger.h"
+#include "JobCounters.h"
+#include "CutFlow.h"
+#include "TROOT.h"
+#include "TChain.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TLeaf.h"
+#include "TClass.h"
+#include "TH1.h"
+#include "TSystem.h"
+#include <iostream>
+#include <memory>
+#include <set>
+#include <thread>
+#include <algorithm>
+
+namespace lee {
+
+  std::string ResultMerger::TreeSchema(TTree* tree)
+  {
+    std::string schema;
+    for (auto obj : *(tree->GetListOfLeaves())) {
+      auto leaf = (TLeaf*)obj;
+      schema += std::string(leaf->GetName()) + "/" + leaf->GetTypeName() + ";";
+    }
+    return schema;
+  }
+
+  void ResultMerger::ScanInput(const std::string& name, InputSummary& summary)
+  {
+    std::unique_ptr<TFile> f(TFile::Open(name.c_str(), "READ"));
+    if (!f || f->IsZombie()) {
+      summary.error = "could not open " + name;
+      return;
+    }
+
+    std::set<std::string> seen;
+    for (auto obj : *(f->GetListOfKeys())) {
+      auto key = (TKey*)obj;
+      if (!seen.insert(key->GetName()).second) continue; // older cycles
+      TClass* cls = TClass::GetClass(key->GetClassName());
+      if (!cls) continue;
+      if (cls->InheritsFrom(TTree::Class())) {
+        auto tree = (TTree*)(key->ReadObj());
+        summary.tree_names.push_back(key->GetName());
+        summary.tree_schemas.push_back(TreeSchema(tree));
+      }
+      else if (cls->GetMerge()) {
+        TObject* obj_copy = key->ReadObj();
+        if (obj_copy->InheritsFrom(TH1::Class())) ((TH1*)obj_copy)->SetDirectory(nullptr);
+        summary.object_names.push_back(key->GetName());
+        summary.objects.push_back(obj_copy);
+      }
+    }
+    summary.ok = true;
+  }
+
+  bool ResultMerger::MergeTrees(const std::vector<std::string>& files,
+                                const std::vector<std::string>& tree_names, TFile* fout)
+  {
+    for (auto const& tree_name : tree_names) {
+      TChain chain(tree_name.c_str());
+      for (auto const& name : files) chain.Add(name.c_str());
+      fout->cd();
+      TTree* merged = chain.CloneTree(-1, "fast");
+      if (!merged) return false;
+      merged->Write();
+      delete merged;
+    }
+    return true;
+  }
+
+  bool ResultMerger::Merge()
+  {
+    if (_input_files.empty() || _output_filename.empty()) {
+      std::cout << "ERROR!! ResultMerger needs input files and an output file!" << std::endl;
+      return false;
+    }
+
+    size_t nthreads = std::min(_nthreads, _input_files.size());
+    if (nthreads > 1) ROOT::EnableThreadSafety();
+
+    // 1) open and scan all inputs (in parallel)
+    std::vector<InputSummary> summaries(_input_files.size());
+    {
+      std::vector<std::thread> workers;
+      for (size_t t = 0; t < nthreads; ++t)
+        workers.emplace_back([this, t, nthreads, &summaries]() {
+          for (size_t i = t; i < _input_files.size(); i += nthreads)
+            ScanInput(_input_files[i], summaries[i]);
+        });
+      for (auto& w : workers) w.join();
+    }
+
+    // 2) schema check against the first input, before anything is written
+    bool ok = true;
+    auto const& ref = summaries.front();
+    for (size_t i = 0; i < summaries.size() && ok; ++i) {
+      auto const& s = summaries[i];
+      if (!s.ok) {
+        std::cout << "ERROR!! ResultMerger: " << s.error << std::endl;
+        ok = false;
+      }
+      else if (s.tree_names != ref.tree_names || s.tree_schemas != ref.tree_schemas) {
+        std::cout << "ERROR!! ResultMerger: trees of " << _input_files[i]
+                  << " have a different schema than those of " << _input_files.front() << std::endl;
+        ok = false;
+      }
+      else if (s.object_names != ref.object_names) {
+        std::cout << "ERROR!! ResultMerger: " << _input_files[i]
+                  << " doesn't have the same objects as " << _input_files.front() << std::endl;
+        ok = false;
+      }
+    }
+
+    // 3) merge the trees: n groups in parallel into temporary files, then the groups
+    std::vector<std::string> parts;
+    if (ok && nthreads > 1 && !ref.tree_names.empty()) {
+      std::vector<char> part_ok(nthreads, 0);
+      std::vector<std::thread> workers;
+      for (size_t t = 0; t < nthreads; ++t) {
+        parts.push_back(_output_filename + Form(".part%zu.root", t));
+        workers.emplace_back([this, t, nthreads, &parts, &part_ok, &ref]() {
+          std::vector<std::string> group;
+          for (size_t i = t; i < _input_files.size(); i += nthreads) group.push_back(_input_files[i]);
+          std::unique_ptr<TFile> fpart(TFile::Open(parts[t].c_str(), "RECREATE"));
+          if (!fpart || fpart->IsZombie()) return;
+          part_ok[t] = MergeTrees(group, ref.tree_names, fpart.get());
+          fpart->Close();
+        });
+      }
+      for (auto& w : workers) w.join();
+      for (auto const& p_ok : part_ok)
+        if (!p_ok) ok = false;
+      if (!ok) std::cout << "ERROR!! ResultMerger: merging a group of inputs failed" << std::endl;
+    }
+
+    std::unique_ptr<TFile> fout;
+    if (ok) {
+      fout.reset(TFile::Open(_output_filename.c_str(), "RECREATE"));
+      if (!fout || fout->IsZombie()) {
+        std::cout << "ERROR!! ResultMerger could not open output " << _output_filename << std::endl;
+        ok = false;
+      }
+    }
+
+    if (ok) ok = MergeTrees(parts.empty() ? _input_files : parts, ref.tree_names, fout.get());
+
+    // 4) merge the other objects (histograms, JobCounters, CutFlow...)
+    if (ok) {
+      for (size_t j = 0; j < ref.object_names.size(); ++j) {
+        TObject* first = ref.objects[j];
+        TList others;
+        for (size_t i = 1; i < summaries.size(); ++i) others.Add(summaries[i].objects[j]);
+        first->IsA()->GetMerge()(first, &others, nullptr);
+        fout->cd();
+        first->Write(ref.object_names[j].c_str());
+        if (auto counters = dynamic_cast< ::lee::util::JobCounters* >(first)) counters->Print();
+        if (auto cut_flow = dynamic_cast< ::lee::util::CutFlow* >(first)) cut_flow->Print();
+      }
+      fout->Close();
+      std::cout << "ResultMerger: merged " << _input_files.size() << " files into " << _output_filename << std::endl;
+    }
+
+    for (auto const& p : parts) gSystem->Unlink(p.c_str());
+    for (auto& s : summaries)
+      for (auto obj : s.objects) delete obj;
+
+    return ok;
+  }
+
+}
+
+#endif
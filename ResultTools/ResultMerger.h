@@ -0,0 +1,90 @@
+/**
+ * \file ResultMerger.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class ResultMerger
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_RESULTMERGER_H
+#define LEE_RESULTMERGER_H
+
+#include <string>
+#include <vector>
+#include "TFile.h"
+#include "TTree.h"
+
+namespace lee {
+
+  /**
+     \class ResultMerger
+     Merges the ana output files of several jobs/shards (IE the ERAnaLowEnergyExcess result
+     trees) into one file, instead of a plain hadd:
+     - every top-level TTree must exist in all inputs with the same branches and leaf types
+       (schema check), and is merged with a fast basket copy
+     - every other top-level object that ROOT knows how to merge (histograms, ...) is merged
+       with its class' Merge method. This includes the lee::util::JobCounters (events seen,
+       events kept, weight sums, POT) and the lee::util::CutFlow written by each job, whose
+       totals are printed at the end.
+     Nothing is written if any input is missing or has a different schema.
+     With SetNThreads(n>1) the inputs are opened/checked by n threads, and the trees are first
+     merged in n groups in parallel (into temporary files next to the output), then the groups
+     are merged into the output.
+   */
+  class ResultMerger {
+
+  public:
+
+    /// Default constructor
+    ResultMerger() : _nthreads(1) {}
+
+    /// Default destructor
+    virtual ~ResultMerger() {}
+
+    void AddInputFile(const std::string& name) { _input_files.push_back(name); }
+
+    void SetOutputFile(const std::string& name) { _output_filename = name; }
+
+    /// Number of threads used to read/check and merge the inputs
+    void SetNThreads(size_t n) { _nthreads = n ? n : 1; }
+
+    /// Merge all inputs into the output file. Returns false (and writes nothing) on error.
+    bool Merge();
+
+    /// Branch/leaf layout of a tree as a string, IE "_e_nuReco/Double_t;_weight/Double_t;..."
+    static std::string TreeSchema(TTree* tree);
+
+    /// What ScanInput finds in one input file
+    struct InputSummary {
+      bool ok = false;
+      std::vector<std::string> tree_names;
+      std::vector<std::string> tree_schemas;
+      std::vector<std::string> object_names;
+      std::vector<TObject*>    objects;       ///< in-memory copies of the mergeable objects (owned)
+      std::string error;
+    };
+
+  private:
+
+    /// Open one input, record its tree schemas and copy its mergeable objects
+    static void ScanInput(const std::string& name, InputSummary& summary);
+
+    /// Fast-merge the given trees of the given files into fout
+    static bool MergeTrees(const std::vector<std::string>& files,
+                           const std::vector<std::string>& tree_names, TFile* fout);
+
+    std::vector<std::string> _input_files;
+    std::string _output_filename;
+    size_t _nthreads;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
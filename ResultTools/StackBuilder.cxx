@@ -0,0 +1,229 @@
+#ifndef LEE_STACKBUILDER_CXX
+#define LEE_STACKBUILDER_CXX
+
+#include "StackBuilder.h"
+#include "TreeCutEvaluator.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TROOT.h"
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+namespace lee {
+
+  void StackBuilder::AddSample(const std::string& name, const std::string& filename, const std::string& treename,
+                               double scale, const std::string& weight, const std::string& samplecut)
+  {
+    Sample_t sample;
+    sample.name = name;
+    sample.filename = filename;
+    sample.treename = treename;
+    sample.scale = scale;
+    sample.weight = weight;
+    sample.samplecut = samplecut;
+    sample.ok = false;
+    _samples.push_back(sample);
+  }
+
+  size_t StackBuilder::Index(const std::string& sample) const
+  {
+    for (size_t i = 0; i < _samples.size(); ++i)
+      if (_samples[i].name == sample) return i;
+    throw std::invalid_argument("StackBuilder: unknown sample " + sample);
+  }
+
+  void StackBuilder::Define(const std::string& sample, const std::string& column, const std::string& expr)
+  {
+    _samples[Index(sample)].defines.emplace_back(column, expr);
+  }
+
+  std::vector<std::string> StackBuilder::Samples() const
+  {
+    std::vector<std::string> names;
+    for (auto const& s : _samples) names.push_back(s.name);
+    return names;
+  }
+
+  bool StackBuilder::ForEachSample(const std::string& cut, SampleFunc_t func)
+  {
+    if (_samples.empty()) {
+      std::cout << "ERROR!! StackBuilder has no samples!" << std::endl;
+      return false;
+    }
+    // fail early on a bad cut instead of once per sample
+    if (!CutExpression(cut).IsValid()) return false;
+
+    size_t nthreads = std::min(_nthreads, _samples.size());
+    if (nthreads > 1) ROOT::EnableThreadSafety();
+
+    auto run_sample = [this, &cut, &func](size_t i) {
+      auto& sample = _samples[i];
+      sample.ok = false;
+      std::unique_ptr<TFile> f(TFile::Open(sample.filename.c_str(), "READ"));
+      auto tree = f ? dynamic_cast<TTree*>(f->Get(sample.treename.c_str())) : nullptr;
+      if (!tree) {
+        std::cout << "ERROR!! StackBuilder: no tree " << sample.treename << " in " << sample.filename << std::endl;
+        return;
+      }
+      TreeCutEvaluator evaluator(tree);
+      for (auto const& def : sample.defines)
+        if (!evaluator.Define(def.first, def.second)) return;
+
+      std::string mycut = cut;
+      if (!sample.samplecut.empty())
+        mycut = mycut.empty() ? sample.samplecut : "(" + mycut + ") and (" + sample.samplecut + ")";
+      sample.ok = func(sample, i, evaluator, mycut);
+    };
+
+    // samples are handed out one at a time, so a big sample doesn't hold back the others
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < nthreads; ++t)
+      workers.emplace_back([this, &next, &run_sample]() {
+          for (size_t i = next++; i < _samples.size(); i = next++) run_sample(i);
+        });
+    for (auto& w : workers) w.join();
+
+    bool ok = true;
+    for (auto const& s : _samples) ok = ok && s.ok;
+    return ok;
+  }
+
+  bool StackBuilder::Build(const std::string& var, const std::vector<double>& edges, const std::string& cut)
+  {
+    if (!CutExpression(var).IsValid()) return false;
+    for (auto& s : _samples) {
+      s.hist.assign(edges.size() > 1 ? edges.size() - 1 : 0, 0.);
+      s.sumw2 = s.hist;
+      s.replicas.assign(_n_bootstrap, s.hist);
+    }
+    _last_cut = cut;
+
+    std::vector<std::string> factors;
+    for (size_t i = 0; i < _n_bootstrap; ++i) factors.push_back(_bootstrap_prefix + std::to_string(i));
+
+    return ForEachSample(cut, [&var, &edges, &factors](Sample_t& sample, size_t, TreeCutEvaluator& evaluator, const std::string& mycut) {
+        // a sample without the replica weights has no bootstrap error: fail instead of a zero spread
+        for (auto const& f : factors)
+          if (!evaluator.HasColumn(f)) {
+            std::cout << "ERROR!! StackBuilder sample " << sample.name << " has no " << f << " column for the "
+                      << factors.size() << " bootstrap replicas (see ERAnaLowEnergyExcess::SetBootstrapReplicas)" << std::endl;
+            return false;
+          }
+        if (factors.empty())
+          sample.hist = evaluator.Histogram(var, edges, mycut, sample.weight, &sample.sumw2);
+        else
+          sample.hist = evaluator.ReplicaHistograms(var, edges, mycut, sample.weight, factors, sample.replicas, &sample.sumw2);
+        if (!evaluator.OK()) return false;
+        for (auto& c : sample.hist)  c *= sample.scale;
+        for (auto& c : sample.sumw2) c *= sample.scale * sample.scale;
+        for (auto& r : sample.replicas)
+          for (auto& c : r) c *= sample.scale;
+        return true;
+      });
+  }
+
+  bool StackBuilder::BuildCubes(const HistCube& cube, const std::string& outfile, const std::string& cut)
+  {
+    std::vector<HistCube> cubes(_samples.size(), cube);
+    for (size_t i = 0; i < _samples.size(); ++i) cubes[i].SetName(_samples[i].name.c_str());
+
+    bool ok = ForEachSample(cut, [&cubes](Sample_t& sample, size_t i, TreeCutEvaluator& evaluator, const std::string& mycut) {
+        return cubes[i].Fill(evaluator, sample.weight, mycut, sample.scale);
+      });
+    if (!ok) {
+      std::cout << "ERROR!! StackBuilder: cubes not written" << std::endl;
+      return false;
+    }
+
+    std::unique_ptr<TFile> fout(TFile::Open(outfile.c_str(), "RECREATE"));
+    if (!fout || fout->IsZombie()) {
+      std::cout << "ERROR!! StackBuilder could not open output " << outfile << std::endl;
+      return false;
+    }
+    for (auto& c : cubes) {
+      c.Write();
+      c.Print();
+    }
+    fout->Close();
+    return true;
+  }
+
+  const std::vector<double>& StackBuilder::Histogram(const std::string& sample) const
+  { return _samples[Index(sample)].hist; }
+
+  const std::vector<double>& StackBuilder::SumW2(const std::string& sample) const
+  { return _samples[Index(sample)].sumw2; }
+
+  const std::vector<std::vector<double> >& StackBuilder::Replicas(const std::string& sample) const
+  { return _samples[Index(sample)].replicas; }
+
+  std::vector<double> StackBuilder::BootstrapError(const std::string& sample) const
+  {
+    auto const& replicas = Replicas(sample);
+    std::vector<double> error(_samples[Index(sample)].hist.size(), 0.);
+    if (replicas.size() < 2) return error;
+    for (size_t b = 0; b < error.size(); ++b) {
+      double sum = 0., sum2 = 0.;
+      for (auto const& r : replicas) {
+        sum += r[b];
+        sum2 += r[b] * r[b];
+      }
+      double mean = sum / replicas.size();
+      error[b] = std::sqrt(std::max(sum2 / replicas.size() - mean * mean, 0.));
+    }
+    return error;
+  }
+
+  std::vector<double> StackBuilder::Stack(const std::string& sample) const
+  {
+    size_t last = Index(sample);
+    std::vector<double> stack(_samples[last].hist.size(), 0.);
+    for (size_t i = 0; i <= last; ++i)
+      for (size_t b = 0; b < stack.size() && b < _samples[i].hist.size(); ++b)
+        stack[b] += _samples[i].hist[b];
+    return stack;
+  }
+
+  double StackBuilder::Yield(const std::string& sample) const
+  {
+    auto const& hist = _samples[Index(sample)].hist;
+    return std::accumulate(hist.begin(), hist.end(), 0.);
+  }
+
+  void StackBuilder::Print() const
+  {
+    std::cout << "StackBuilder yields";
+    if (!_last_cut.empty()) std::cout << " (" << _last_cut << ")";
+    std::cout << ":" << std::endl;
+    double total = 0.;
+    for (auto const& s : _samples) {
+      double y = Yield(s.name);
+      total += y;
+      std::cout << "  " << std::setw(20) << std::left << s.name << " " << y;
+      if (s.replicas.size() > 1) {
+        // spread of the replica yields
+        double sum = 0., sum2 = 0.;
+        for (auto const& r : s.replicas) {
+          double ry = std::accumulate(r.begin(), r.end(), 0.);
+          sum += ry;
+          sum2 += ry * ry;
+        }
+        double mean = sum / s.replicas.size();
+        std::cout << " +- " << std::sqrt(std::max(sum2 / s.replicas.size() - mean * mean, 0.)) << " (bootstrap)";
+      }
+      std::cout << (s.ok ? "" : " (FAILED)") << std::endl;
+    }
+    std::cout << "  " << std::setw(20) << std::left << "total" << " " << total << std::endl;
+  }
+
+}
+
+#endif
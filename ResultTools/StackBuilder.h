@@ -0,0 +1,130 @@
+/**
+ * \file StackBuilder.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class StackBuilder
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_STACKBUILDER_H
+#define LEE_STACKBUILDER_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include "HistCube.h"
+
+namespace lee {
+
+  /**
+     \class StackBuilder
+     Builds the stacked background histograms of stack_plotter.py in C++: every sample
+     (result file, tree, scaling weight, weight expression and an optional extra sample cut)
+     is histogrammed with a TreeCutEvaluator, all samples in parallel (one thread per sample,
+     up to SetNThreads), reading only the branches used by the variable, cut and weight.
+     Files are re-opened at each Build, so a cut change only costs one pass over the
+     needed branches.
+     The histograms are numpy.histogram style (see TreeCutEvaluator::Histogram) and already
+     multiplied by the sample scaling weight.
+     With SetBootstrapReplicas, each Build also fills (in the same pass) one histogram per
+     bootstrap replica, weighted by weight * _bootstrap_<i> (see ERAnaLowEnergyExcess::SetBootstrapReplicas),
+     so the statistical spread of any selection comes with its histograms.
+   */
+  class StackBuilder {
+
+  public:
+
+    /// Default constructor
+    StackBuilder() : _nthreads(1), _n_bootstrap(0), _bootstrap_prefix("_bootstrap_") {}
+
+    /// Default destructor
+    virtual ~StackBuilder() {}
+
+    /// Add a sample to the stack (stacked in the order they are added)
+    void AddSample(const std::string& name, const std::string& filename, const std::string& treename,
+                   double scale = 1., const std::string& weight = "_weight", const std::string& samplecut = "");
+
+    /// Define a column of one sample (see TreeCutEvaluator::Define)
+    void Define(const std::string& sample, const std::string& column, const std::string& expr);
+
+    /// Max number of samples processed at the same time
+    void SetNThreads(size_t n) { _nthreads = n ? n : 1; }
+
+    /// Also fill n bootstrap replicas of the histograms, weighted by <prefix><i> (0 = none).
+    /// Build fails on a sample without these branches (run it with ERAnaLowEnergyExcess::SetBootstrapReplicas).
+    void SetBootstrapReplicas(size_t n, const std::string& prefix = "_bootstrap_")
+    { _n_bootstrap = n; _bootstrap_prefix = prefix; }
+
+    size_t NBootstrapReplicas() const { return _n_bootstrap; }
+
+    /// Histogram var for all samples with the cut (and each sample's own cut). Returns false on error.
+    bool Build(const std::string& var, const std::vector<double>& edges, const std::string& cut = "");
+
+    std::vector<std::string> Samples() const;
+
+    /// Scaled histogram of one sample (from the last Build)
+    const std::vector<double>& Histogram(const std::string& sample) const;
+
+    /// Scaled sum of weight^2 of one sample (from the last Build)
+    const std::vector<double>& SumW2(const std::string& sample) const;
+
+    /// Scaled bootstrap replica histograms of one sample (from the last Build), replicas[i][bin]
+    const std::vector<std::vector<double> >& Replicas(const std::string& sample) const;
+
+    /// Per bin RMS of the bootstrap replicas of one sample around their mean (statistical error)
+    std::vector<double> BootstrapError(const std::string& sample) const;
+
+    /// Sum of the histograms of the samples up to and including this one
+    std::vector<double> Stack(const std::string& sample) const;
+
+    /// Scaled number of events of one sample in the histogram range
+    double Yield(const std::string& sample) const;
+
+    /// Print the per-sample yields of the last Build
+    void Print() const;
+
+    /// One pass over every sample (in parallel) filling a copy of cube (same axes, named after the
+    /// sample) with the entries passing cut, all written to outfile. Returns false on error.
+    bool BuildCubes(const HistCube& cube, const std::string& outfile, const std::string& cut = "");
+
+    /// One sample of the stack
+    struct Sample_t {
+      std::string name, filename, treename, weight, samplecut;
+      double scale;
+      std::vector<std::pair<std::string, std::string> > defines;
+      std::vector<double> hist, sumw2;
+      std::vector<std::vector<double> > replicas; ///< bootstrap replicas of hist
+      bool ok;
+    };
+
+    typedef std::function<bool(Sample_t&, size_t, TreeCutEvaluator&, const std::string&)> SampleFunc_t;
+
+    /// Run func(sample, index, evaluator of its tree, cut and sample cut) for all samples,
+    /// SetNThreads at a time. Returns false if any sample failed.
+    /// This is how the other per-sample tools (BuildCubes, CutScanner) get their one pass per sample.
+    bool ForEachSample(const std::string& cut, SampleFunc_t func);
+
+    size_t NSamples() const { return _samples.size(); }
+
+  private:
+
+    size_t Index(const std::string& sample) const;
+
+    std::vector<Sample_t> _samples;
+    size_t _nthreads;
+    size_t _n_bootstrap;
+    std::string _bootstrap_prefix;
+    std::string _last_cut;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,464 @@
+#ifndef LEE_TREECUTEVALUATOR_CXX
+#define LEE_TREECUTEVALUATOR_CXX
+
+#include "TreeCutEvaluator.h"
+#include "TLeaf.h"
+#include "TBranch.h"
+#include <iostream>
+#include <algorithm>
+#include <memory>
+
+namespace lee {
+
+  namespace {
+
+    /// Storage for one scalar branch of any numeric type, read back as double.
+    /// The leaf type is resolved once (SetType), Get() is called for every row.
+    struct BranchHolder {
+      enum Type_t { kUnknown, kDouble, kFloat, kInt, kUInt, kLong64, kULong64,
+                    kShort, kUShort, kChar, kUChar, kBool };
+      Type_t type = kUnknown;
+      Double_t d = 0; Float_t f = 0; Int_t i = 0; UInt_t ui = 0; Long64_t l = 0; ULong64_t ul = 0;
+      Short_t s = 0; UShort_t us = 0; Char_t c = 0; UChar_t uc = 0; Bool_t b = false;
+
+      /// Type from the leaf type name (kUnknown if it is not a numeric scalar type)
+      void SetType(const std::string& name)
+      {
+        if (name == "Double_t")       type = kDouble;
+        else if (name == "Float_t")   type = kFloat;
+        else if (name == "Int_t")     type = kInt;
+        else if (name == "UInt_t")    type = kUInt;
+        else if (name == "Long64_t")  type = kLong64;
+        else if (name == "ULong64_t") type = kULong64;
+        else if (name == "Short_t")   type = kShort;
+        else if (name == "UShort_t")  type = kUShort;
+        else if (name == "Char_t")    type = kChar;
+        else if (name == "UChar_t")   type = kUChar;
+        else if (name == "Bool_t")    type = kBool;
+        else                          type = kUnknown;
+      }
+
+      void* Address()
+      {
+        switch (type) {
+        case kDouble:  return &d;
+        case kFloat:   return &f;
+        case kInt:     return &i;
+        case kUInt:    return &ui;
+        case kLong64:  return &l;
+        case kULong64: return &ul;
+        case kShort:   return &s;
+        case kUShort:  return &us;
+        case kChar:    return &c;
+        case kUChar:   return &uc;
+        case kBool:    return &b;
+        default:       return nullptr;
+        }
+      }
+
+      double Get() const
+      {
+        switch (type) {
+        case kDouble:  return d;
+        case kFloat:   return f;
+        case kInt:     return i;
+        case kUInt:    return ui;
+        case kLong64:  return l;
+        case kULong64: return ul;
+        case kShort:   return s;
+        case kUShort:  return us;
+        case kChar:    return c;
+        case kUChar:   return uc;
+        default:       return b;
+        }
+      }
+    };
+
+
+    /// Branches and defined columns used by exprs (with the branches used by those defined columns).
+    /// Returns false if there is no tree or an expression is invalid.
+    bool Prepare(TTree* tree, const std::map<std::string, CutExpression>& defined,
+                 const std::vector<const CutExpression*>& exprs,
+                 std::vector<std::string>& branches, std::vector<std::string>& defines)
+    {
+      if (!tree) {
+        std::cout << "ERROR!! TreeCutEvaluator: no tree!" << std::endl;
+        return false;
+      }
+      for (auto expr : exprs) {
+        if (!expr->IsValid()) return false;
+      }
+      auto add_branch = [&branches](const std::string& name) {
+        if (std::find(branches.begin(), branches.end(), name) == branches.end()) branches.push_back(name);
+      };
+      for (auto expr : exprs) {
+        for (auto const& col : expr->Columns()) {
+          auto def = defined.find(col);
+          if (def == defined.end()) { add_branch(col); continue; }
+          if (std::find(defines.begin(), defines.end(), col) != defines.end()) continue;
+          defines.push_back(col);
+          for (auto const& def_col : def->second.Columns()) add_branch(def_col);
+        }
+      }
+      return true;
+    }
+
+    /// Read only these branches of the tree, into the holders. Returns false if one is not a numeric scalar.
+    bool BindBranches(TTree* tree, const std::vector<std::string>& branches,
+                      std::vector<std::unique_ptr<BranchHolder> >& holders)
+    {
+      for (auto const& name : branches) {
+        TLeaf* leaf = tree->GetLeaf(name.c_str());
+        holders.emplace_back(new BranchHolder);
+        if (leaf) holders.back()->SetType(leaf->GetTypeName());
+        if (!leaf || leaf->GetLen() != 1 || !holders.back()->Address()) {
+          std::cout << "ERROR!! TreeCutEvaluator: " << tree->GetName() << " has no numeric scalar branch "
+                    << name << std::endl;
+          return false;
+        }
+      }
+      tree->SetBranchStatus("*", 0);
+      for (size_t j = 0; j < branches.size(); ++j) {
+        tree->SetBranchStatus(branches[j].c_str(), 1);
+        tree->SetBranchAddress(branches[j].c_str(), holders[j]->Address());
+      }
+      return true;
+    }
+
+    /// Buffers of the columns of an expression, in the order Evaluate expects them
+    std::vector<const double*> ColumnsOf(const CutExpression& expr, const std::map<std::string, const double*>& column_ptr)
+    {
+      std::vector<const double*> cols;
+      for (auto const& col : expr.Columns()) cols.push_back(column_ptr.at(col));
+      return cols;
+    }
+
+  }
+
+  TreeCutEvaluator::TreeCutEvaluator(TTree* tree, size_t block_size)
+    : _tree(tree), _block_size(block_size ? block_size : 1), _ok(true)
+  {}
+
+  bool TreeCutEvaluator::Define(const std::string& name, const std::string& expr)
+  {
+    CutExpression compiled(expr);
+    if (!compiled.IsValid()) return false;
+    for (auto const& col : compiled.Columns()) {
+      if (_defines.count(col) || col == name) {
+        std::cout << "ERROR!! TreeCutEvaluator: " << name << " is defined with a defined column ("
+                  << col << "), only tree branches can be used" << std::endl;
+        return false;
+      }
+    }
+    _defines[name] = compiled;
+    return true;
+  }
+
+  bool TreeCutEvaluator::HasColumn(const std::string& name) const
+  {
+    return _defines.count(name) || (_tree && _tree->GetLeaf(name.c_str()));
+  }
+
+  std::vector<std::string> TreeCutEvaluator::ScalarColumns() const
+  {
+    std::vector<std::string> names;
+    if (_tree) {
+      TIter next(_tree->GetListOfLeaves());
+      while (auto leaf = dynamic_cast<TLeaf*>(next())) {
+        BranchHolder holder;
+        holder.SetType(leaf->GetTypeName());
+        if (leaf->GetLen() != 1 || !holder.Address()) continue;
+        std::string name = leaf->GetBranch()->GetName();
+        if (!_defines.count(name)) names.push_back(name);
+      }
+    }
+    for (auto const& def : _defines) names.push_back(def.first);
+    return names;
+  }
+
+  bool TreeCutEvaluator::Loop(const std::vector<const CutExpression*>& exprs, BlockFunc_t func)
+  {
+    std::vector<std::string> branches, defines;
+    std::vector<std::unique_ptr<BranchHolder> > holders;
+    if (!Prepare(_tree, _defines, exprs, branches, defines)) return false;
+    if (!BindBranches(_tree, branches, holders)) return false;
+
+    // column buffers of one block: branches, then defined columns
+    size_t nentries = _tree->GetEntries();
+    size_t block = std::min(_block_size, std::max(nentries, (size_t)1));
+    std::map<std::string, const double*> column_ptr;
+    std::vector<std::vector<double> > branch_values(branches.size(), std::vector<double>(block));
+    std::vector<std::vector<double> > define_values(defines.size(), std::vector<double>(block));
+    std::vector<std::vector<double> > expr_values(exprs.size(), std::vector<double>(block));
+    for (size_t j = 0; j < branches.size(); ++j) column_ptr[branches[j]] = branch_values[j].data();
+    for (size_t j = 0; j < defines.size(); ++j) column_ptr[defines[j]] = define_values[j].data();
+
+    std::vector<std::vector<const double*> > define_cols, expr_cols;
+    for (auto const& name : defines) define_cols.push_back(ColumnsOf(_defines[name], column_ptr));
+    for (auto expr : exprs) expr_cols.push_back(ColumnsOf(*expr, column_ptr));
+    std::vector<const double*> results;
+    for (auto const& v : expr_values) results.push_back(v.data());
+
+    for (size_t first = 0; first < nentries; first += block) {
+      size_t n = std::min(block, nentries - first);
+      for (size_t k = 0; k < n; ++k) {
+        _tree->GetEntry(first + k);
+        for (size_t j = 0; j < holders.size(); ++j) branch_values[j][k] = holders[j]->Get();
+      }
+      for (size_t j = 0; j < defines.size(); ++j)
+        _defines[defines[j]].Evaluate(define_cols[j], n, define_values[j].data());
+      for (size_t e = 0; e < exprs.size(); ++e)
+        exprs[e]->Evaluate(expr_cols[e], n, expr_values[e].data());
+      func(first, n, results);
+    }
+
+    _tree->ResetBranchAddresses();
+    _tree->SetBranchStatus("*", 1);
+    return true;
+  }
+
+  bool TreeCutEvaluator::LoopSelected(const CutExpression& cut, const std::vector<const CutExpression*>& exprs,
+                                      SelectedBlockFunc_t func)
+  {
+    // the cut columns are read for every entry, the other columns of exprs only for the passing ones
+    std::vector<std::string> cut_branches, cut_defines, branches, defines;
+    if (!Prepare(_tree, _defines, { &cut }, cut_branches, cut_defines)) return false;
+    if (!Prepare(_tree, _defines, exprs, branches, defines)) return false;
+    std::vector<std::string> all_branches(cut_branches);
+    for (auto const& name : branches)
+      if (std::find(cut_branches.begin(), cut_branches.end(), name) == cut_branches.end()) all_branches.push_back(name);
+    std::vector<std::unique_ptr<BranchHolder> > holders;
+    if (!BindBranches(_tree, all_branches, holders)) return false;
+    // branches of the current tree (of a TChain), looked up again when the chain moves to the next one
+    std::vector<TBranch*> tbranches(all_branches.size(), nullptr);
+    int tree_number = -1;
+
+    size_t nentries = _tree->GetEntries();
+    size_t block = std::min(_block_size, std::max(nentries, (size_t)1));
+
+    // cut phase buffers (every entry of the block)
+    std::map<std::string, const double*> cut_ptr;
+    std::vector<std::vector<double> > cut_branch_values(cut_branches.size(), std::vector<double>(block));
+    std::vector<std::vector<double> > cut_define_values(cut_defines.size(), std::vector<double>(block));
+    for (size_t j = 0; j < cut_branches.size(); ++j) cut_ptr[cut_branches[j]] = cut_branch_values[j].data();
+    for (size_t j = 0; j < cut_defines.size(); ++j) cut_ptr[cut_defines[j]] = cut_define_values[j].data();
+    std::vector<std::vector<const double*> > cut_define_cols;
+    for (auto const& name : cut_defines) cut_define_cols.push_back(ColumnsOf(_defines[name], cut_ptr));
+    auto const cut_cols = ColumnsOf(cut, cut_ptr);
+    std::vector<char> mask(block);
+
+    // selected phase buffers (passing entries of the block, packed)
+    std::map<std::string, const double*> column_ptr;
+    std::vector<std::vector<double> > branch_values(branches.size(), std::vector<double>(block));
+    std::vector<std::vector<double> > define_values(defines.size(), std::vector<double>(block));
+    std::vector<std::vector<double> > expr_values(exprs.size(), std::vector<double>(block));
+    for (size_t j = 0; j < branches.size(); ++j) column_ptr[branches[j]] = branch_values[j].data();
+    for (size_t j = 0; j < defines.size(); ++j) column_ptr[defines[j]] = define_values[j].data();
+    std::vector<std::vector<const double*> > define_cols, expr_cols;
+    for (auto const& name : defines) define_cols.push_back(ColumnsOf(_defines[name], column_ptr));
+    for (auto expr : exprs) expr_cols.push_back(ColumnsOf(*expr, column_ptr));
+    std::vector<const double*> results;
+    for (auto const& v : expr_values) results.push_back(v.data());
+
+    // where each selected branch comes from: a cut buffer, or its own read
+    std::vector<int> from_cut(branches.size(), -1);
+    std::vector<size_t> holder_of(branches.size());
+    for (size_t j = 0; j < branches.size(); ++j) {
+      size_t a = std::find(all_branches.begin(), all_branches.end(), branches[j]) - all_branches.begin();
+      holder_of[j] = a;
+      if (a < cut_branches.size()) from_cut[j] = a;
+    }
+    std::vector<Long64_t> entries(block);
+    std::vector<size_t> passing(block);
+
+    bool ok = true;
+    for (size_t first = 0, n = 0; first < nentries; first += n) {
+      // TBranch::GetEntry takes the entry number in the current tree of a TChain:
+      // a block stays within one tree, starting at its local entry
+      Long64_t local = _tree->LoadTree(first);
+      if (local < 0) {
+        std::cout << "ERROR!! TreeCutEvaluator: cannot load entry " << first << " of " << _tree->GetName() << std::endl;
+        ok = false;
+        break;
+      }
+      TTree* current = _tree->GetTree();
+      n = std::min(block, std::min(nentries - first, (size_t)(current->GetEntries() - local)));
+      if (_tree->GetTreeNumber() != tree_number) {
+        tree_number = _tree->GetTreeNumber();
+        for (size_t j = 0; j < all_branches.size(); ++j) {
+          TLeaf* leaf = current->GetLeaf(all_branches[j].c_str());
+          tbranches[j] = leaf ? leaf->GetBranch() : nullptr;
+          if (!tbranches[j]) {
+            std::cout << "ERROR!! TreeCutEvaluator: tree " << tree_number << " of " << _tree->GetName()
+                      << " has no branch " << all_branches[j] << std::endl;
+            ok = false;
+          }
+        }
+        if (!ok) break;
+      }
+
+      for (size_t k = 0; k < n; ++k)
+        for (size_t j = 0; j < cut_branches.size(); ++j) {
+          tbranches[j]->GetEntry(local + k);
+          cut_branch_values[j][k] = holders[j]->Get();
+        }
+      for (size_t j = 0; j < cut_defines.size(); ++j)
+        _defines[cut_defines[j]].Evaluate(cut_define_cols[j], n, cut_define_values[j].data());
+      cut.EvaluateMask(cut_cols, n, mask.data());
+
+      size_t m = 0;
+      for (size_t k = 0; k < n; ++k)
+        if (mask[k]) passing[m++] = k;
+      if (!m) continue;
+      for (size_t i = 0; i < m; ++i) {
+        entries[i] = first + passing[i];
+        for (size_t j = 0; j < branches.size(); ++j) {
+          if (from_cut[j] >= 0) branch_values[j][i] = cut_branch_values[from_cut[j]][passing[i]];
+          else {
+            tbranches[holder_of[j]]->GetEntry(local + passing[i]);
+            branch_values[j][i] = holders[holder_of[j]]->Get();
+          }
+        }
+      }
+      for (size_t j = 0; j < defines.size(); ++j)
+        _defines[defines[j]].Evaluate(define_cols[j], m, define_values[j].data());
+      for (size_t e = 0; e < exprs.size(); ++e)
+        exprs[e]->Evaluate(expr_cols[e], m, expr_values[e].data());
+      func(m, entries.data(), results);
+    }
+
+    _tree->ResetBranchAddresses();
+    _tree->SetBranchStatus("*", 1);
+    return ok;
+  }
+
+  bool TreeCutEvaluator::Scan(const std::vector<std::string>& exprs, BlockFunc_t func)
+  {
+    std::vector<CutExpression> compiled;
+    for (auto const& e : exprs) compiled.emplace_back(e);
+    std::vector<const CutExpression*> ptrs;
+    for (auto const& c : compiled) ptrs.push_back(&c);
+    return _ok = Loop(ptrs, func);
+  }
+
+  bool TreeCutEvaluator::ScanSelected(const std::string& cut, const std::vector<std::string>& exprs,
+                                      SelectedBlockFunc_t func)
+  {
+    CutExpression cut_expr(cut);
+    std::vector<CutExpression> compiled;
+    for (auto const& e : exprs) compiled.emplace_back(e);
+    std::vector<const CutExpression*> ptrs;
+    for (auto const& c : compiled) ptrs.push_back(&c);
+    return _ok = LoopSelected(cut_expr, ptrs, func);
+  }
+
+  std::vector<char> TreeCutEvaluator::Mask(const std::string& cut)
+  {
+    CutExpression cut_expr(cut);
+    std::vector<char> mask;
+    _ok = Loop({ &cut_expr }, [&mask](size_t, size_t n, const std::vector<const double*>& v) {
+        for (size_t k = 0; k < n; ++k) mask.push_back(v[0][k] != 0.);
+      });
+    return mask;
+  }
+
+  size_t TreeCutEvaluator::Count(const std::string& cut)
+  {
+    CutExpression cut_expr(cut);
+    size_t count = 0;
+    _ok = Loop({ &cut_expr }, [&count](size_t, size_t n, const std::vector<const double*>& v) {
+        for (size_t k = 0; k < n; ++k) count += (v[0][k] != 0.);
+      });
+    return count;
+  }
+
+  std::vector<double> TreeCutEvaluator::Histogram(const std::string& var, const std::vector<double>& edges,
+                                                  const std::string& cut, const std::string& weight,
+                                                  std::vector<double>* sumw2)
+  {
+    size_t nbins = edges.size() > 1 ? edges.size() - 1 : 0;
+    std::vector<double> contents(nbins, 0.);
+    if (sumw2) sumw2->assign(nbins, 0.);
+    _ok = nbins > 0;
+    if (!nbins) {
+      std::cout << "ERROR!! TreeCutEvaluator: a histogram needs at least two bin edges" << std::endl;
+      return contents;
+    }
+
+    CutExpression var_expr(var), cut_expr(cut), weight_expr(weight);
+    _ok = Loop({ &var_expr, &cut_expr, &weight_expr },
+               [&](size_t, size_t n, const std::vector<const double*>& v) {
+                 for (size_t k = 0; k < n; ++k) {
+                   double x = v[0][k];
+                   if (v[1][k] == 0. || !(x >= edges.front() && x <= edges.back())) continue;
+                   size_t bin = std::upper_bound(edges.begin(), edges.end(), x) - edges.begin() - 1;
+                   if (bin == nbins) bin = nbins - 1; // x == last edge
+                   contents[bin] += v[2][k];
+                   if (sumw2) (*sumw2)[bin] += v[2][k] * v[2][k];
+                 }
+               });
+    return contents;
+  }
+
+  std::vector<double> TreeCutEvaluator::ReplicaHistograms(const std::string& var, const std::vector<double>& edges,
+                                                          const std::string& cut, const std::string& weight,
+                                                          const std::vector<std::string>& factors,
+                                                          std::vector<std::vector<double> >& replicas,
+                                                          std::vector<double>* sumw2)
+  {
+    size_t nbins = edges.size() > 1 ? edges.size() - 1 : 0;
+    std::vector<double> contents(nbins, 0.);
+    if (sumw2) sumw2->assign(nbins, 0.);
+    replicas.assign(factors.size(), contents);
+    _ok = nbins > 0;
+    if (!nbins) {
+      std::cout << "ERROR!! TreeCutEvaluator: a histogram needs at least two bin edges" << std::endl;
+      return contents;
+    }
+
+    CutExpression var_expr(var), cut_expr(cut), weight_expr(weight);
+    std::vector<CutExpression> factor_exprs;
+    factor_exprs.reserve(factors.size());
+    for (auto const& f : factors) factor_exprs.emplace_back(f);
+    std::vector<const CutExpression*> exprs = { &var_expr, &cut_expr, &weight_expr };
+    for (auto const& e : factor_exprs) exprs.push_back(&e);
+
+    _ok = Loop(exprs, [&](size_t, size_t n, const std::vector<const double*>& v) {
+        for (size_t k = 0; k < n; ++k) {
+          double x = v[0][k];
+          if (v[1][k] == 0. || !(x >= edges.front() && x <= edges.back())) continue;
+          size_t bin = std::upper_bound(edges.begin(), edges.end(), x) - edges.begin() - 1;
+          if (bin == nbins) bin = nbins - 1; // x == last edge
+          double w = v[2][k];
+          contents[bin] += w;
+          if (sumw2) (*sumw2)[bin] += w * w;
+          for (size_t r = 0; r < replicas.size(); ++r) replicas[r][bin] += w * v[3 + r][k];
+        }
+      });
+    return contents;
+  }
+
+  void TreeCutEvaluator::FillHist(TH1* hist, const std::string& var, const std::string& cut, const std::string& weight)
+  {
+    CutExpression var_expr(var), cut_expr(cut), weight_expr(weight);
+    _ok = hist && Loop({ &var_expr, &cut_expr, &weight_expr },
+                       [hist](size_t, size_t n, const std::vector<const double*>& v) {
+                         for (size_t k = 0; k < n; ++k)
+                           if (v[1][k] != 0.) hist->Fill(v[0][k], v[2][k]);
+                       });
+  }
+
+  std::vector<double> TreeCutEvaluator::Values(const std::string& var, const std::string& cut)
+  {
+    CutExpression var_expr(var), cut_expr(cut);
+    std::vector<double> values;
+    _ok = Loop({ &var_expr, &cut_expr }, [&values](size_t, size_t n, const std::vector<const double*>& v) {
+        for (size_t k = 0; k < n; ++k)
+          if (v[1][k] != 0.) values.push_back(v[0][k]);
+      });
+    return values;
+  }
+
+}
+
+#endif
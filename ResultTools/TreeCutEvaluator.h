@@ -0,0 +1,125 @@
+/**
+ * \file TreeCutEvaluator.h
+ *
+ * \ingroup ResultTools
+ *
+ * \brief Class def header for a class TreeCutEvaluator
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup ResultTools
+
+    @{*/
+
+#ifndef LEE_TREECUTEVALUATOR_H
+#define LEE_TREECUTEVALUATOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include "TTree.h"
+#include "TH1.h"
+#include "CutExpression.h"
+
+namespace lee {
+
+  /**
+     \class TreeCutEvaluator
+     Applies CutExpressions directly to a result TTree (IE the ERAnaLowEnergyExcess trees),
+     instead of loading every column into a pandas dataframe (stack_plotter.py):
+     only the branches used by the cut/variable/weight expressions are read, block by block,
+     and the expressions are evaluated column-wise on each block.
+     Any numeric scalar branch type is read (as double).
+
+     Define() adds a derived column (or overrides a branch), IE
+     Define("_flash_time", "4.35") for the flash-time hack of the cosmic sample.
+   */
+  class TreeCutEvaluator {
+
+  public:
+
+    /// Default constructor
+    TreeCutEvaluator(TTree* tree = nullptr, size_t block_size = 4096);
+
+    /// Default destructor
+    virtual ~TreeCutEvaluator() {}
+
+    void SetTree(TTree* tree) { _tree = tree; }
+
+    void SetBlockSize(size_t n) { _block_size = n ? n : 1; }
+
+    /// Define a column as an expression of tree branches (shadows a branch of the same name)
+    bool Define(const std::string& name, const std::string& expr);
+
+    /// Whether the tree has a branch (or defined column) with this name
+    bool HasColumn(const std::string& name) const;
+
+    /// Whether the last pass over the tree (Mask, Count, Histogram, ReplicaHistograms, FillHist, Values,
+    /// Scan, ScanSelected) succeeded: false IE on a missing branch or an invalid expression, the
+    /// results of that pass are then meaningless
+    bool OK() const { return _ok; }
+
+    /// Names of the numeric scalar branches of the tree (the columns expressions can use), and the defined columns
+    std::vector<std::string> ScalarColumns() const;
+
+    /// Selection mask of the tree entries: 1 if the entry passes the cut
+    std::vector<char> Mask(const std::string& cut);
+
+    /// Number of entries passing the cut
+    size_t Count(const std::string& cut);
+
+    /// Weighted histogram of var for the entries passing cut, numpy.histogram style:
+    /// contents of the bins [edges[i], edges[i+1]), the last bin includes its upper edge.
+    /// weight is an expression too ("" = 1). The sums of weight^2 go into sumw2 if given.
+    std::vector<double> Histogram(const std::string& var, const std::vector<double>& edges,
+                                  const std::string& cut = "", const std::string& weight = "",
+                                  std::vector<double>* sumw2 = nullptr);
+
+    /// Histogram, plus one histogram per replica factor expression (IE "_bootstrap_3") filled with
+    /// weight * factor, all in the same pass. replicas[r] is the histogram of factors[r].
+    std::vector<double> ReplicaHistograms(const std::string& var, const std::vector<double>& edges,
+                                          const std::string& cut, const std::string& weight,
+                                          const std::vector<std::string>& factors,
+                                          std::vector<std::vector<double> >& replicas,
+                                          std::vector<double>* sumw2 = nullptr);
+
+    /// Fill a ROOT histogram with var (weighted by weight) for the entries passing cut
+    void FillHist(TH1* hist, const std::string& var, const std::string& cut = "", const std::string& weight = "");
+
+    /// Values of var for the entries passing cut
+    std::vector<double> Values(const std::string& var, const std::string& cut = "");
+
+    /// Block callback: first entry, number of entries, values of each expression
+    typedef std::function<void(size_t, size_t, const std::vector<const double*>&)> BlockFunc_t;
+
+    /// Evaluate several expressions in one pass over the tree, block by block
+    bool Scan(const std::vector<std::string>& exprs, BlockFunc_t func);
+
+    /// Selected block callback: number of entries passing the cut, their entry numbers, values of each expression
+    typedef std::function<void(size_t, const Long64_t*, const std::vector<const double*>&)> SelectedBlockFunc_t;
+
+    /// Like Scan, for the entries passing cut only (predicate pushdown): the branches of the cut are
+    /// read for every entry, the other branches of exprs only for the passing entries.
+    /// Works on a TChain: the blocks don't cross the boundaries of its trees.
+    bool ScanSelected(const std::string& cut, const std::vector<std::string>& exprs, SelectedBlockFunc_t func);
+
+  private:
+
+    /// Read the branches needed by exprs block by block, and call func with their values
+    bool Loop(const std::vector<const CutExpression*>& exprs, BlockFunc_t func);
+
+    /// Same for the entries passing cut, reading the branches not used by the cut only for them
+    bool LoopSelected(const CutExpression& cut, const std::vector<const CutExpression*>& exprs, SelectedBlockFunc_t func);
+
+    TTree* _tree;
+    size_t _block_size;
+    std::map<std::string, CutExpression> _defines;
+    bool _ok;
+
+  };
+}
+#endif
+
+/** @} */ // end of doxygen group
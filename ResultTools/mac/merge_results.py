@@ -0,0 +1,32 @@
+import sys
+
+if len(sys.argv) < 3:
+    msg  = '\n'
+    msg += "Usage 1: %s [-j NTHREADS] $OUTPUT_ROOT_FILE $INPUT_ROOT_FILEs\n" % sys.argv[0]
+    msg += '\n'
+    msg += "Merges ana output files of several jobs (IE condor jobs) into one file,\n"
+    msg += "checking that the result trees of all jobs have the same branches,\n"
+    msg += "and adds up the job counters (events seen/kept, weight sums, POT).\n"
+    msg += '\n'
+    sys.stderr.write(msg)
+    sys.exit(1)
+
+from ROOT import gSystem
+from ROOT import lee
+
+args = sys.argv[1:]
+nthreads = 1
+if args[0] == '-j':
+    nthreads = int(args[1])
+    args = args[2:]
+
+merger = lee.ResultMerger()
+merger.SetNThreads(nthreads)
+merger.SetOutputFile(args[0])
+for f in args[1:]:
+    merger.AddInputFile(f)
+
+if not merger.Merge():
+    sys.exit(1)
+
+sys.exit(0)
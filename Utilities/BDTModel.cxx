@@ -0,0 +1,327 @@
+#ifndef LEE_BDTMODEL_CXX
+#define LEE_BDTMODEL_CXX
+
+#include "BDTModel.h"
+#include "TFile.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+ClassImp(lee::util::BDTModel)
+
+namespace lee {
+  namespace util {
+
+    const int BDTModel::kFormatVersion;
+
+    void BDTModel::Reset(const std::vector<std::string>& features, bool logistic, double base_margin)
+    {
+      _format_version = kFormatVersion;
+      _features = features;
+      _logistic = logistic;
+      _base_margin = base_margin;
+      _tree_roots.clear();
+      _node_feature.clear();
+      _node_value.clear();
+      _node_left.clear();
+      _node_default_left.clear();
+      _nodes.clear();
+    }
+
+    bool BDTModel::AddTree(const std::vector<int>& feature, const std::vector<double>& value,
+                           const std::vector<int>& left, const std::vector<int>& right,
+                           const std::vector<char>& default_left)
+    {
+      int n = feature.size();
+      if (!n || (int)value.size() != n || (int)left.size() != n || (int)right.size() != n || (int)default_left.size() != n) {
+        std::cout << "ERROR!! BDTModel: a tree needs the same (non zero) number of features, values, children and defaults"
+                  << std::endl;
+        return false;
+      }
+
+      // breadth first renumbering, the children of a split are stored next to each other
+      std::vector<int> order(1, 0), new_index(n, -1);
+      new_index[0] = 0;
+      for (size_t i = 0; i < order.size(); ++i) {
+        int node = order[i];
+        if (feature[node] < 0) continue;
+        if (feature[node] >= (int)_features.size()) {
+          std::cout << "ERROR!! BDTModel: split on feature " << feature[node] << ", the model has "
+                    << _features.size() << " features" << std::endl;
+          return false;
+        }
+        for (int child : { left[node], right[node] }) {
+          if (child < 0 || child >= n || new_index[child] >= 0) {
+            std::cout << "ERROR!! BDTModel: node " << node << " has an invalid child " << child << std::endl;
+            return false;
+          }
+          new_index[child] = order.size();
+          order.push_back(child);
+        }
+      }
+
+      int offset = _node_feature.size();
+      bool packed = Compiled();
+      _tree_roots.push_back(offset);
+      for (auto node : order) {
+        bool split = feature[node] >= 0;
+        _node_feature.push_back(split ? feature[node] : -1);
+        _node_value.push_back(value[node]);
+        _node_left.push_back(split ? offset + new_index[left[node]] : -1);
+        _node_default_left.push_back(split && default_left[node]);
+      }
+      // pack the new nodes only, unless the previous ones aren't packed either
+      Pack(packed ? offset : 0);
+      return true;
+    }
+
+    bool BDTModel::LoadXGBoostDump(const std::string& filename, const std::vector<std::string>& features,
+                                   bool logistic, double base_margin)
+    {
+      std::ifstream in(filename);
+      if (!in) {
+        std::cout << "ERROR!! BDTModel could not open " << filename << std::endl;
+        return false;
+      }
+      Reset(features, logistic, base_margin);
+
+      std::map<std::string, int> feature_index;
+      for (size_t j = 0; j < features.size(); ++j) feature_index[features[j]] = j;
+
+      // nodes of the current tree, by xgboost node id
+      std::vector<int> feature, left, right;
+      std::vector<double> value;
+      std::vector<char> default_left;
+      auto flush = [&]() {
+        bool ok = feature.empty() || AddTree(feature, value, left, right, default_left);
+        feature.clear(); value.clear(); left.clear(); right.clear(); default_left.clear();
+        return ok;
+      };
+
+      // "booster[i]:", "id:[feature<threshold] yes=l,no=r,missing=m[,gain=..,cover=..]" or "id:leaf=value[,cover=..]"
+      std::string line;
+      size_t line_number = 0;
+      while (std::getline(in, line)) {
+        ++line_number;
+        auto first = line.find_first_not_of(" \t");
+        if (first == std::string::npos) continue;
+        line = line.substr(first);
+        if (line.compare(0, 7, "booster") == 0) {
+          if (!flush()) return false;
+          continue;
+        }
+        auto colon = line.find(':');
+        int id = colon == std::string::npos ? -1 : std::atoi(line.substr(0, colon).c_str());
+        if (id < 0) {
+          std::cout << "ERROR!! BDTModel: cannot read line " << line_number << " of " << filename << ": " << line << std::endl;
+          return false;
+        }
+        if ((int)feature.size() <= id) {
+          feature.resize(id + 1, -1);
+          value.resize(id + 1, 0.);
+          left.resize(id + 1, -1);
+          right.resize(id + 1, -1);
+          default_left.resize(id + 1, 0);
+        }
+
+        std::string rest = line.substr(colon + 1);
+        if (rest.compare(0, 5, "leaf=") == 0) {
+          value[id] = std::atof(rest.c_str() + 5);
+          continue;
+        }
+        auto less = rest.find('<'), bracket = rest.find(']');
+        if (rest.empty() || rest[0] != '[' || less == std::string::npos || bracket == std::string::npos || less > bracket) {
+          std::cout << "ERROR!! BDTModel: cannot read the split of line " << line_number << " of " << filename
+                    << " (only [feature<threshold] splits are supported): " << line << std::endl;
+          return false;
+        }
+        std::string name = rest.substr(1, less - 1);
+        auto it = feature_index.find(name);
+        if (it != feature_index.end()) feature[id] = it->second;
+        else if (name.size() > 1 && name[0] == 'f' && name.find_first_not_of("0123456789", 1) == std::string::npos)
+          feature[id] = std::atoi(name.c_str() + 1);
+        else {
+          std::cout << "ERROR!! BDTModel: unknown feature " << name << " on line " << line_number << " of " << filename << std::endl;
+          return false;
+        }
+        value[id] = std::atof(rest.substr(less + 1, bracket - less - 1).c_str());
+
+        int missing = -1;
+        std::istringstream fields(rest.substr(bracket + 1));
+        std::string field;
+        while (std::getline(fields, field, ',')) {
+          field.erase(0, field.find_first_not_of(" \t"));
+          auto eq = field.find('=');
+          if (eq == std::string::npos) continue;
+          std::string key = field.substr(0, eq);
+          int child = std::atoi(field.c_str() + eq + 1);
+          if (key == "yes") left[id] = child;
+          else if (key == "no") right[id] = child;
+          else if (key == "missing") missing = child;
+        }
+        default_left[id] = missing < 0 || missing == left[id];
+      }
+      if (!flush()) return false;
+      if (_tree_roots.empty()) {
+        std::cout << "ERROR!! BDTModel: no tree in " << filename << std::endl;
+        return false;
+      }
+      Compile();
+      return true;
+    }
+
+    void BDTModel::Compile()
+    {
+      Pack(0);
+    }
+
+    void BDTModel::Pack(size_t first)
+    {
+      _nodes.resize(_node_feature.size());
+      for (size_t i = first; i < _nodes.size(); ++i) {
+        auto& node = _nodes[i];
+        node.feature = _node_feature[i];
+        node.value = _node_value[i];
+        node.left = _node_left[i];
+        node.missing = node.feature < 0 ? -1 : (_node_default_left[i] ? node.left : node.left + 1);
+      }
+    }
+
+    double BDTModel::Margin(const double* x) const
+    {
+      if (!Compiled()) {
+        std::cout << "ERROR!! BDTModel " << GetName() << " is not compiled (call Compile first)" << std::endl;
+        return std::numeric_limits<double>::quiet_NaN();
+      }
+      const Node_t* nodes = _nodes.data();
+      double margin = _base_margin;
+      for (auto root : _tree_roots) {
+        const Node_t* node = nodes + root;
+        while (node->feature >= 0) {
+          double v = x[node->feature];
+          node = nodes + (std::isnan(v) ? node->missing : node->left + ((float)v < node->value ? 0 : 1));
+        }
+        margin += node->value;
+      }
+      return margin;
+    }
+
+    double BDTModel::Score(const double* x) const
+    {
+      double margin = Margin(x);
+      return _logistic ? 1. / (1. + std::exp(-margin)) : margin;
+    }
+
+    double BDTModel::Score(const std::vector<double>& x) const
+    {
+      if (x.size() != _features.size()) {
+        std::cout << "ERROR!! BDTModel: " << x.size() << " values for " << _features.size() << " features" << std::endl;
+        return 0.;
+      }
+      return Score(x.data());
+    }
+
+    void BDTModel::Score(const std::vector<const double*>& columns, size_t n, double* out) const
+    {
+      if (columns.size() != _features.size()) {
+        std::cout << "ERROR!! BDTModel: " << columns.size() << " columns for " << _features.size() << " features" << std::endl;
+        return;
+      }
+      if (!Compiled()) {
+        std::cout << "ERROR!! BDTModel " << GetName() << " is not compiled (call Compile first)" << std::endl;
+        std::fill(out, out + n, std::numeric_limits<double>::quiet_NaN());
+        return;
+      }
+      const Node_t* nodes = _nodes.data();
+
+      // blocks of rows, tree by tree: the nodes of a tree are reused by every row of the block
+      const size_t block = 256;
+      for (size_t first = 0; first < n; first += block) {
+        size_t last = std::min(n, first + block);
+        for (size_t k = first; k < last; ++k) out[k] = _base_margin;
+        for (auto root : _tree_roots) {
+          // eight rows walk down the tree together, their node loads overlap
+          size_t k = first;
+          for (; k + 8 <= last; k += 8) {
+            int idx[8];
+            for (int r = 0; r < 8; ++r) idx[r] = root;
+            bool more = true;
+            while (more) {
+              more = false;
+              for (int r = 0; r < 8; ++r) {
+                const Node_t& node = nodes[idx[r]];
+                if (node.feature < 0) continue;
+                double v = columns[node.feature][k + r];
+                idx[r] = std::isnan(v) ? node.missing : node.left + ((float)v < node.value ? 0 : 1);
+                more = true;
+              }
+            }
+            for (int r = 0; r < 8; ++r) out[k + r] += nodes[idx[r]].value;
+          }
+          for (; k < last; ++k) {
+            const Node_t* node = nodes + root;
+            while (node->feature >= 0) {
+              double v = columns[node->feature][k];
+              node = nodes + (std::isnan(v) ? node->missing : node->left + ((float)v < node->value ? 0 : 1));
+            }
+            out[k] += node->value;
+          }
+        }
+        if (_logistic)
+          for (size_t k = first; k < last; ++k) out[k] = 1. / (1. + std::exp(-out[k]));
+      }
+    }
+
+    bool BDTModel::Save(const std::string& filename, bool update) const
+    {
+      std::unique_ptr<TFile> f(TFile::Open(filename.c_str(), update ? "UPDATE" : "RECREATE"));
+      if (!f || f->IsZombie()) {
+        std::cout << "ERROR!! BDTModel could not open " << filename << std::endl;
+        return false;
+      }
+      f->cd();
+      Write(0, TObject::kOverwrite);
+      f->Close();
+      return true;
+    }
+
+    BDTModel* BDTModel::Load(const std::string& filename, const std::string& name)
+    {
+      std::unique_ptr<TFile> f(TFile::Open(filename.c_str(), "READ"));
+      auto model = f ? dynamic_cast<BDTModel*>(f->Get(name.c_str())) : nullptr;
+      if (!model) {
+        std::cout << "ERROR!! No BDTModel " << name << " in " << filename << std::endl;
+        return nullptr;
+      }
+      if (model->_format_version > kFormatVersion) {
+        std::cout << "ERROR!! BDTModel " << name << " in " << filename << " has format version "
+                  << model->_format_version << ", this code reads up to " << kFormatVersion << std::endl;
+        delete model;
+        return nullptr;
+      }
+      model->Compile();
+      return model;
+    }
+
+    void BDTModel::Print(Option_t*) const
+    {
+      size_t nleaves = std::count(_node_feature.begin(), _node_feature.end(), -1);
+      std::cout << GetName() << " (format version " << _format_version << "): " << _tree_roots.size()
+                << " trees, " << _node_feature.size() - nleaves << " splits, " << nleaves << " leaves, "
+                << (_logistic ? "logistic" : "raw") << " score, base margin " << _base_margin << std::endl;
+      std::vector<size_t> splits(_features.size(), 0);
+      for (auto j : _node_feature)
+        if (j >= 0) ++splits[j];
+      for (size_t j = 0; j < _features.size(); ++j)
+        std::cout << "  " << _features[j] << " : " << splits[j] << " splits" << std::endl;
+    }
+
+  }// end namespace util
+}// end namespace lee
+#endif
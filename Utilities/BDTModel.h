@@ -0,0 +1,136 @@
+/**
+ * \file BDTModel.h
+ *
+ * \ingroup Utilities
+ *
+ * \brief Boosted decision tree discriminant stored as flat node arrays, saved as a versioned ROOT object
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup Utilities
+
+    @{*/
+#ifndef LEE_BDTMODEL_H
+#define LEE_BDTMODEL_H
+
+#include <string>
+#include <vector>
+#include "TNamed.h"
+
+namespace lee {
+  namespace util {
+
+    /**
+       \class BDTModel
+       Ensemble of (gradient boosted) binary decision trees: the margin of a row is
+       base_margin + sum of the leaf values reached in every tree, and its score is
+       sigmoid(margin) for a logistic objective (the margin otherwise).
+       The features x_j are result tree columns (IE "_dist_2wall_vtx", "_vertex_energy",
+       "_dedx", "_flash_time", ...), a split sends a row left if float(x_j) < threshold,
+       and a NaN value along the split's default ("missing") branch, as xgboost does.
+
+       All the trees are stored in flat node arrays (breadth first, the two children of a
+       split are adjacent) and packed into 16 byte nodes for the evaluation. Score(columns)
+       scores blocks of rows tree by tree, so the nodes of one tree stay in cache.
+       LoadXGBoostDump reads the text dump of an xgboost model (Booster.dump_model).
+    */
+    class BDTModel : public TNamed {
+
+    public:
+
+      /// Version of the meaning of the stored fields, written with every model
+      static const int kFormatVersion = 1;
+
+      /// Default constructor
+      BDTModel(const char* name = "bdt_model", const char* title = "boosted decision trees")
+        : TNamed(name, title), _format_version(kFormatVersion), _logistic(true), _base_margin(0.) {}
+
+      /// Default destructor
+      virtual ~BDTModel() {}
+
+      /// Remove all the trees, and set the features and the objective
+      void Reset(const std::vector<std::string>& features, bool logistic = true, double base_margin = 0.);
+
+      /// Append a tree given as node arrays, node 0 is the root. For a split node i, feature[i] is the
+      /// feature index, value[i] the threshold, left[i]/right[i] the children and default_left[i]
+      /// whether NaN goes left. For a leaf, feature[i] = -1 and value[i] is the leaf value.
+      /// Nodes not reachable from the root (IE pruned ids) are dropped. Returns false (and adds
+      /// nothing) if the tree is not valid.
+      bool AddTree(const std::vector<int>& feature, const std::vector<double>& value,
+                   const std::vector<int>& left, const std::vector<int>& right,
+                   const std::vector<char>& default_left);
+
+      /// Read the trees of an xgboost text dump. Features are named "f<index>" or, with a
+      /// feature map, by their name in features. Returns false on error.
+      bool LoadXGBoostDump(const std::string& filename, const std::vector<std::string>& features,
+                           bool logistic = true, double base_margin = 0.);
+
+      const std::vector<std::string>& Features() const { return _features; }
+      int FormatVersion() const { return _format_version; }
+      size_t NFeatures() const { return _features.size(); }
+      size_t NTrees() const { return _tree_roots.size(); }
+      size_t NNodes() const { return _node_feature.size(); }
+      bool Logistic() const { return _logistic; }
+      double BaseMargin() const { return _base_margin; }
+
+      /// base_margin + sum of the leaf values, x: one value per feature
+      double Margin(const double* x) const;
+
+      /// sigmoid(Margin) for a logistic objective, Margin otherwise
+      double Score(const double* x) const;
+      double Score(const std::vector<double>& x) const;
+
+      /// Score n rows given column-wise (one array of n values per feature, IE the blocks of
+      /// TreeCutEvaluator::Scan) into out
+      void Score(const std::vector<const double*>& columns, size_t n, double* out) const;
+
+      /// Pack the nodes for the evaluation. AddTree, LoadXGBoostDump and Load do it; a model read
+      /// from a file otherwise (IE TFile::Get) must be compiled before it is scored. The scoring
+      /// methods only read the packed nodes, so a compiled model can be shared between threads.
+      void Compile();
+
+      /// Whether the packed nodes are up to date (the scoring methods fail otherwise)
+      bool Compiled() const { return _nodes.size() == _node_feature.size(); }
+
+      /// Write to a ROOT file (recreated, or updated if update). Returns false on error.
+      bool Save(const std::string& filename, bool update = false) const;
+
+      /// Read a model from a ROOT file (nullptr on error, the caller owns it)
+      static BDTModel* Load(const std::string& filename, const std::string& name = "bdt_model");
+
+      void Print(Option_t* option = "") const;
+
+    private:
+
+      /// Pack the nodes from first on (the ones before are packed already)
+      void Pack(size_t first);
+
+      /// Evaluation node: a leaf has feature = -1 and its value in value
+      struct Node_t {
+        int feature;
+        float value;   ///< threshold of a split, or leaf value
+        int left;      ///< left child (the right one is left + 1)
+        int missing;   ///< child of a NaN value
+      };
+
+      int _format_version;
+      std::vector<std::string> _features;
+      bool _logistic;
+      double _base_margin;
+
+      /// Flat node arrays of all the trees
+      std::vector<int> _tree_roots;
+      std::vector<int> _node_feature;
+      std::vector<float> _node_value;
+      std::vector<int> _node_left;
+      std::vector<char> _node_default_left;
+
+      std::vector<Node_t> _nodes; //!
+
+      ClassDef(BDTModel, 1)
+    };
+  }// end namespace util
+}// end namespace lee
+#endif
+/** @} */ // end of doxygen group
@@ -0,0 +1,76 @@
+#ifndef LEE_COUNTERRNG_CXX
+#define LEE_COUNTERRNG_CXX
+
+#include "CounterRNG.h"
+#include <cmath>
+
+namespace lee {
+  namespace util {
+
+    void CounterRNG::SetKey(uint64_t run, uint64_t subrun, uint64_t event, uint64_t stream)
+    {
+      // Chain the ids through the mixing function so that nearby ids give unrelated keys
+      _key = Hash(0, run);
+      _key = Hash(_key, subrun);
+      _key = Hash(_key, event);
+      _key = Hash(_key, stream);
+      _counter = 0;
+    }
+
+    size_t CounterRNG::Integer(size_t n)
+    {
+      if (n <= 1) return 0;
+      // Reject the top partial block of [0,2^64) so every value is equally likely
+      uint64_t limit = UINT64_MAX - (UINT64_MAX % n + 1) % n;
+      uint64_t r = Next();
+      while (r > limit) r = Next();
+      return r % n;
+    }
+
+    double CounterRNG::Gaus(double mean, double sigma)
+    {
+      // Box-Muller (one of the two numbers is dropped, so the result only depends on the counter)
+      double u1 = 1. - Uniform(); // (0,1]
+      double u2 = Uniform();
+      return mean + sigma * std::sqrt(-2. * std::log(u1)) * std::cos(2. * M_PI * u2);
+    }
+
+    unsigned int CounterRNG::Poisson(double mean)
+    {
+      if (mean <= 0) return 0;
+
+      // Normal approximation for large means
+      if (mean > 50.) {
+        double x = Gaus(mean, std::sqrt(mean));
+        return x < 0 ? 0 : (unsigned int)(x + 0.5);
+      }
+
+      // Knuth's multiplication method
+      double l = std::exp(-mean);
+      double p = Uniform();
+      unsigned int k = 0;
+      while (p > l) {
+        p *= Uniform();
+        ++k;
+      }
+      return k;
+    }
+
+    unsigned int CounterRNG::PoissonInversion(double mean)
+    {
+      if (mean <= 0) return 0;
+      double u = Uniform();
+      double p = std::exp(-mean), cdf = p;
+      unsigned int k = 0;
+      // the p > 0 check stops at the end of the representable tail
+      while (u >= cdf && p > 0.) {
+        ++k;
+        p *= mean / k;
+        cdf += p;
+      }
+      return k;
+    }
+
+  }// end namespace util
+}// end namespace lee
+#endif
@@ -0,0 +1,100 @@
+/**
+ * \file CounterRNG.h
+ *
+ * \ingroup Utilities
+ *
+ * \brief Stateless counter-based random numbers keyed by (run, subrun, event, stream)
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup Utilities
+
+    @{*/
+#ifndef LEE_COUNTERRNG_H
+#define LEE_COUNTERRNG_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace lee {
+  namespace util {
+
+    /// Stream ids, so that different modules using the same event never share random numbers
+    enum RNGStream_t {
+      kDefaultStream = 0,
+      kCosmicTriggerStream,   ///< CosmicTriggerHacker trigger time choice
+      kCosmicOversampleStream,///< ERAnaLowEnergyExcess cosmic oversampling replicas
+      kBootstrapStream,       ///< bootstrap replica weights
+      kToyStream,             ///< pseudo-experiments / toys
+      kCosmicOverlayStream    ///< CosmicOverlayMixer cosmic event choice
+    };
+
+    /**
+       \class CounterRNG
+       Counter-based random number source: the n-th number of a stream is a pure function
+       Hash(key, n), where the key is made from (run, subrun, event, stream id).
+       Nothing is shared between instances and the result doesn't depend on which events
+       were processed before, so sharded/multi-threaded/re-ordered runs give bit-identical
+       results. The mixing function is the SplitMix64 finalizer.
+    */
+    class CounterRNG {
+
+    public:
+
+      /// Default constructor
+      CounterRNG(uint64_t run = 0, uint64_t subrun = 0, uint64_t event = 0, uint64_t stream = kDefaultStream)
+      { SetKey(run, subrun, event, stream); }
+
+      /// Default destructor
+      ~CounterRNG() {}
+
+      /// Re-key the generator (also resets the counter to 0)
+      void SetKey(uint64_t run, uint64_t subrun, uint64_t event, uint64_t stream = kDefaultStream);
+
+      /// Current key / counter
+      uint64_t Key() const { return _key; }
+      uint64_t Counter() const { return _counter; }
+
+      /// Jump to the n-th number of the stream
+      void SetCounter(uint64_t n) { _counter = n; }
+
+      /// The n-th 64 bit random number for a given key (stateless)
+      static uint64_t Hash(uint64_t key, uint64_t n)
+      {
+        uint64_t z = key + (n + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+      }
+
+      /// Next 64 bit random number
+      uint64_t Next() { return Hash(_key, _counter++); }
+
+      /// Uniform in [0,1)
+      double Uniform() { return (Next() >> 11) * (1. / 9007199254740992.); }
+
+      /// Uniform integer in [0,n) (n > 0), without modulo bias
+      size_t Integer(size_t n);
+
+      /// Gaussian random number
+      double Gaus(double mean = 0., double sigma = 1.);
+
+      /// Poisson random number
+      unsigned int Poisson(double mean);
+
+      /// Poisson random number from exactly one uniform (inversion of the CDF), so the n-th number
+      /// of a stream doesn't depend on the previous ones. For small means (IE the Poisson(1)
+      /// bootstrap weights), the cost grows with the mean.
+      unsigned int PoissonInversion(double mean);
+
+    private:
+
+      uint64_t _key;
+      uint64_t _counter;
+
+    };
+  }// end namespace util
+}// end namespace lee
+#endif
+/** @} */ // end of doxygen group
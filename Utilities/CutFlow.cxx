@@ -0,0 +1,140 @@
+#ifndef LEE_CUTFLOW_CXX
+#define LEE_CUTFLOW_CXX
+
+#include "CutFlow.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+ClassImp(lee::util::CutFlow)
+
+namespace lee {
+  namespace util {
+
+    CutFlow& CutFlow::Shared()
+    {
+      static CutFlow shared;
+      return shared;
+    }
+
+    void CutFlow::WriteShared(TDirectory* dir)
+    {
+      if (!dir) return;
+      dir->cd();
+      Shared().Write(0, TObject::kOverwrite);
+    }
+
+    int CutFlow::Find(const std::string& stage) const
+    {
+      for (size_t i = 0; i < _stages.size(); ++i)
+        if (_stages[i] == stage) return i;
+      return -1;
+    }
+
+    size_t CutFlow::Index(const std::string& stage)
+    {
+      int i = Find(stage);
+      if (i >= 0) return i;
+      _stages.push_back(stage);
+      _n.push_back(0.);
+      _sumw.push_back(0.);
+      _sumw2.push_back(0.);
+      // (cut flows written before version 2 have no weighted flags)
+      _weighted.resize(_stages.size(), 0);
+      return _stages.size() - 1;
+    }
+
+    void CutFlow::AddStage(const std::string& stage, bool weighted)
+    {
+      size_t i = Index(stage);
+      if (weighted) _weighted[i] = 1;
+    }
+
+    void CutFlow::Fill(const std::string& stage, double weight)
+    {
+      size_t i = Index(stage);
+      _n[i] += 1.;
+      _sumw[i] += weight;
+      _sumw2[i] += weight * weight;
+    }
+
+    void CutFlow::Reset()
+    {
+      _stages.clear();
+      _n.clear();
+      _sumw.clear();
+      _sumw2.clear();
+      _weighted.clear();
+    }
+
+    double CutFlow::N(const std::string& stage) const
+    {
+      int i = Find(stage);
+      return i < 0 ? 0. : _n[i];
+    }
+
+    double CutFlow::SumW(const std::string& stage) const
+    {
+      int i = Find(stage);
+      return i < 0 ? 0. : _sumw[i];
+    }
+
+    double CutFlow::SumW2(const std::string& stage) const
+    {
+      int i = Find(stage);
+      return i < 0 ? 0. : _sumw2[i];
+    }
+
+    bool CutFlow::Weighted(const std::string& stage) const
+    {
+      int i = Find(stage);
+      return i >= 0 && i < (int)_weighted.size() && _weighted[i];
+    }
+
+    double CutFlow::Efficiency(const std::string& stage, bool relative_to_first) const
+    {
+      int i = Find(stage);
+      if (i <= 0) return i < 0 ? 0. : 1.;
+      size_t j = relative_to_first ? 0 : i - 1;
+      // a weight sum over a count would mix the event weight into the efficiency
+      bool weighted = Weighted(_stages[i]) && Weighted(_stages[j]);
+      double numerator = weighted ? _sumw[i] : _n[i];
+      double denominator = weighted ? _sumw[j] : _n[j];
+      return denominator ? numerator / denominator : 0.;
+    }
+
+    Long64_t CutFlow::Merge(TCollection* list)
+    {
+      if (!list) return 0;
+      TIter next(list);
+      while (TObject* obj = next()) {
+        auto other = dynamic_cast<CutFlow*>(obj);
+        if (!other) continue;
+        for (size_t j = 0; j < other->_stages.size(); ++j) {
+          size_t i = Index(other->_stages[j]);
+          _n[i] += other->_n[j];
+          _sumw[i] += other->_sumw[j];
+          _sumw2[i] += other->_sumw2[j];
+          if (other->Weighted(other->_stages[j])) _weighted[i] = 1;
+        }
+      }
+      return 1;
+    }
+
+    void CutFlow::Print(Option_t*) const
+    {
+      std::cout << GetName() << ":" << std::endl
+                << "  " << std::setw(24) << std::left << "stage"
+                << std::right << std::setw(12) << "events" << std::setw(14) << "sum weight"
+                << std::setw(14) << "err" << std::setw(10) << "eff" << std::setw(10) << "cum eff" << std::endl;
+      for (size_t i = 0; i < _stages.size(); ++i)
+        std::cout << "  " << std::setw(24) << std::left << _stages[i]
+                  << std::right << std::setw(12) << _n[i] << std::setw(14) << _sumw[i]
+                  << std::setw(14) << std::sqrt(_sumw2[i])
+                  << std::setw(10) << Efficiency(_stages[i])
+                  << std::setw(10) << Efficiency(_stages[i], true) << std::endl;
+    }
+
+  }// end namespace util
+}// end namespace lee
+#endif
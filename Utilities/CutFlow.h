@@ -0,0 +1,102 @@
+/**
+ * \file CutFlow.h
+ *
+ * \ingroup Utilities
+ *
+ * \brief Ordered selection stages with unweighted and weighted counts, that add up when merged
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup Utilities
+
+    @{*/
+#ifndef LEE_CUTFLOW_H
+#define LEE_CUTFLOW_H
+
+#include <string>
+#include <vector>
+#include "TNamed.h"
+#include "TCollection.h"
+#include "TDirectory.h"
+
+namespace lee {
+  namespace util {
+
+    /**
+       \class CutFlow
+       Number of events, sum of weights and sum of squared weights surviving each stage of the
+       selection (IE "all events", filter passed, "nue reconstructed", "electron found",
+       "MC match found"), in the order the stages are applied.
+       The modules of one job share the instance returned by Shared(): each one declares its
+       stages in initialize/ProcessBegin (in pipeline order), fills them event by event and
+       writes the shared "cut_flow" in finalize/ProcessEnd (overwriting the copy written by the
+       previous module), so the output holds one cut flow covering the whole chain.
+       Merge adds the stages with the same name, so merged outputs (ResultMerger, hadd) give
+       the efficiencies of the whole sample without a second pass.
+       Only the stages declared weighted (the ERTool ones, where the flux/LEE weight is known)
+       are filled with weights: the filters before them count events. An efficiency uses the
+       weights when both of its stages are weighted, and the counts otherwise.
+    */
+    class CutFlow : public TNamed {
+
+    public:
+
+      /// Default constructor
+      CutFlow(const char* name = "cut_flow", const char* title = "cut flow")
+        : TNamed(name, title) {}
+
+      /// Default destructor
+      virtual ~CutFlow() {}
+
+      /// The instance shared by all modules of this process
+      static CutFlow& Shared();
+
+      /// Write the shared instance to dir (if any), replacing the copy written by a previous module
+      static void WriteShared(TDirectory* dir);
+
+      /// Declare a stage after the existing ones (no-op if it exists), filled with event weights if weighted
+      void AddStage(const std::string& stage, bool weighted = false);
+
+      /// Count one event surviving a stage (created after the existing ones if needed)
+      void Fill(const std::string& stage, double weight = 1.);
+
+      /// Remove all stages
+      void Reset();
+
+      const std::vector<std::string>& Stages() const { return _stages; }
+
+      /// Unweighted count, sum of weights and sum of squared weights of a stage (0 if it doesn't exist)
+      double N(const std::string& stage) const;
+      double SumW(const std::string& stage) const;
+      double SumW2(const std::string& stage) const;
+
+      /// Whether a stage is filled with event weights (false if it doesn't exist)
+      bool Weighted(const std::string& stage) const;
+
+      /// Efficiency of a stage relative to the previous one (or to the first one),
+      /// weighted if both stages are, from the counts otherwise
+      double Efficiency(const std::string& stage, bool relative_to_first = false) const;
+
+      /// Called by ROOT (hadd, TClass::GetMerge) to merge cut flows of other jobs into this one
+      Long64_t Merge(TCollection* list);
+
+      void Print(Option_t* option = "") const;
+
+    private:
+
+      size_t Index(const std::string& stage);
+      int Find(const std::string& stage) const;
+
+      std::vector<std::string> _stages;
+      std::vector<double> _n;
+      std::vector<double> _sumw;
+      std::vector<double> _sumw2;
+      std::vector<char> _weighted;
+
+      ClassDef(CutFlow, 2)
+    };
+  }// end namespace util
+}// end namespace lee
+#endif
+/** @} */ // end of doxygen group
@@ -0,0 +1,61 @@
+#ifndef LEE_JOBCOUNTERS_CXX
+#define LEE_JOBCOUNTERS_CXX
+
+#include "JobCounters.h"
+#include <iostream>
+#include <iomanip>
+
+ClassImp(lee::util::JobCounters)
+
+namespace lee {
+  namespace util {
+
+    size_t JobCounters::Index(const std::string& key)
+    {
+      for (size_t i = 0; i < _keys.size(); ++i)
+        if (_keys[i] == key) return i;
+      _keys.push_back(key);
+      _values.push_back(0.);
+      return _keys.size() - 1;
+    }
+
+    void JobCounters::Add(const std::string& key, double value)
+    {
+      _values[Index(key)] += value;
+    }
+
+    void JobCounters::Set(const std::string& key, double value)
+    {
+      _values[Index(key)] = value;
+    }
+
+    double JobCounters::Get(const std::string& key) const
+    {
+      for (size_t i = 0; i < _keys.size(); ++i)
+        if (_keys[i] == key) return _values[i];
+      return 0.;
+    }
+
+    Long64_t JobCounters::Merge(TCollection* list)
+    {
+      if (!list) return 0;
+      TIter next(list);
+      while (TObject* obj = next()) {
+        auto other = dynamic_cast<JobCounters*>(obj);
+        if (!other) continue;
+        for (size_t i = 0; i < other->_keys.size(); ++i)
+          Add(other->_keys[i], other->_values[i]);
+      }
+      return 1;
+    }
+
+    void JobCounters::Print(Option_t*) const
+    {
+      std::cout << GetName() << ":" << std::endl;
+      for (size_t i = 0; i < _keys.size(); ++i)
+        std::cout << "  " << std::setw(24) << std::left << _keys[i] << " " << _values[i] << std::endl;
+    }
+
+  }// end namespace util
+}// end namespace lee
+#endif
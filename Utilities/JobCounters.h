@@ -0,0 +1,71 @@
+/**
+ * \file JobCounters.h
+ *
+ * \ingroup Utilities
+ *
+ * \brief Named per-job counters (events seen, events kept, weight sums, POT...) that add up when merged
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup Utilities
+
+    @{*/
+#ifndef LEE_JOBCOUNTERS_H
+#define LEE_JOBCOUNTERS_H
+
+#include <string>
+#include <vector>
+#include "TNamed.h"
+#include "TCollection.h"
+
+namespace lee {
+  namespace util {
+
+    /**
+       \class JobCounters
+       A bag of named counters written once per job next to the result trees.
+       Merge adds the counters with the same name, so merging the outputs of many jobs
+       (ResultMerger, hadd) gives the totals for the whole sample (IE total events seen and
+       POT for the normalization) without recounting. Set n_jobs to 1 to count merged jobs.
+    */
+    class JobCounters : public TNamed {
+
+    public:
+
+      /// Default constructor
+      JobCounters(const char* name = "job_counters", const char* title = "job counters")
+        : TNamed(name, title) {}
+
+      /// Default destructor
+      virtual ~JobCounters() {}
+
+      /// Add value to a counter (created at 0 if it doesn't exist)
+      void Add(const std::string& key, double value);
+
+      /// Set a counter
+      void Set(const std::string& key, double value);
+
+      /// Counter value (0 if it doesn't exist)
+      double Get(const std::string& key) const;
+
+      const std::vector<std::string>& Keys() const { return _keys; }
+
+      /// Called by ROOT (hadd, TClass::GetMerge) to merge counters of other jobs into this one
+      Long64_t Merge(TCollection* list);
+
+      void Print(Option_t* option = "") const;
+
+    private:
+
+      size_t Index(const std::string& key);
+
+      std::vector<std::string> _keys;
+      std::vector<double> _values;
+
+      ClassDef(JobCounters, 1)
+    };
+  }// end namespace util
+}// end namespace lee
+#endif
+/** @} */ // end of doxygen group
@@ -0,0 +1,68 @@
+#ifndef LEE_LEETOPOLOGY_CXX
+#define LEE_LEETOPOLOGY_CXX
+
+#include "LEETopology.h"
+#include <cstdlib>
+
+namespace lee {
+  namespace util {
+
+    bool LEETopology::Passes(const ::larlite::mctruth& truth)
+    {
+      //Enforce that there is exactly 1 electron, above 20MeV kinetic energy
+      //Don't care about neutrons, protons.
+      //Don't care about other particles if they are below 20MeV KE
+      size_t n_electrons = 0;
+
+      for (auto const& particle : truth.GetParticles()) {
+
+        // Only particles with status code 1 are relevant
+        if ( particle.StatusCode() != 1 ) continue;
+
+        //Note: this KE is in units of GEV!
+        double KE = particle.Trajectory().at(0).E() - particle.Mass();
+
+        //Don't care about any particles with less than 20 MeV KE
+        if ( KE < 0.02 ) continue;
+
+        //Count up the number of electrons, skip all events with > 1.5 GeV electron
+        //Also skip events with < 100 MeV electron since they will get zero weight
+        // (out of energy range we care about... LEERW weights only computed from 0.1 to 2 GEV)
+        if ( abs(particle.PdgCode()) == 11 ) {
+          n_electrons++;
+          if ( KE > 1.5 || KE < 0.1 )
+            return false;
+        }
+
+        // 22  => gammas
+        // 211 => charged pions
+        // 111 => pi0s
+        // 13  => muons
+        // 321 => kaons
+        if ( abs(particle.PdgCode()) == 22  ||
+             abs(particle.PdgCode()) == 211 ||
+             abs(particle.PdgCode()) == 111 ||
+             abs(particle.PdgCode()) == 13  ||
+             abs(particle.PdgCode()) == 321 )
+          return false;
+      }
+
+      return n_electrons == 1;
+    }
+
+    LEETopology& LEETopology::Shared()
+    {
+      static LEETopology shared;
+      return shared;
+    }
+
+    void LEETopology::Fill(bool passed)
+    {
+      ++_n_events;
+      if (passed) ++_n_passed;
+      _passed = passed;
+    }
+
+  }// end namespace util
+}// end namespace lee
+#endif
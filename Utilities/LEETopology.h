@@ -0,0 +1,71 @@
+/**
+ * \file LEETopology.h
+ *
+ * \ingroup Utilities
+ *
+ * \brief LEE signal truth topology of an event, shared by the modules of a job
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup Utilities
+
+    @{*/
+#ifndef LEE_LEETOPOLOGY_H
+#define LEE_LEETOPOLOGY_H
+
+#include <cstddef>
+#include "DataFormat/mctruth.h"
+
+namespace lee {
+  namespace util {
+
+    /**
+       \class LEETopology
+       Whether the truth interaction has the LEE signal topology: among the status 1 mctruth
+       particles, exactly one electron (100 MeV < KE < 1.5 GeV) and no gamma, charged or neutral
+       pion, muon or kaon above 20 MeV KE (the MC_LEE_Filter requirements).
+       MC_LEE_Filter records the decision for every event it sees in the instance returned by
+       Shared(), so a module later in the chain (ERAnaLowEnergyExcess in LEE weight column mode)
+       knows the topology of the current event and the number of topology events of the job,
+       counted before any other filter.
+    */
+    class LEETopology {
+
+    public:
+
+      /// Default constructor
+      LEETopology() { Reset(); }
+
+      /// Default destructor
+      virtual ~LEETopology() {}
+
+      /// Whether the truth interaction has the LEE signal topology
+      static bool Passes(const ::larlite::mctruth& truth);
+
+      /// The instance shared by all modules of this process
+      static LEETopology& Shared();
+
+      void Reset() { _n_events = 0; _n_passed = 0; _passed = false; }
+
+      /// Record the decision for the current event
+      void Fill(bool passed);
+
+      /// Decision for the current (last filled) event
+      bool Passed() const { return _passed; }
+
+      /// Number of events recorded, and of those with the LEE topology
+      size_t NEvents() const { return _n_events; }
+      size_t NPassed() const { return _n_passed; }
+
+    private:
+
+      size_t _n_events;
+      size_t _n_passed;
+      bool _passed;
+
+    };
+  }// end namespace util
+}// end namespace lee
+#endif
+/** @} */ // end of doxygen group
@@ -12,6 +12,13 @@
 #pragma link C++ class lee::util::HistManip+;
 #pragma link C++ class lee::util::PlotReader+;
 #pragma link C++ class lee::util::ECCQECalculator+;
+#pragma link C++ class lee::util::CounterRNG+;
+#pragma link C++ enum lee::util::RNGStream_t;
+#pragma link C++ class lee::util::JobCounters+;
+#pragma link C++ class lee::util::CutFlow+;
+#pragma link C++ class lee::util::LogisticModel+;
+#pragma link C++ class lee::util::BDTModel+;
+#pragma link C++ class lee::util::LEETopology+;
 
 //ADD_NEW_CLASS ... do not change this line
 #endif
@@ -0,0 +1,108 @@
+#ifndef LEE_LOGISTICMODEL_CXX
+#define LEE_LOGISTICMODEL_CXX
+
+#include "LogisticModel.h"
+#include "TFile.h"
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <cmath>
+
+ClassImp(lee::util::LogisticModel)
+
+namespace lee {
+  namespace util {
+
+    const int LogisticModel::kFormatVersion;
+
+    void LogisticModel::Set(const std::vector<std::string>& features, const std::vector<double>& means,
+                            const std::vector<double>& stds, const std::vector<double>& theta)
+    {
+      if (means.size() != features.size() || stds.size() != features.size() || theta.size() != features.size() + 1) {
+        std::cout << "ERROR!! LogisticModel: " << features.size() << " features need as many means and stds, and "
+                  << features.size() + 1 << " coefficients" << std::endl;
+        return;
+      }
+      _format_version = kFormatVersion;
+      _features = features;
+      _means = means;
+      _stds = stds;
+      _theta = theta;
+    }
+
+    void LogisticModel::SetTrainingInfo(double l2, double cost, size_t n_rows, size_t iterations)
+    {
+      _l2 = l2;
+      _cost = cost;
+      _n_rows = n_rows;
+      _iterations = iterations;
+    }
+
+    double LogisticModel::LogOdds(const double* x) const
+    {
+      if (_theta.empty()) return 0.;
+      double z = _theta[0];
+      for (size_t j = 0; j < _features.size(); ++j)
+        z += _theta[j + 1] * (x[j] - _means[j]) / _stds[j];
+      return z;
+    }
+
+    double LogisticModel::Probability(const double* x) const
+    {
+      return 1. / (1. + std::exp(-LogOdds(x)));
+    }
+
+    double LogisticModel::Probability(const std::vector<double>& x) const
+    {
+      if (x.size() != _features.size()) {
+        std::cout << "ERROR!! LogisticModel: " << x.size() << " values for " << _features.size() << " features" << std::endl;
+        return 0.;
+      }
+      return Probability(x.data());
+    }
+
+    bool LogisticModel::Save(const std::string& filename, bool update) const
+    {
+      std::unique_ptr<TFile> f(TFile::Open(filename.c_str(), update ? "UPDATE" : "RECREATE"));
+      if (!f || f->IsZombie()) {
+        std::cout << "ERROR!! LogisticModel could not open " << filename << std::endl;
+        return false;
+      }
+      f->cd();
+      Write(0, TObject::kOverwrite);
+      f->Close();
+      return true;
+    }
+
+    LogisticModel* LogisticModel::Load(const std::string& filename, const std::string& name)
+    {
+      std::unique_ptr<TFile> f(TFile::Open(filename.c_str(), "READ"));
+      auto model = f ? dynamic_cast<LogisticModel*>(f->Get(name.c_str())) : nullptr;
+      if (!model) {
+        std::cout << "ERROR!! No LogisticModel " << name << " in " << filename << std::endl;
+        return nullptr;
+      }
+      if (model->_format_version > kFormatVersion) {
+        std::cout << "ERROR!! LogisticModel " << name << " in " << filename << " has format version "
+                  << model->_format_version << ", this code reads up to " << kFormatVersion << std::endl;
+        delete model;
+        return nullptr;
+      }
+      return model;
+    }
+
+    void LogisticModel::Print(Option_t*) const
+    {
+      std::cout << GetName() << " (format version " << _format_version << "): "
+                << _n_rows << " training rows, L2 " << _l2 << ", cost " << _cost
+                << " after " << _iterations << " iterations" << std::endl;
+      if (!_theta.empty())
+        std::cout << "  " << std::setw(24) << std::left << "intercept" << " theta " << _theta[0] << std::endl;
+      for (size_t j = 0; j < _features.size(); ++j)
+        std::cout << "  " << std::setw(24) << std::left << _features[j] << " theta " << _theta[j + 1]
+                  << " (mean " << _means[j] << ", std " << _stds[j] << ")" << std::endl;
+    }
+
+  }// end namespace util
+}// end namespace lee
+#endif
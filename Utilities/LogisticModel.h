@@ -0,0 +1,94 @@
+/**
+ * \file LogisticModel.h
+ *
+ * \ingroup Utilities
+ *
+ * \brief Logistic regression discriminant (IE cosmic vs nue), saved as a versioned ROOT object
+ *
+ * @author kaleko
+ */
+
+/** \addtogroup Utilities
+
+    @{*/
+#ifndef LEE_LOGISTICMODEL_H
+#define LEE_LOGISTICMODEL_H
+
+#include <string>
+#include <vector>
+#include "TNamed.h"
+
+namespace lee {
+  namespace util {
+
+    /**
+       \class LogisticModel
+       Probability that a row is signal, sigmoid(theta_0 + sum_j theta_j * (x_j - mean_j) / std_j),
+       for the features x_j (expressions of the result tree columns, IE "_nu_pt/_nu_p", "_y_vtx")
+       standardized with the means/standard deviations of the training rows.
+       Trained by lee::LogisticTrainer and written to a ROOT file with the format version and
+       how it was trained; Load refuses models written by a newer format.
+    */
+    class LogisticModel : public TNamed {
+
+    public:
+
+      /// Version of the meaning of the stored fields, written with every model
+      static const int kFormatVersion = 1;
+
+      /// Default constructor
+      LogisticModel(const char* name = "logistic_model", const char* title = "logistic regression model")
+        : TNamed(name, title), _format_version(kFormatVersion), _l2(0.), _cost(0.), _n_rows(0), _iterations(0) {}
+
+      /// Default destructor
+      virtual ~LogisticModel() {}
+
+      /// Set the features, their standardization and the coefficients (theta[0] is the intercept)
+      void Set(const std::vector<std::string>& features, const std::vector<double>& means,
+               const std::vector<double>& stds, const std::vector<double>& theta);
+
+      /// Record how the model was trained
+      void SetTrainingInfo(double l2, double cost, size_t n_rows, size_t iterations);
+
+      const std::vector<std::string>& Features() const { return _features; }
+      const std::vector<double>& Means() const { return _means; }
+      const std::vector<double>& Stds() const { return _stds; }
+      const std::vector<double>& Theta() const { return _theta; }
+      int FormatVersion() const { return _format_version; }
+      size_t NFeatures() const { return _features.size(); }
+
+      /// theta_0 + sum_j theta_j * (x_j - mean_j) / std_j, x: one value per feature
+      double LogOdds(const double* x) const;
+
+      /// Signal probability, sigmoid(LogOdds)
+      double Probability(const double* x) const;
+      double Probability(const std::vector<double>& x) const;
+
+      /// Write to a ROOT file (recreated, or updated if update). Returns false on error.
+      bool Save(const std::string& filename, bool update = false) const;
+
+      /// Read a model from a ROOT file (nullptr on error, the caller owns it)
+      static LogisticModel* Load(const std::string& filename, const std::string& name = "logistic_model");
+
+      void Print(Option_t* option = "") const;
+
+    private:
+
+      int _format_version;
+      std::vector<std::string> _features;
+      std::vector<double> _means;
+      std::vector<double> _stds;
+      std::vector<double> _theta;
+
+      /// Training info
+      double _l2;
+      double _cost;
+      Long64_t _n_rows;
+      int _iterations;
+
+      ClassDef(LogisticModel, 1)
+    };
+  }// end namespace util
+}// end namespace lee
+#endif
+/** @} */ // end of doxygen group
@@ -0,0 +1,279 @@
+/**
+ * \file singleE_driver.cxx
+ *
+ * \brief Compiled replacement for the scripts/singleE_*_selection.py run scripts
+ *
+ * Builds the same ana_processor pipeline as the python scripts
+ * (sample filter -> early veto -> ERTool selection with the singleE algorithm chain
+ * and ERAnaLowEnergyExcess) from one fcllite job config, without python.
+ *
+ * Usage: singleE_driver JOB_CONFIG.fcl [-s START_ENTRY] [-n NEVENTS] [-o OUTPUT_FILE] [-i INPUT_FILE ...]
+ * The command line options override the corresponding config values
+ * (so one config can be split into shards over entries or files).
+ * See bin/cfg/ for example job configs.
+ *
+ * @author kaleko
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "TSystem.h"
+#include "TClass.h"
+#include "TMethodCall.h"
+
+#include "FhiclLite/ConfigManager.h"
+#include "Analysis/ana_processor.h"
+#include "ERToolBackend/ExampleERSelection.h"
+
+#include "EventCounter.h"
+#include "MC_CCnue_Filter.h"
+#include "MC_CCnumu_Filter.h"
+#include "MC_NC_Filter.h"
+#include "MC_dirt_Filter.h"
+#include "MC_cosmic_Filter.h"
+#include "MC_cosmicoutoftime_Filter.h"
+#include "MC_LEE_Filter.h"
+#include "EarlyVetoFilter.h"
+#include "CosmicOverlayMixer.h"
+#include "ERAnaLowEnergyExcess.h"
+
+namespace {
+
+  /// Expand $ENV_VARS in a path
+  std::string ExpandPath(const std::string& path)
+  {
+    TString s(path.c_str());
+    gSystem->ExpandPathName(s);
+    return std::string(s.Data());
+  }
+
+  template <class T>
+  T GetOr(const ::fcllite::PSet& cfg, const std::string& key, const T& def)
+  {
+    return cfg.contains_value(key) ? cfg.get<T>(key) : def;
+  }
+
+  /// Sample filter, as in the per-sample python scripts (nullptr if the sample has none)
+  ::larlite::ana_base* MakeSampleFilter(const std::string& sample, const ::fcllite::PSet& cfg)
+  {
+    if (sample == "nue")   return new ::larlite::MC_CCnue_Filter();
+    if (sample == "numu")  return new ::larlite::MC_CCnumu_Filter();
+    if (sample == "nc")    return new ::larlite::MC_NC_Filter();
+    if (sample == "dirt")  return new ::larlite::MC_dirt_Filter();
+    if (sample == "cosmic") return new ::larlite::MC_cosmic_Filter();
+    if (sample == "lee")   return new ::larlite::MC_LEE_Filter();
+    if (sample == "cosmicoutoftime") {
+      auto filter = new ::larlite::MC_cosmicoutoftime_Filter();
+      filter->SetInTimeWindow(GetOr<double>(cfg, "InTimeStart", 3100.),
+                              GetOr<double>(cfg, "InTimeEnd", 4700.));
+      return filter;
+    }
+    if (sample == "overlay") return nullptr;
+    throw std::runtime_error("Unknown sample type: " + sample);
+  }
+
+  /// Instantiate an ERTool algorithm from its config block:
+  /// { Class: "ertool::ERAlgoXXX" Calls: ["SetSomething(1.)", ...] }
+  /// The algorithm is created through its ROOT dictionary, so any algorithm
+  /// available to PyROOT can be used without adding a header here.
+  ::ertool::AlgoBase* MakeAlgo(const std::string& label, const ::fcllite::PSet& cfg)
+  {
+    auto const class_name = cfg.get<std::string>("Class");
+    TClass* cls = TClass::GetClass(class_name.c_str());
+    if (!cls || !cls->InheritsFrom("ertool::AlgoBase"))
+      throw std::runtime_error("Algorithm " + label + ": " + class_name + " is not a known ertool::AlgoBase");
+
+    void* obj = cls->New();
+
+    for (auto const& call : GetOr<std::vector<std::string> >(cfg, "Calls", std::vector<std::string>())) {
+      auto open = call.find('(');
+      auto close = call.rfind(')');
+      if (open == std::string::npos || close == std::string::npos || close < open)
+        throw std::runtime_error("Algorithm " + label + ": can't parse call " + call);
+      TMethodCall method(cls, call.substr(0, open).c_str(), call.substr(open + 1, close - open - 1).c_str());
+      if (!method.IsValid())
+        throw std::runtime_error("Algorithm " + label + ": no method for call " + call);
+      method.Execute(obj);
+    }
+
+    return (::ertool::AlgoBase*)cls->DynamicCast(TClass::GetClass("ertool::AlgoBase"), obj);
+  }
+
+  void Usage(const char* exe)
+  {
+    std::cerr << std::endl
+              << "Usage: " << exe << " JOB_CONFIG.fcl [-s START_ENTRY] [-n NEVENTS] [-o OUTPUT_FILE] [-i INPUT_FILE ...]"
+              << std::endl << std::endl;
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  // Command line overrides
+  size_t start = 0;
+  size_t nevents = 0;
+  std::string output_override;
+  std::vector<std::string> input_override;
+  for (int i = 2; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "-s" && i + 1 < argc) start = std::strtoul(argv[++i], nullptr, 10);
+    else if (arg == "-n" && i + 1 < argc) nevents = std::strtoul(argv[++i], nullptr, 10);
+    else if (arg == "-o" && i + 1 < argc) output_override = argv[++i];
+    else if (arg == "-i") {
+      while (i + 1 < argc && argv[i + 1][0] != '-') input_override.push_back(argv[++i]);
+    }
+    else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+
+  ::fcllite::ConfigManager cfg_mgr("singleE_driver");
+
+  try {
+
+    cfg_mgr.AddCfgFile(argv[1]);
+    auto const& job = cfg_mgr.Config().get_pset("SingleESelection");
+
+    auto const sample  = job.get<std::string>("Sample");
+    auto const use_reco = GetOr<bool>(job, "UseReco", false);
+    auto const ecut = GetOr<double>(job, "Ecut", 10.);
+
+    auto inputs = input_override.empty() ? job.get<std::vector<std::string> >("InputFiles") : input_override;
+    auto output = output_override.empty() ? job.get<std::string>("OutputFile") : output_override;
+
+    // ana_processor
+    ::larlite::ana_processor my_proc;
+    my_proc.enable_filter(true);
+    for (auto const& f : inputs) my_proc.add_input_file(ExpandPath(f));
+
+    auto const larlite_out = GetOr<std::string>(job, "LarliteOutputFile", "");
+    if (larlite_out.empty())
+      my_proc.set_io_mode(::larlite::storage_manager::kREAD);
+    else {
+      my_proc.set_io_mode(::larlite::storage_manager::kBOTH);
+      my_proc.set_output_file(ExpandPath(larlite_out));
+    }
+    my_proc.set_ana_output_file(ExpandPath(output).c_str());
+
+    // count every event read by this job (job_counters: n_events_seen, pot)
+    auto counter = new ::larlite::EventCounter();
+    counter->SetPOTPerEvent(GetOr<double>(job, "POTPerEvent", 0.));
+    my_proc.add_process(counter);
+
+    // LEE truth topology of every event, before any filter (LEE weight column mode, see ERAnaLowEnergyExcess)
+    auto const& ana_cfg = job.get_pset("Ana");
+    if (GetOr<bool>(ana_cfg, "LEEWeightColumn", false)) {
+      auto tagger = new ::larlite::MC_LEE_Filter();
+      tagger->SetTagOnly(true);
+      my_proc.add_process(tagger);
+    }
+
+    // sample filter
+    auto filter = MakeSampleFilter(sample, job);
+    if (filter) my_proc.add_process(filter);
+
+    // cosmic overlay (overlay sample only)
+    if (sample == "overlay") {
+      auto mixer = new ::larlite::CosmicOverlayMixer();
+      for (auto const& f : job.get<std::vector<std::string> >("CosmicFiles"))
+        mixer->AddCosmicFile(ExpandPath(f));
+      my_proc.add_process(mixer);
+    }
+
+    // early veto (see GetEarlyVetoInstance in scripts/singleE_config.py)
+    if (GetOr<bool>(job, "EarlyVeto", true)) {
+      auto veto = new ::larlite::EarlyVetoFilter();
+      if (use_reco) veto->SetShowerProducer(false, "recoemu");
+      else          veto->SetShowerProducer(true, "mcreco");
+      veto->SetMinShowerEnergy(ecut);
+      veto->SetFlashProducer("opflashSat");
+      veto->SetRequireBeamFlash(GetOr<bool>(job, "RequireBeamFlash", true));
+      veto->SetBeamWindow(0., 10.);
+      veto->SetMinFlashPE(10.);
+      my_proc.add_process(veto);
+    }
+
+    // ERTool selection (see GetERSelectionInstance in scripts/singleE_config.py)
+    auto anaunit = new ::larlite::ExampleERSelection();
+    if (use_reco) {
+      anaunit->SetShowerProducer(false, "recoemu");
+      anaunit->SetTrackProducer(false, "recoemu");
+    }
+    else {
+      anaunit->SetShowerProducer(true, "mcreco");
+      anaunit->SetTrackProducer(true, "mcreco");
+    }
+    anaunit->SetFlashProducer("opflashSat");
+    // cosmic oversampling shifts the flash times only, it needs the x shift disabled
+    bool const disable_x_shift = GetOr<bool>(job, "DisableXShift", false);
+    anaunit->setDisableXShift(disable_x_shift);
+
+    // the algorithm chain lives in its own file (AlgoConfigFile) so all samples share it
+    ::fcllite::ConfigManager algo_cfg_mgr("singleE_algos");
+    algo_cfg_mgr.AddCfgFile(ExpandPath(job.get<std::string>("AlgoConfigFile")));
+    auto const& algos = algo_cfg_mgr.Config().get_pset("SingleEAlgos");
+    // the setters of the python selection (seltool *Def.py instances) are only in a generated config
+    if (!algos.contains_value("GeneratedFrom"))
+      throw std::runtime_error(job.get<std::string>("AlgoConfigFile") + " was not generated from the python selection:"
+                               " run scripts/make_singleE_algos_fcl.py where seltool is installed");
+    auto const& algo_cfg = algos.get_pset("Algos");
+    for (auto const& label : algos.get<std::vector<std::string> >("AlgoOrder"))
+      anaunit->_mgr.AddAlgo(*(MakeAlgo(label, algo_cfg.get_pset(label))));
+
+    anaunit->_mgr._profile_mode = GetOr<bool>(job, "ProfileMode", true);
+    anaunit->_mgr.ClearCfgFile();
+    for (auto const& f : job.get<std::vector<std::string> >("ERToolCfgFiles"))
+      anaunit->_mgr.AddCfgFile(ExpandPath(f));
+
+    // analysis module
+    auto LEEana = new ::ertool::ERAnaLowEnergyExcess();
+    LEEana->SetTreeName(ana_cfg.get<std::string>("TreeName"));
+    if (GetOr<bool>(ana_cfg, "LEESampleMode", false) || GetOr<bool>(ana_cfg, "LEEWeightColumn", false)) {
+      LEEana->SetLEESampleMode(GetOr<bool>(ana_cfg, "LEESampleMode", false));
+      LEEana->SetLEEWeightColumnMode(GetOr<bool>(ana_cfg, "LEEWeightColumn", false));
+      // LEE weight column mode normalizes at plot time, only a LEE sample needs its filtered event count
+      if (GetOr<bool>(ana_cfg, "LEESampleMode", false))
+        LEEana->SetLEENEvents(ana_cfg.get<size_t>("LEENEvents"));
+      LEEana->SetLEEFilename(ExpandPath(ana_cfg.get<std::string>("LEEFilename")));
+      LEEana->SetLEECorrHistName(ana_cfg.get<std::string>("LEECorrHistName"));
+    }
+    LEEana->SetCosmicOversampling(GetOr<size_t>(ana_cfg, "CosmicOversampling", 1));
+    LEEana->SetXShiftDisabled(disable_x_shift);
+    LEEana->SetBootstrapReplicas(GetOr<size_t>(ana_cfg, "BootstrapReplicas", 0));
+    // discriminant scored at fill time (_discriminant), optionally cutting the rows below DiscriminantCut
+    auto const discriminant = GetOr<std::string>(ana_cfg, "DiscriminantModel", "");
+    if (!discriminant.empty()) {
+      LEEana->SetDiscriminantModel(ExpandPath(discriminant), GetOr<std::string>(ana_cfg, "DiscriminantName", ""));
+      if (ana_cfg.contains_value("DiscriminantCut"))
+        LEEana->SetDiscriminantCut(ana_cfg.get<double>("DiscriminantCut"));
+    }
+    anaunit->_mgr.AddAna(*LEEana);
+
+    anaunit->SetMinEDep(ecut);
+    anaunit->_mgr._mc_for_ana = true;
+
+    my_proc.add_process(anaunit);
+
+    my_proc.run(start, nevents);
+
+  }
+  catch (const std::exception& e) {
+    std::cerr << "singleE_driver: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << std::endl << "Finished running ana_processor event loop!" << std::endl << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,312 @@
+/**
+ * \file singleE_runner.cxx
+ *
+ * \brief Runs one singleE_driver job config as N local worker processes and merges the result
+ *
+ * The events of the job's input are split into N contiguous entry ranges, one per
+ * singleE_driver worker (ana_processor::run(start, n)). Splitting by entry range instead of by
+ * file keeps the mcinfo/opreco files of the same events together. Each worker writes its own
+ * shard output and log; when all of them succeeded, the shards are merged with lee::ResultMerger
+ * (with tree schema checks) into the job's output file and removed.
+ *
+ * The output records which input files (path + MD5 checksum) contributed to it (lee::InputLedger).
+ * With -u, only the input files that are not in the existing output's ledger are processed,
+ * and their rows/histograms/counters are merged into the existing output. Files come in
+ * mcinfo/opreco groups, so the new files of an update must hold complete events.
+ * The checksums read every input once more. An update needs them before starting the workers;
+ * otherwise they are computed (by one thread) while the workers run, so they only add to the
+ * wall time when reading the inputs takes longer than processing them.
+ *
+ * Usage: singleE_runner JOB_CONFIG.fcl [-j NWORKERS] [-o OUTPUT_FILE] [-k] [-u]
+ *   -k keeps the shard outputs and logs after merging
+ *   -u incremental update of an existing output with the new input files only
+ *
+ * @author kaleko
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <thread>
+#include <future>
+#include <memory>
+
+#include "TSystem.h"
+#include "TString.h"
+#include "TFile.h"
+
+#include "FhiclLite/ConfigManager.h"
+#include "DataFormat/storage_manager.h"
+#include "ResultMerger.h"
+#include "InputLedger.h"
+
+namespace {
+
+  std::string ExpandPath(const std::string& path)
+  {
+    TString s(path.c_str());
+    gSystem->ExpandPathName(s);
+    return std::string(s.Data());
+  }
+
+  void Usage(const char* exe)
+  {
+    std::cerr << std::endl
+              << "Usage: " << exe << " JOB_CONFIG.fcl [-j NWORKERS] [-o OUTPUT_FILE] [-k] [-u]"
+              << std::endl << std::endl;
+  }
+
+  /// Start one singleE_driver worker on [start, start+n), stdout/stderr go to log
+  pid_t StartWorker(const std::string& driver, const std::string& cfg,
+                    size_t start, size_t n, const std::string& output, const std::string& log,
+                    const std::vector<std::string>& inputs)
+  {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+      dup2(fd, STDOUT_FILENO);
+      dup2(fd, STDERR_FILENO);
+      close(fd);
+    }
+    auto s_start = std::to_string(start);
+    auto s_n = std::to_string(n);
+    std::vector<const char*> args = { driver.c_str(), cfg.c_str(),
+                                      "-s", s_start.c_str(), "-n", s_n.c_str(), "-o", output.c_str(), "-i" };
+    for (auto const& f : inputs) args.push_back(f.c_str());
+    args.push_back(nullptr);
+    execv(driver.c_str(), (char* const*)args.data());
+    // only reached if exec failed
+    perror("singleE_runner: exec of singleE_driver failed");
+    _exit(127);
+  }
+
+  /// MD5 checksums of the files, computed by nthreads threads
+  std::vector<std::string> Checksums(const std::vector<std::string>& files, size_t nthreads)
+  {
+    std::vector<std::string> sums(files.size());
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < nthreads; ++t)
+      workers.emplace_back([t, nthreads, &files, &sums]() {
+        for (size_t i = t; i < files.size(); i += nthreads)
+          sums[i] = ::lee::InputLedger::Checksum(files[i]);
+      });
+    for (auto& w : workers) w.join();
+    return sums;
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  size_t nworkers = sysconf(_SC_NPROCESSORS_ONLN);
+  std::string output_override;
+  bool keep_shards = false;
+  bool update = false;
+  for (int i = 2; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "-j" && i + 1 < argc) nworkers = std::strtoul(argv[++i], nullptr, 10);
+    else if (arg == "-o" && i + 1 < argc) output_override = argv[++i];
+    else if (arg == "-k") keep_shards = true;
+    else if (arg == "-u") update = true;
+    else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  if (!nworkers) nworkers = 1;
+
+  std::string cfg_file(argv[1]);
+  ::fcllite::ConfigManager cfg_mgr("singleE_runner");
+  cfg_mgr.AddCfgFile(cfg_file);
+  auto const& job = cfg_mgr.Config().get_pset("SingleESelection");
+
+  if (job.contains_value("LarliteOutputFile") && !job.get<std::string>("LarliteOutputFile").empty()) {
+    std::cerr << "singleE_runner: LarliteOutputFile is not supported (all workers would write the same file)" << std::endl;
+    return 1;
+  }
+
+  auto const output = ExpandPath(output_override.empty() ? job.get<std::string>("OutputFile") : output_override);
+
+  std::vector<std::string> all_inputs;
+  for (auto const& f : job.get<std::vector<std::string> >("InputFiles"))
+    all_inputs.push_back(ExpandPath(f));
+
+  // In update mode, the ledger of the existing output tells what was already processed
+  ::lee::InputLedger old_ledger;
+  bool have_old = false;
+  if (update && !gSystem->AccessPathName(output.c_str())) {
+    std::unique_ptr<TFile> fold(TFile::Open(output.c_str(), "READ"));
+    auto ledger = fold ? dynamic_cast< ::lee::InputLedger* >(fold->Get("input_ledger")) : nullptr;
+    if (!ledger) {
+      std::cerr << "singleE_runner: " << output << " has no input ledger, can't update it" << std::endl;
+      return 1;
+    }
+    old_ledger = *ledger;
+    have_old = true;
+  }
+
+  // When updating, only process the input files that are not in the ledger yet
+  // (otherwise every input is processed, and the checksums are only needed for the ledger, see below)
+  std::vector<std::string> checksums;
+  std::vector<std::string> inputs;
+  if (have_old) {
+    checksums = Checksums(all_inputs, nworkers);
+    for (size_t i = 0; i < all_inputs.size(); ++i) {
+      if (checksums[i].empty()) {
+        std::cerr << "singleE_runner: could not read " << all_inputs[i] << std::endl;
+        return 1;
+      }
+      if (old_ledger.Contains(all_inputs[i], checksums[i])) continue;
+      if (old_ledger.ContainsPath(all_inputs[i])) {
+        std::cerr << "singleE_runner: " << all_inputs[i] << " changed since it was processed, "
+                  << "rerun without -u" << std::endl;
+        return 1;
+      }
+      inputs.push_back(all_inputs[i]);
+    }
+  }
+  else
+    inputs = all_inputs;
+  if (inputs.empty()) {
+    std::cout << "singleE_runner: no new input files, " << output << " is up to date" << std::endl;
+    return 0;
+  }
+  if (have_old)
+    std::cout << "singleE_runner: " << inputs.size() << " new input files (of " << all_inputs.size() << ")" << std::endl;
+
+  // Count the events of the job
+  ::larlite::storage_manager sm;
+  sm.set_io_mode(::larlite::storage_manager::kREAD);
+  for (auto const& f : inputs)
+    sm.add_in_filename(f);
+  if (!sm.open()) {
+    std::cerr << "singleE_runner: could not open the input files" << std::endl;
+    return 1;
+  }
+  size_t nentries = sm.get_entries();
+  sm.close();
+
+  if (nworkers > nentries) nworkers = nentries ? nentries : 1;
+
+  // The driver is expected next to this executable
+  std::string driver = std::string(gSystem->DirName(argv[0])) + "/singleE_driver";
+
+  std::cout << "singleE_runner: " << nentries << " events on " << nworkers << " workers" << std::endl;
+
+  std::vector<pid_t> pids;
+  std::vector<std::string> shard_outputs;
+  std::vector<std::string> shard_logs;
+  size_t start = 0;
+  for (size_t k = 0; k < nworkers; ++k) {
+    size_t n = nentries / nworkers + (k < nentries % nworkers ? 1 : 0);
+    shard_outputs.push_back(output + Form(".shard%zu.root", k));
+    shard_logs.push_back(output + Form(".shard%zu.log", k));
+    pid_t pid = StartWorker(driver, cfg_file, start, n, shard_outputs.back(), shard_logs.back(), inputs);
+    if (pid < 0) {
+      perror("singleE_runner: fork failed");
+      return 1;
+    }
+    pids.push_back(pid);
+    start += n;
+  }
+
+  // Checksums of the ledger, while the workers run (started after the forks)
+  std::future<std::vector<std::string> > pending_checksums;
+  if (!have_old)
+    pending_checksums = std::async(std::launch::async, Checksums, std::cref(inputs), 1);
+
+  // Supervise the workers
+  bool all_ok = true;
+  for (size_t k = 0; k < pids.size(); ++k) {
+    int status = 0;
+    waitpid(pids[k], &status, 0);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) continue;
+    all_ok = false;
+    if (WIFSIGNALED(status))
+      std::cerr << "singleE_runner: worker " << k << " killed by signal " << WTERMSIG(status);
+    else
+      std::cerr << "singleE_runner: worker " << k << " exited with status " << WEXITSTATUS(status);
+    std::cerr << " (see " << shard_logs[k] << ")" << std::endl;
+  }
+  if (pending_checksums.valid()) checksums = pending_checksums.get();
+  if (!all_ok) {
+    std::cerr << "singleE_runner: not merging, shard outputs are kept" << std::endl;
+    return 1;
+  }
+
+  // Ledger of the processed input files
+  ::lee::InputLedger new_ledger;
+  for (size_t i = 0; i < all_inputs.size(); ++i) {
+    if (have_old && old_ledger.Contains(all_inputs[i], checksums[i])) continue;
+    if (checksums[i].empty()) {
+      std::cerr << "singleE_runner: could not read " << all_inputs[i] << " for its checksum, "
+                << "not merging, shard outputs are kept" << std::endl;
+      return 1;
+    }
+    new_ledger.Add(all_inputs[i], checksums[i]);
+  }
+
+  // Merge the shards (into a separate file first when updating an existing output)
+  std::string merged = have_old ? output + ".new.root" : output;
+  ::lee::ResultMerger merger;
+  for (auto const& f : shard_outputs) merger.AddInputFile(f);
+  merger.SetOutputFile(merged);
+  merger.SetNThreads(nworkers);
+  if (!merger.Merge()) {
+    std::cerr << "singleE_runner: merge failed, shard outputs are kept" << std::endl;
+    return 1;
+  }
+  {
+    std::unique_ptr<TFile> fmerged(TFile::Open(merged.c_str(), "UPDATE"));
+    if (!fmerged || fmerged->IsZombie()) {
+      std::cerr << "singleE_runner: could not open " << merged << " to write the input ledger, shard outputs are kept" << std::endl;
+      return 1;
+    }
+    fmerged->cd();
+    if (new_ledger.Write(0, TObject::kOverwrite) <= 0) {
+      std::cerr << "singleE_runner: could not write the input ledger to " << merged << ", shard outputs are kept" << std::endl;
+      return 1;
+    }
+    fmerged->Close();
+  }
+
+  // Fold the new results into the existing output
+  if (have_old) {
+    std::string tmp = output + ".tmp.root";
+    ::lee::ResultMerger update_merger;
+    update_merger.AddInputFile(output);
+    update_merger.AddInputFile(merged);
+    update_merger.SetOutputFile(tmp);
+    if (!update_merger.Merge()) {
+      std::cerr << "singleE_runner: merge into " << output << " failed, new results are in " << merged << std::endl;
+      return 1;
+    }
+    if (gSystem->Rename(tmp.c_str(), output.c_str()) != 0) {
+      std::cerr << "singleE_runner: could not replace " << output << " by " << tmp
+                << ", new results are in " << merged << std::endl;
+      return 1;
+    }
+    gSystem->Unlink(merged.c_str());
+  }
+
+  if (!keep_shards) {
+    for (auto const& f : shard_outputs) gSystem->Unlink(f.c_str());
+    for (auto const& f : shard_logs) gSystem->Unlink(f.c_str());
+  }
+
+  std::cout << "singleE_runner: merged output is " << output << std::endl;
+
+  return 0;
+}
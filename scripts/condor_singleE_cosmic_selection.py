@@ -10,7 +10,7 @@ if len(sys.argv) < 2:
 from ROOT import gSystem
 from ROOT import larlite as fmwk
 from ROOT import ertool
-from singleE_config import GetERSelectionInstance
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
 
 # Create ana_processor instance
 my_proc = fmwk.ana_processor()
@@ -67,6 +67,7 @@ anaunit._mgr.AddAna(LEEana)
 # Add MC filter and analysis unit
 # to the process to be run
 
+my_proc.add_process(GetEventCounterInstance())
 my_proc.add_process(eventfilter)
 #Add reco emulator if necessary!
 if use_reco:
@@ -75,6 +76,8 @@ if use_reco:
     print "USING RECO EMULATOR. CONFIG FILE USED FOR EMULATOR IS %s"%emulator_cfg
     my_proc.add_process(emulator)
 
+# in-time cosmic flash times are hacked to the beam gate later, so don't require a beam flash here
+my_proc.add_process(GetEarlyVetoInstance(use_reco, require_beam_flash=False))
 my_proc.add_process(anaunit)
 
 my_proc.run()
@@ -10,7 +10,7 @@ if len(sys.argv) < 2:
 from ROOT import gSystem
 from ROOT import larlite as fmwk
 from ROOT import ertool
-from singleE_config import GetERSelectionInstance
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
 
 # Create ana_processor instance
 my_proc = fmwk.ana_processor()
@@ -41,6 +41,10 @@ print "%s output file = %s"%(sys.argv[0],outfile)
 my_proc.set_ana_output_file(outfile)
 my_proc.set_output_file(outfile[:-5]+'_larlite_out.root')
 
+#out-of-time cosmic truth filter (same time window/origin requirement as stack_plotter.py)
+eventfilter = fmwk.MC_cosmicoutoftime_Filter()
+eventfilter.SetInTimeWindow(3100,4700)
+
 LEEana = ertool.ERAnaLowEnergyExcess()
 LEEana.SetTreeName("cosmicOutOfTime")
 #LEEana.SetDebug(False)
@@ -60,6 +64,8 @@ anaunit._mgr.AddAna(LEEana)
 # Add MC filter and analysis unit
 # to the process to be run
 
+my_proc.add_process(GetEventCounterInstance())
+my_proc.add_process(eventfilter)
 #Add reco emulator if necessary!
 if use_reco:
     emulator = fmwk.EmuDriver()
@@ -67,6 +73,7 @@ if use_reco:
     print "USING RECO EMULATOR. CONFIG FILE USED FOR EMULATOR IS %s"%emulator_cfg
     my_proc.add_process(emulator)
 
+my_proc.add_process(GetEarlyVetoInstance(use_reco))
 my_proc.add_process(anaunit)
 
 my_proc.run()
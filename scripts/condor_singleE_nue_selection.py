@@ -10,7 +10,7 @@ if len(sys.argv) < 2:
 from ROOT import gSystem
 from ROOT import larlite as fmwk
 from ROOT import ertool
-from singleE_config import GetERSelectionInstance
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
 
 # Create ana_processor instance
 my_proc = fmwk.ana_processor()
@@ -44,9 +44,18 @@ my_proc.set_output_file(outfile[:-5]+'_larlite_out.root')
 #nueCC beam
 eventfilter = fmwk.MC_CCnue_Filter()
 
+# Records the LEE truth topology of every event (keeping them all) for the LEE weight column,
+# before any other filter so that n_LEE_topology_evts counts every generated event
+leetagger = fmwk.MC_LEE_Filter()
+leetagger.SetTagOnly(True)
+
 LEEana = ertool.ERAnaLowEnergyExcess()
 LEEana.SetTreeName("beamNuE")
 #LEEana.SetDebug(False)
+# The scaled signal is the "_lee_weight" column of this sample (see singleE_nue_selection.py)
+LEEana.SetLEEWeightColumnMode(True)
+LEEana.SetLEEFilename(os.environ['LARLITE_USERDEVDIR']+'/LowEnergyExcess/LEEReweight/source/LEE_Reweight_plots.root')
+LEEana.SetLEECorrHistName('initial_evis_uz_corr')
 
 anaunit = GetERSelectionInstance()
 anaunit._mgr.ClearCfgFile()
@@ -63,6 +72,8 @@ anaunit._mgr.AddAna(LEEana)
 # Add MC filter and analysis unit
 # to the process to be run
 
+my_proc.add_process(GetEventCounterInstance())
+my_proc.add_process(leetagger)
 my_proc.add_process(eventfilter)
 #Add reco emulator if necessary!
 if use_reco:
@@ -71,6 +82,7 @@ if use_reco:
     print "USING RECO EMULATOR. CONFIG FILE USED FOR EMULATOR IS %s"%emulator_cfg
     my_proc.add_process(emulator)
 
+my_proc.add_process(GetEarlyVetoInstance(use_reco))
 my_proc.add_process(anaunit)
 
 my_proc.run()
@@ -10,7 +10,7 @@ if len(sys.argv) < 2:
 from ROOT import gSystem
 from ROOT import larlite as fmwk
 from ROOT import ertool
-from singleE_config import GetERSelectionInstance
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
 
 # Create ana_processor instance
 my_proc = fmwk.ana_processor()
@@ -63,6 +63,7 @@ anaunit._mgr.AddAna(LEEana)
 # Add MC filter and analysis unit
 # to the process to be run
 
+my_proc.add_process(GetEventCounterInstance())
 my_proc.add_process(eventfilter)
 #Add reco emulator if necessary!
 if use_reco:
@@ -71,6 +72,7 @@ if use_reco:
     print "USING RECO EMULATOR. CONFIG FILE USED FOR EMULATOR IS %s"%emulator_cfg
     my_proc.add_process(emulator)
 
+my_proc.add_process(GetEarlyVetoInstance(use_reco))
 my_proc.add_process(anaunit)
 
 my_proc.run()
@@ -42,6 +42,56 @@ def optimizeTheta(mytheta,myX,myy,mylambda=0.):
 	result = optimize.fmin(computeCost, x0=mytheta, args=(myX, myy, mylambda), maxiter=400, full_output=True)
 	return result[0], result[1]
 
+#Compiled alternative to optimizeTheta: lee.LogisticTrainer minimizes the same cost (with its analytic
+#gradient, by L-BFGS) directly on the result trees, with any features that are expressions of the tree columns.
+#samples is a list of (filename, treename, label), label 1 for nue and 0 for cosmic.
+#The model (coefficients and feature standardization, see lee::util::LogisticModel) is saved to modelfile.
+#To score it in ERAnaLowEnergyExcess (DiscriminantModel), the features must be result tree branches.
+def trainCompiled(samples, features = ['_nu_pt_over_p', '_y_vtx'], mylambda = 0., \
+		cut = '_nu_pt_over_p > 0 and _nu_pt_over_p <= 1', modelfile = 'logistic_model.root', nthreads = 4):
+	from ROOT import lee
+	trainer = lee.LogisticTrainer()
+	for feature in features:
+		trainer.AddFeature(feature)
+	for filename, treename, label in samples:
+		trainer.AddSample(filename, treename, label, cut)
+	trainer.SetL2(mylambda)
+	trainer.SetNThreads(nthreads)
+	if not trainer.Train():
+		print "WARNING: LogisticTrainer did not converge!"
+	model = trainer.Model()
+	model.Print()
+	model.Save(modelfile)
+	return np.array(model.Theta())
+
+#Boosted decision trees instead of the linear model: convert the text dump of an xgboost model trained
+#(in python) on the result tree columns to a lee::util::BDTModel, saved to modelfile. It can then be used by
+#ERAnaLowEnergyExcess (DiscriminantModel) or scoreCompiled. The features must be in the training order.
+default_bdt_features = ['_dist_2wall_vtx', '_dist_2wall_shr', '_vertex_energy', '_dedx', '_flash_time', '_summed_flash_PE']
+def convertXGBoost(dumpfile, features = default_bdt_features, modelfile = 'bdt_model.root', logistic = True):
+	from ROOT import lee, std
+	names = std.vector('string')()
+	for feature in features:
+		names.push_back(feature)
+	model = lee.util.BDTModel()
+	if not model.LoadXGBoostDump(dumpfile, names, logistic):
+		return None
+	model.Print()
+	model.Save(modelfile)
+	return model
+
+#Scores of a finished result tree (entries passing cut) with a saved model (lee::util::BDTModel or LogisticModel)
+def scoreCompiled(filename, treename, modelfile = 'bdt_model.root', modelname = 'bdt_model', cut = ''):
+	from ROOT import lee
+	if modelname.startswith('logistic'):
+		model = lee.util.LogisticModel.Load(modelfile, modelname)
+	else:
+		model = lee.util.BDTModel.Load(modelfile, modelname)
+	if not model:
+		return None
+	scorer = lee.DiscriminantScorer(model)
+	return np.array(scorer.Scores(filename, treename, cut))
+
 def computeHypothesis(dfs,input_theta=None):
 	""" 
 	Input is a(n) (ordered) dictionary of dataframes as described in the header
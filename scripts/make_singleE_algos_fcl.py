@@ -0,0 +1,129 @@
+import sys
+import os
+
+# Writes the singleE algorithm chain config of bin/singleE_driver (bin/cfg/singleE_algos.fcl)
+# from the python configuration itself: AddERSelectionAlgos (singleE_config.py) is run with
+# every ertool class replaced by a recorder, so each algorithm added to the manager and every
+# setter called on it (including the ones in the seltool *Def.py instances) end up in the fcl.
+# Run it (where seltool is installed, not on the worker nodes) whenever singleE_config.py or
+# seltool change, and commit the output:
+#   python make_singleE_algos_fcl.py [OUTPUT_FCL]
+
+import singleE_config
+import seltool.ccsingleeDef
+import seltool.primaryfinderDef
+import seltool.trackpidDef
+import seltool.trackDresserDef
+import seltool.primarycosmicDef
+import seltool.pi0algDef
+
+# labels of the algorithms in the fcl (the class name without ERAlgo otherwise)
+labels = { 'ERAlgoTagEmulatedDeletionsCosmic' : 'TagDeletions',
+	   'ERAlgoShowerPrePrune'             : 'PrePrune',
+	   'ERAlgoTrackDresser'               : 'TrackDresser',
+	   'ERAlgoPi0'                        : 'Pi0',
+	   'ERAlgoCRPrimary'                  : 'CRPrimary',
+	   'ERAlgoCRSecondary'                : 'CRSecondary',
+	   'ERAlgoCROrphan'                   : 'CROrphan',
+	   'ERAlgoPrimaryFinder'              : 'Primary',
+	   'ERAlgoCCSingleE'                  : 'CCSingleE',
+	   'ERAlgoFlashMatch'                 : 'FlashMatch' }
+
+# one setter argument as TMethodCall (singleE_driver MakeAlgo) reads it
+def FormatArg(arg):
+	if isinstance(arg,bool):
+		return 'true' if arg else 'false'
+	if isinstance(arg,(int,long)):
+		return str(arg)
+	if isinstance(arg,float):
+		return repr(arg)
+	raise TypeError('argument %s of type %s can not be written to the fcl (numbers and bools only)' % (repr(arg),type(arg).__name__))
+
+# Records the constructor and the setter calls of an ertool algorithm
+class RecordedAlgo(object):
+
+	def __init__(self, class_name, args):
+		if args:
+			raise TypeError('ertool::%s is constructed with arguments %s, MakeAlgo only uses the default constructor' % (class_name,repr(args)))
+		self.__dict__['_class_name'] = class_name
+		self.__dict__['_calls'] = []
+
+	def __getattr__(self, name):
+		if name.startswith('_'):
+			raise AttributeError(name)
+		def call(*args):
+			self._calls.append('%s(%s)' % (name,','.join([FormatArg(a) for a in args])))
+		return call
+
+	def __setattr__(self, name, value):
+		raise AttributeError('ertool::%s.%s is assigned directly, only setter calls can be written to the fcl' % (self._class_name,name))
+
+# Stands for the ROOT ertool namespace in the python configuration modules
+class RecordingNamespace(object):
+
+	def __getattr__(self, name):
+		if name.startswith('_'):
+			raise AttributeError(name)
+		return lambda *args: RecordedAlgo(name,args)
+
+# Stands for the ertool.Manager given to AddERSelectionAlgos
+class RecordingManager(object):
+
+	def __init__(self):
+		self.algos = []
+
+	def AddAlgo(self, algo):
+		if not isinstance(algo,RecordedAlgo):
+			raise TypeError('AddAlgo with %s, not an ertool algorithm' % repr(algo))
+		self.algos.append(algo)
+
+def WriteFcl(algos, out):
+
+	names = []
+	for algo in algos:
+		label = labels.get(algo._class_name, algo._class_name.replace('ERAlgo',''))
+		if label in names:
+			raise ValueError('two algorithms are labeled %s' % label)
+		names.append(label)
+
+	width = max([len(n) for n in names]) + 1
+	out.write('#\n')
+	out.write('# singleE algorithm chain of bin/singleE_driver, in the order of AddERSelectionAlgos (scripts/singleE_config.py).\n')
+	out.write('# GENERATED by scripts/make_singleE_algos_fcl.py from singleE_config.py and the seltool *Def.py\n')
+	out.write('# instances it uses: do not edit, run the script again when either changes.\n')
+	out.write('# Each block is { Class: <ROOT class name> Calls: [<setter calls with numeric/bool arguments>] }.\n')
+	out.write('# Algorithm parameters not set here come from the ERTool cfg files (ERToolCfgFiles).\n')
+	out.write('#\n')
+	out.write('SingleEAlgos: {\n\n')
+	out.write('  GeneratedFrom: "%s"\n\n' % os.path.dirname(os.path.abspath(seltool.ccsingleeDef.__file__)))
+	out.write('  AlgoOrder: [ %s ]\n\n' % ', '.join(names))
+	out.write('  Algos: {\n')
+	for label, algo in zip(names,algos):
+		out.write('    %s{ Class: "ertool::%s"' % ((label+':').ljust(width+1),algo._class_name))
+		if algo._calls:
+			out.write('\n    %s  Calls: [ %s ]' % (' '*(width+1),', '.join(['"%s"' % c for c in algo._calls])))
+		out.write(' }\n')
+	out.write('  }\n\n')
+	out.write('}\n')
+
+if __name__ == '__main__':
+
+	outname = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(os.path.abspath(__file__)),'..','bin','cfg','singleE_algos.fcl')
+
+	recorder = RecordingNamespace()
+	for module in [ singleE_config,
+			seltool.ccsingleeDef,
+			seltool.primaryfinderDef,
+			seltool.trackpidDef,
+			seltool.trackDresserDef,
+			seltool.primarycosmicDef,
+			seltool.pi0algDef ]:
+		module.ertool = recorder
+
+	mgr = RecordingManager()
+	singleE_config.AddERSelectionAlgos(mgr)
+
+	out = open(outname,'w')
+	WriteFcl(mgr.algos,out)
+	out.close()
+	print 'Wrote %d algorithms to %s' % (len(mgr.algos),outname)
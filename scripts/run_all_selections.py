@@ -39,5 +39,7 @@ if dirt_files: os.system('python singleE_dirt_selection.py %s %s %s'%('reco' if
 if bnb_files: os.system('python singleE_nc_selection.py %s %s %s'%('reco' if _use_reco else 'mc',bnb_files,output_dir))
 if bnb_files: os.system('python singleE_nue_selection.py %s %s %s'%('reco' if _use_reco else 'mc',bnb_files,output_dir))
 if bnb_files: os.system('python singleE_numu_selection.py %s %s %s'%('reco' if _use_reco else 'mc',bnb_files,output_dir))
-if lee_files: os.system('python singleE_LEE_selection.py %s %s %s'%('reco' if _use_reco else 'mc',lee_files,output_dir))
+# The LEE weight is now stored as the "_lee_weight" column of the nue selection,
+# so the separate LEE selection job is only needed for a dedicated LEE sample (uncomment below)
+#if lee_files: os.system('python singleE_LEE_selection.py %s %s %s'%('reco' if _use_reco else 'mc',lee_files,output_dir))
 print "run_all_selections total time duration is",datetime.datetime.now()-starttime
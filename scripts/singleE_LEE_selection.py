@@ -17,7 +17,7 @@ if sys.argv[1] not in ['reco','mc']:
 from ROOT import gSystem
 from ROOT import larlite as fmwk
 from ROOT import ertool
-from singleE_config import GetERSelectionInstance
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
 
 # Create ana_processor instance
 my_proc = fmwk.ana_processor()
@@ -69,7 +69,10 @@ anaunit._mgr.AddAna(LEEana)
 # Add MC filter and analysis unit
 # to the process to be run
 
+my_proc.add_process(GetEventCounterInstance())
 my_proc.add_process(eventfilter)
+# the LEE generation files have no optical data, so don't require a beam flash here
+my_proc.add_process(GetEarlyVetoInstance(use_reco, require_beam_flash=False))
 my_proc.add_process(anaunit)
 
 my_proc.run()
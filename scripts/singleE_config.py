@@ -9,7 +9,16 @@ from seltool.trackDresserDef import GetTrackDresserInstance
 from seltool.primarycosmicDef import GetPrimaryCosmicFinderInstance
 from seltool.pi0algDef import GetERAlgoPi0Instance
 
-def GetERSelectionInstance():
+# here set E-cut for Helper & Ana modules
+#This cut is applied in helper... ertool showers are not made if the energy of mcshower or reco shower
+#is below this threshold. This has to be above 0 or else the code may segfault. This is not a "physics cut".
+#Do not change this value unless you know what you are doing.
+#Ecut = 50 # in MeV
+Ecut = 10 #temporary trying this to see if it helps pi0 mids at low energy
+
+# Adds the singleE algorithm chain to an ertool.Manager
+# (shared by the larlite selection instance below and the drivers that don't read larlite files)
+def AddERSelectionAlgos(mgr):
 
 	# Make an instance of ERAlgoFlashMatch using defaults defined in ertool_default(_mc).cfg
 	flashmatch_algo = ertool.ERAlgoFlashMatch()
@@ -46,36 +55,30 @@ def GetERSelectionInstance():
 	#cos_algo.setVerbose(False)
 
 	pi0_algo = GetERAlgoPi0Instance()
-	# here set E-cut for Helper & Ana modules
-	#This cut is applied in helper... ertool showers are not made if the energy of mcshower or reco shower
-	#is below this threshold. This has to be above 0 or else the code may segfault. This is not a "physics cut".
-	#Do not change this value unless you know what you are doing.
-	#Ecut = 50 # in MeV
-	Ecut = 10 #temporary trying this to see if it helps pi0 mids at low energy
-	
-	#anaunit = fmwk.ERSelSaveSingleEEvents()
-	anaunit = fmwk.ExampleERSelection()
-	anaunit.SetShowerProducer(True,'mcreco')
-	anaunit.SetTrackProducer(True,'mcreco')
 
-	anaunit.SetFlashProducer('opflashSat')
+	mgr.AddAlgo(ertool.ERAlgoTagEmulatedDeletionsCosmic())
 
-	anaunit.setDisableXShift(False)
+	# cheaply tag showers that can't matter as cosmic, so the combinatorial algorithms below
+	# loop over fewer showers. Every criterion is off by default (showers below Ecut are already
+	# dropped by the helper, SetMinEDep): turn them on only once validated against the unpruned selection
+	preprune_algo = ertool.ERAlgoShowerPrePrune()
+	#preprune_algo.SetRequireTPCOverlap(True)
+	#preprune_algo.SetBeamWindow(3.5,5.2)
+	#preprune_algo.SetMaxFlashDistance(200.)
+	mgr.AddAlgo(preprune_algo)
 
-	anaunit._mgr.AddAlgo(ertool.ERAlgoTagEmulatedDeletionsCosmic())
-	
 	# pi0 algo takes a long time on cosmics files (may showers)...
 	# first run track dresser to gobble up most of the showers and 
 	# pi0 algo will run much faster (I hope!)
-	anaunit._mgr.AddAlgo(cos_algo)
-	anaunit._mgr.AddAlgo(pi0_algo)
+	mgr.AddAlgo(cos_algo)
+	mgr.AddAlgo(pi0_algo)
 	
-	anaunit._mgr.AddAlgo(cosmicprimary_algo)
-	anaunit._mgr.AddAlgo(cosmicsecondary_algo)
-	anaunit._mgr.AddAlgo(cosmicorphanalgo)
-	anaunit._mgr.AddAlgo(primary_algo)
-	# anaunit._mgr.AddAlgo(pid_algo)
-	anaunit._mgr.AddAlgo(ccsinglee_algo)
+	mgr.AddAlgo(cosmicprimary_algo)
+	mgr.AddAlgo(cosmicsecondary_algo)
+	mgr.AddAlgo(cosmicorphanalgo)
+	mgr.AddAlgo(primary_algo)
+	# mgr.AddAlgo(pid_algo)
+	mgr.AddAlgo(ccsinglee_algo)
 	# Is this where flashmatch_algo should go?
 	# First we reconstruct nues and all that, then say if the electron's associated flash
 	# is outside of the BGW we throw it out?
@@ -85,15 +88,66 @@ def GetERSelectionInstance():
 	# However, right now all solo shower particles are tagged as cosmic by the flash-matcher
 	# Because it only works for tracks! For now, flashmatch_algo has to live after
 	# and it has to be an analysis cut. This will be changed ASAP.
-	anaunit._mgr.AddAlgo(flashmatch_algo)
+	mgr.AddAlgo(flashmatch_algo)
 
 	# Testing adding this... it looks for flashes shared b/t the neutrino and others
 	# and potentially adds the "others" as children of the neutrino, or tags
 	# the neutrino as a pi0 MID
-	#anaunit._mgr.AddAlgo(ertool.ERAlgoNueSharedFlashMerger())
+	#mgr.AddAlgo(ertool.ERAlgoNueSharedFlashMerger())
+
+def GetERSelectionInstance(reco_cache_file=''):
+
+	#anaunit = fmwk.ERSelSaveSingleEEvents()
+	anaunit = fmwk.ExampleERSelection()
+	anaunit.SetShowerProducer(True,'mcreco')
+	anaunit.SetTrackProducer(True,'mcreco')
+
+	anaunit.SetFlashProducer('opflashSat')
+
+	anaunit.setDisableXShift(False)
+
+	AddERSelectionAlgos(anaunit._mgr)
+
 	anaunit._mgr._profile_mode = True
 
+	# Optionally save the reconstructed particle graph + event data of every event
+	# to a cache file, so later iterations of the ana modules can be replayed
+	# (with ertool.ERCacheReplay) without running any of the algorithms above
+	if reco_cache_file:
+		reco_cache = ertool.ERAnaRecoCache()
+		reco_cache.SetCacheFileName(reco_cache_file)
+		anaunit._mgr.AddAna(reco_cache)
+
 	anaunit.SetMinEDep(Ecut)
 	anaunit._mgr._mc_for_ana = True
 
 	return anaunit
+
+# Counts every event read by the job (job_counters) and opens the shared cut flow ("all events"),
+# so the sample filter, the veto and the selection stages have a denominator: add it first.
+def GetEventCounterInstance(pot_per_event=0.):
+
+	counter = fmwk.EventCounter()
+	counter.SetPOTPerEvent(pot_per_event)
+
+	return counter
+
+# Cheap event-level veto to add right before the selection instance (needs my_proc.enable_filter(True)).
+# Throws away events with no shower above Ecut (ertool would make no showers for them anyway)
+# and, if require_beam_flash, events with no flash above 10 PE within 0-10 us: a loose superset of
+# the beam gate window, so the flash time cut (BGWcut in stack_plotter.py) is still an analysis cut.
+def GetEarlyVetoInstance(use_reco=False, require_beam_flash=True):
+
+	veto = fmwk.EarlyVetoFilter()
+	if use_reco:
+		veto.SetShowerProducer(False,'recoemu')
+	else:
+		veto.SetShowerProducer(True,'mcreco')
+	veto.SetMinShowerEnergy(Ecut)
+
+	veto.SetFlashProducer('opflashSat')
+	veto.SetRequireBeamFlash(require_beam_flash)
+	veto.SetBeamWindow(0.,10.)
+	veto.SetMinFlashPE(10.)
+
+	return veto
@@ -17,7 +17,7 @@ if sys.argv[1] not in ['reco','mc']:
 from ROOT import gSystem
 from ROOT import larlite as fmwk
 from ROOT import ertool
-from singleE_config import GetERSelectionInstance
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
 
 # Create ana_processor instance
 my_proc = fmwk.ana_processor()
@@ -44,6 +44,11 @@ eventfilter = fmwk.MC_cosmic_Filter()
 
 LEEana = ertool.ERAnaLowEnergyExcess()
 LEEana.SetTreeName("cosmicShowers")
+# Uncomment to reuse each cosmic event with K different trigger times (weight 1/K each).
+# The replicas only shift the flash times, so this needs the x shift disabled
+# (uncomment anaunit.setDisableXShift(True) below too, declared to LEEana with SetXShiftDisabled)
+#LEEana.SetCosmicOversampling(10)
+#LEEana.SetXShiftDisabled(True)
 #LEEana.SetDebug(False)
 
 anaunit = GetERSelectionInstance()
@@ -57,11 +62,16 @@ if use_reco:
 	anaunit.SetShowerProducer(False,'recoemu')
 	anaunit.SetTrackProducer(False,'recoemu')
 
+#anaunit.setDisableXShift(True)
+
 anaunit._mgr.AddAna(LEEana)
 # Add MC filter and analysis unit
 # to the process to be run
 
+my_proc.add_process(GetEventCounterInstance())
 my_proc.add_process(eventfilter)
+# in-time cosmic flash times are hacked to the beam gate later, so don't require a beam flash here
+my_proc.add_process(GetEarlyVetoInstance(use_reco, require_beam_flash=False))
 my_proc.add_process(anaunit)
 
 my_proc.run()
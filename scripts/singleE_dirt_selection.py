@@ -17,7 +17,7 @@ if sys.argv[1] not in ['reco','mc']:
 from ROOT import gSystem
 from ROOT import larlite as fmwk
 from ROOT import ertool
-from singleE_config import GetERSelectionInstance
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
 
 # Create ana_processor instance
 my_proc = fmwk.ana_processor()
@@ -63,7 +63,9 @@ anaunit._mgr.AddAna(LEEana)
 # Add MC filter and analysis unit
 # to the process to be run
 
+my_proc.add_process(GetEventCounterInstance())
 my_proc.add_process(eventfilter)
+my_proc.add_process(GetEarlyVetoInstance(use_reco))
 my_proc.add_process(anaunit)
 
 my_proc.run()
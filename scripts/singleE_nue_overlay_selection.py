@@ -0,0 +1,65 @@
+import sys, os
+
+if len(sys.argv) < 4:
+    msg  = '\n'
+    msg += "Usage 1: %s $COSMIC_ROOT_FILE $INPUT_ROOT_FILEs $OUTPUT_PATH\n" % sys.argv[0]
+    msg += '\n'
+    msg += "Runs the nue selection with a random cosmic event (mctruth/mcshower/mctrack/opflash) overlaid\n"
+    msg += "on every neutrino event (mc quantities only).\n"
+    msg += '\n'
+    sys.stderr.write(msg)
+    sys.exit(1)
+
+from ROOT import gSystem
+from ROOT import larlite as fmwk
+from ROOT import ertool
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
+
+# Create ana_processor instance
+my_proc = fmwk.ana_processor()
+my_proc.enable_filter(True)
+
+# Set input root file
+for x in xrange(len(sys.argv)-3):
+    my_proc.add_input_file(sys.argv[x+2])
+
+# Specify IO mode
+my_proc.set_io_mode(fmwk.storage_manager.kREAD)
+
+# Specify output root file name
+outfile = sys.argv[-1]+'/'+sys.argv[0][:-3]+'_mc.root'
+print "%s output file = %s"%(sys.argv[0],outfile)
+my_proc.set_ana_output_file(outfile)
+
+#nueCC beam
+eventfilter = fmwk.MC_CCnue_Filter()
+
+#cosmic overlay
+mixer = fmwk.CosmicOverlayMixer()
+mixer.AddCosmicFile(sys.argv[1])
+
+LEEana = ertool.ERAnaLowEnergyExcess()
+LEEana.SetTreeName("beamNuEOverlay")
+
+anaunit = GetERSelectionInstance()
+anaunit._mgr.ClearCfgFile()
+anaunit._mgr.AddCfgFile(os.environ['LARLITE_USERDEVDIR']+'/SelectionTool/ERTool/dat/ertool_default.cfg')
+
+anaunit._mgr.AddAna(LEEana)
+# Add MC filter, mixer and analysis unit
+# to the process to be run
+
+my_proc.add_process(GetEventCounterInstance())
+my_proc.add_process(eventfilter)
+my_proc.add_process(mixer)
+my_proc.add_process(GetEarlyVetoInstance(False))
+my_proc.add_process(anaunit)
+
+my_proc.run()
+
+# done!
+print
+print "Finished running ana_processor event loop!"
+print
+
+sys.exit(0)
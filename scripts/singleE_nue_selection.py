@@ -17,7 +17,7 @@ if sys.argv[1] not in ['reco','mc']:
 from ROOT import gSystem
 from ROOT import larlite as fmwk
 from ROOT import ertool
-from singleE_config import GetERSelectionInstance
+from singleE_config import GetERSelectionInstance, GetEarlyVetoInstance, GetEventCounterInstance
 
 # Create ana_processor instance
 my_proc = fmwk.ana_processor()
@@ -42,9 +42,21 @@ my_proc.set_output_file(outfilebase+'_larlite_out.root')
 #nueCC beam
 eventfilter = fmwk.MC_CCnue_Filter()
 
+# Records the LEE truth topology of every event (keeping them all) for the LEE weight column,
+# before any other filter so that n_LEE_topology_evts counts every generated event
+leetagger = fmwk.MC_LEE_Filter()
+leetagger.SetTagOnly(True)
+
 LEEana = ertool.ERAnaLowEnergyExcess()
 LEEana.SetTreeName("beamNuE")
 #LEEana.SetDebug(False)
+# Also store the LEE weight as the "_lee_weight" column (zero for events failing the
+# LEE truth topology) so the scaled signal comes from this same pass over the nue sample.
+# The weight is for one generated event: stack_plotter.py divides it by the n_LEE_topology_evts
+# counter (beamNuE_counters) of the merged output, so there is no event count to set here.
+LEEana.SetLEEWeightColumnMode(True)
+LEEana.SetLEEFilename(os.environ['LARLITE_USERDEVDIR']+'/LowEnergyExcess/LEEReweight/source/LEE_Reweight_plots.root')
+LEEana.SetLEECorrHistName('initial_evis_uz_corr')
 
 
 anaunit = GetERSelectionInstance()
@@ -63,7 +75,10 @@ anaunit._mgr.AddAna(LEEana)
 # Add MC filter and analysis unit
 # to the process to be run
 
+my_proc.add_process(GetEventCounterInstance())
+my_proc.add_process(leetagger)
 my_proc.add_process(eventfilter)
+my_proc.add_process(GetEarlyVetoInstance(use_reco))
 my_proc.add_process(anaunit)
 
 #my_proc.run()
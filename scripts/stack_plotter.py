@@ -49,6 +49,25 @@ BGWcut = '_flash_time > %f and _flash_time < %f'%(BGWstart,BGWend)
 # Default x-axis variable for stacked histograms
 default_plot_variable = '_e_nuReco_better'
 
+# Set this to True to apply the cuts and fill the histograms with the compiled cut engine
+# (lee::StackBuilder in ResultTools) directly on the ROOT trees, all samples in parallel,
+# instead of loading every column of every tree into pandas dataframes.
+# The cuts are the same query strings.
+use_compiled_cuts = False
+compiled_nthreads = 4
+# Number of bootstrap replicas (_bootstrap_<i> columns, BootstrapReplicas of the analysis)
+# filled with every compiled histogram, for the MC statistical uncertainty (0 = none).
+# Every sample must have been run with at least that many replicas, or the Build fails.
+compiled_bootstrap = 0
+
+# Set this to True to load the dataframes with lee::ColumnReader instead of root2array:
+# only the columns in reader_columns (every numeric column if empty) of the entries passing
+# reader_preselection are read, the cut being evaluated in C++ while reading
+# (on the cosmics, after their _flash_time is set to the middle of the BGW, as below)
+use_column_reader = False
+reader_columns = []
+reader_preselection = ''
+
 # Where the output files live that contain ttrees to plot from
 #filebase = os.environ['LARLITE_USERDEVDIR']+'/LowEnergyExcess/output/'
 filebase = '/Users/davidkaleko/Data/larlite/nevis_LEE_results/'
@@ -69,7 +88,9 @@ filenames = OrderedDict([
 ('bite','dirt/%s_alljobs_TNfinal.root'%(mc_or_reco)),
 ('cosmic','cosmic/%s_alljobs_TNfinal.root'%(mc_or_reco)),
 #('cosmicoutoftime','cosmicoutoftime/%s_alljobs_TNfinal.root'%(mc_or_reco)),
-('lee','lee/%s_alljobs_TNfinal.root'%(mc_or_reco))
+# The 'lee' sample is built from the '_lee_weight' column of the 'nue' sample below.
+# Uncomment this if you still want to use a separate LEETree job output instead.
+#('lee','lee/%s_alljobs_TNfinal.root'%(mc_or_reco))
 ])
 
 
@@ -120,24 +141,115 @@ colors = { 'nue' : '#269729', #kGreen-2
 
 
 
+# Columns of a tree for the entries passing cut, as numpy arrays sharing the memory of a lee.ColumnReader
+# (no copy; the reader is kept as the .reader attribute of the returned dictionary)
+class ColumnArrays(OrderedDict):
+  pass
+
+# defines: { column : expression } defined before reading (see TreeCutEvaluator::Define), so the cut sees them
+def read_columns(filename, treename, columns = [], cut = '', defines = {}):
+    from ROOT import lee, std
+    names = std.vector('string')()
+    for column in columns:
+      names.push_back(column)
+    reader = lee.ColumnReader()
+    for name, expr in defines.iteritems():
+      reader.Define(name, expr)
+    if not reader.Read(filename, treename, names, cut):
+      raise RuntimeError('could not read %s from %s (see the ColumnReader error above)'%(treename, filename))
+    arrays = ColumnArrays()
+    arrays.reader = reader
+    nrows = reader.NRows()
+    for column in reader.Columns():
+      if not nrows:
+        arrays[column] = np.zeros(0)
+        continue
+      buf = reader.Data(column)
+      if hasattr(buf, 'SetSize'): buf.SetSize(nrows)
+      else: buf.reshape((nrows,))
+      arrays[column] = np.frombuffer(buf, dtype=np.float64, count=nrows)
+    return arrays
+
+# Whether the tree of a sample has a branch
+def has_branch(key, branch):
+    from ROOT import TFile
+    tfile = TFile.Open(filebase + filenames[key])
+    return bool(tfile.Get(treenames[key]).GetLeaf(branch))
+
+# Value of a job counter of a sample (lee::util::JobCounters "<treename>_counters" written by
+# ERAnaLowEnergyExcess, summed over the jobs when their outputs are merged)
+def job_counter(key, counter):
+    from ROOT import TFile
+    tfile = TFile.Open(filebase + filenames[key])
+    counters = tfile.Get(treenames[key] + '_counters') if tfile else None
+    if not counters:
+      raise RuntimeError('no %s_counters in %s'%(treenames[key], filebase + filenames[key]))
+    return counters.Get(counter)
+
+# The '_lee_weight' column is the LEE weight for one generated event: the scaled signal
+# is normalized with the number of LEE topology events of the whole (merged) nue sample
+def lee_topology_events():
+    n = job_counter('nue', 'n_LEE_topology_evts')
+    if not n:
+      raise RuntimeError('no LEE topology events counted in the nue sample, cannot normalize _lee_weight')
+    return n
+
 # Read in all the ttrees to pandas dataframes
 dfs = OrderedDict()
-for key, filename in filenames.iteritems():
-    dfs.update( { key : pd.DataFrame( root2array( filebase + filename, treenames[key] ) ) } )
+if not use_compiled_cuts:
+  for key, filename in filenames.iteritems():
+    if use_column_reader:
+      # the flash time hack of the cosmics (below) has to be in place before the preselection sees _flash_time
+      defines = {}
+      if key == 'cosmic' and not has_branch(key, '_replica'):
+        defines['_flash_time'] = '%f'%((BGWstart+BGWend)/2.)
+      dfs.update( { key : pd.DataFrame( read_columns( filebase + filename, treenames[key], reader_columns, reader_preselection, defines ) ) } )
+    else:
+      dfs.update( { key : pd.DataFrame( root2array( filebase + filename, treenames[key] ) ) } )
 
 if 'cosmicoutoftime' in dfs.keys():
   #throw away intime cosmics from outoftime sample
+  #(MC_cosmicoutoftime_Filter already drops events where every cosmic shower is in time,
+  # but a kept event can still have its single electron in time, so keep these cuts)
   dfs['cosmicoutoftime']=dfs['cosmicoutoftime'].query('_mc_time<3100 or _mc_time>4700')
   #enforce the out of time cosmics truly come from cosmics
   dfs['cosmicoutoftime']=dfs['cosmicoutoftime'].query('_mc_origin == 2')
 
+#Build the scaled signal from the intrinsic nue sample, if it was run with
+#ERAnaLowEnergyExcess.SetLEEWeightColumnMode(True) (no separate LEETree job needed)
+if 'lee' not in dfs.keys() and 'nue' in dfs.keys() and '_lee_weight' in dfs['nue'].columns:
+  dfs['lee'] = dfs['nue'].query('_lee_weight > 0').copy()
+  dfs['lee']['_weight'] = dfs['lee']['_lee_weight'] / lee_topology_events()
+
 #Hack the open cosmics so they all flash in the middle of the BGW
 #(this is how we scale cosmics to total BGW exposure time..
 # this way we can just apply the same flashmatch cut and not have
 # to do any other gymnastics specific to this one sample)
-if 'cosmic' in dfs.keys():
+#If the cosmics were run with ERAnaLowEnergyExcess.SetCosmicOversampling(K), every replica
+#already has its flashes shifted so that a cosmic arrives in the BGW, so keep those flash times
+if 'cosmic' in dfs.keys() and '_replica' not in dfs['cosmic'].columns:
   dfs['cosmic']['_flash_time'] = ((BGWstart+BGWend)/2.)
 
+# With use_compiled_cuts, the same samples (with the same per-sample tweaks as above)
+# go into a lee.StackBuilder
+if use_compiled_cuts:
+  from ROOT import lee, std
+  stack_builder = lee.StackBuilder()
+  stack_builder.SetNThreads(compiled_nthreads)
+  stack_builder.SetBootstrapReplicas(compiled_bootstrap)
+  for key, filename in filenames.iteritems():
+    weight, samplecut = '_weight', ''
+    if key == 'cosmicoutoftime':
+      samplecut = '(_mc_time<3100 or _mc_time>4700) and _mc_origin == 2'
+    if key == 'cosmic':
+      weight = '_replica_weight' if has_branch(key, '_replica_weight') else ''
+    stack_builder.AddSample(key, filebase + filename, treenames[key], scaling_weights[key], weight, samplecut)
+    if key == 'cosmic' and not has_branch(key, '_replica'):
+      stack_builder.Define(key, '_flash_time', '%f'%((BGWstart+BGWend)/2.))
+  if 'lee' not in filenames.keys() and 'nue' in filenames.keys() and has_branch('nue', '_lee_weight'):
+    stack_builder.AddSample('lee', filebase + filenames['nue'], treenames['nue'],
+                            scaling_weights['lee'] / lee_topology_events(), '_lee_weight', '_lee_weight > 0')
+
 # Uncomment this if you want to see what variables are stored in the dataframes
 #dfs['cosmic'].info()
 
@@ -147,6 +259,9 @@ if 'cosmic' in dfs.keys():
 # units (IE from MEV to GEV)
 # It returns a dictionary of { sample name : histogram }
 def gen_histos( binning = np.linspace(0,10,1), myquery='', plotvar = default_plot_variable, scalefactor = 1.):
+    if use_compiled_cuts:
+      return gen_histos_compiled(binning=binning,myquery=myquery,plotvar=plotvar,scalefactor=scalefactor)
+
     nphistos = OrderedDict()
 
     for key, df in dfs.iteritems():
@@ -157,6 +272,9 @@ def gen_histos( binning = np.linspace(0,10,1), myquery='', plotvar = default_plo
 	    # change.
       if key == 'cosmic':
           myweights = np.ones(mydf[default_plot_variable].shape[0])
+          # oversampled cosmics: each replica counts 1/K
+          if '_replica_weight' in mydf.columns:
+              myweights = np.array(mydf['_replica_weight'])
       else:
           myweights = np.array(mydf['_weight'])
       myweights *= scaling_weights[key]
@@ -165,6 +283,18 @@ def gen_histos( binning = np.linspace(0,10,1), myquery='', plotvar = default_plo
                                    weights=myweights)} )
     return nphistos
 
+# Same as gen_histos, with the compiled cut engine on the trees (use_compiled_cuts)
+def gen_histos_compiled( binning = np.linspace(0,10,1), myquery='', plotvar = default_plot_variable, scalefactor = 1.):
+    nphistos = OrderedDict()
+    edges = std.vector('double')()
+    for edge in binning: edges.push_back(float(edge))
+
+    stack_builder.Build('(%s)/%f'%(plotvar,scalefactor), edges, myquery)
+    stack_builder.Print()
+    for key in stack_builder.Samples():
+      nphistos.update( {key : (np.array(stack_builder.Histogram(key)), np.array(binning))} )
+    return nphistos
+
 # This function loops over the dataframes and makes the 
 # stacked background. It takes as input the dictionary of already-created
 # histograms and just draws them prettily
@@ -200,6 +330,126 @@ def plot_fullstack( binning = np.linspace(0,10,1), myquery='', plotvar = default
     plt.xlim([binning[0],binning[-1]])
     #plt.ylim([0,130])
 
+# Cut tuning (needs use_compiled_cuts): build_cubes does one pass over the samples and saves,
+# per sample, a lee.HistCube of the plot variable vs the cut variables below. gen_histos_cube
+# then gives the same histograms as gen_histos for any cut values on the cube bin edges
+# (IE { '_e_Edep' : (60., np.inf), '_flash_time' : (BGWstart, BGWend) }) without re-reading the samples.
+# The queries are fast only while the dense cube (product of the cut axis bins + 2, times the plot bins)
+# stays within lee.HistCube.kMaxDenseCells (4194304): the axes below only cover the cut values worth
+# scanning (the fiducial volume boundaries +-10 cm), 294151 cells per plot bin, so up to 14 plot bins
+# (as in the example at the bottom).
+cube_filename = 'stack_cubes.root'
+def fid_edges(lo, hi):
+  return np.concatenate([lo + np.arange(-10., 10.1, 5.), hi + np.arange(-10., 10.1, 5.)])
+cube_axes = OrderedDict([
+  ('_e_Edep',     np.arange(0., 300.1, 20.)),
+  ('_flash_time', np.unique(np.concatenate([np.arange(2., 7.01, 0.5), [BGWstart, BGWend]]))),
+  ('_x_vtx',      fid_edges(fidxmin, fidxmax)),
+  ('_y_vtx',      fid_edges(fidymin, fidymax)),
+  ('_z_vtx',      fid_edges(fidzmin, fidzmax)),
+  ])
+
+def std_vector(values):
+    vec = std.vector('double')()
+    for v in values: vec.push_back(float(v))
+    return vec
+
+def build_cubes( binning = np.linspace(0,10,1), myquery='', plotvar = default_plot_variable, scalefactor = 1., \
+                 filename = cube_filename):
+    cube = lee.HistCube()
+    for axis, edges in cube_axes.iteritems():
+      cube.AddAxis(axis, std_vector(edges))
+    cube.SetPlotAxis('(%s)/%f'%(plotvar,scalefactor), std_vector(binning))
+    if cube.DenseSize() > lee.HistCube.kMaxDenseCells:
+      print 'WARNING: the cube has %d cells (more than %d), its queries will scan the filled cells:' \
+            ' use coarser cube_axes or fewer plot bins'%(cube.DenseSize(), lee.HistCube.kMaxDenseCells)
+    return stack_builder.BuildCubes(cube, filename, myquery)
+
+def gen_histos_cube( ranges = {}, filename = cube_filename):
+    from ROOT import TFile
+    nphistos = OrderedDict()
+    cubefile = TFile.Open(filename)
+    for key in stack_builder.Samples():
+      cube = cubefile.Get(key)
+      for axis, (lo, hi) in ranges.iteritems():
+        cube.SetRange(axis, lo, hi)
+      nphistos.update( {key : (np.array(cube.Project()), np.array(cube.PlotEdges()))} )
+    return nphistos
+
+# Threshold scan (needs use_compiled_cuts): yields, efficiency, purity and figure of merit
+# of the cut "var > threshold" (or "var < threshold" if not keep_above) on top of myquery,
+# for every threshold, with the signal samples vs the other samples of the stack.
+# IE scan_cut('_e_Edep', np.arange(0., 200., 5.), myquery=BGWcut + ' and ' + fidvolcut)
+def scan_cut( var, thresholds, keep_above = True, myquery = '', signal = ['lee'], fom = 'SOverSqrtB'):
+    scanner = lee.CutScanner(stack_builder)
+    for key in signal: scanner.SetSignal(key)
+    scanner.SetFigureOfMerit(getattr(lee.CutScanner, 'k' + fom))
+    scanner.Scan(var, std_vector(thresholds), keep_above, myquery)
+    scanner.Print()
+    return OrderedDict([ ('threshold', np.array(thresholds)),
+                         ('signal', np.array(scanner.Signal())),
+                         ('background', np.array(scanner.Background())),
+                         ('efficiency', np.array(scanner.Efficiency())),
+                         ('purity', np.array(scanner.Purity())),
+                         ('fom', np.array(scanner.FOM())) ])
+
+# Cut flow (needs use_compiled_cuts): one pass per sample stores which events pass each of the
+# elementary cuts (lee.CutBitmapStore), then prints the weighted cut flow table of all samples.
+# The returned store also gives N-1 yields/histograms and cut overlaps without re-reading the trees.
+def cut_flow( cuts = OrderedDict([('Edep', defaultcut), ('BGW', BGWcut), ('fidvol', fidvolcut)]), myquery = ''):
+    store = lee.CutBitmapStore(stack_builder)
+    for name, cut in cuts.iteritems():
+      store.AddCut(name, cut)
+    store.Build(myquery)
+    store.PrintCutFlow()
+    return store
+
+# LEE sensitivity (needs use_compiled_cuts): binned Poisson likelihood fit of the signal strength
+# of the signal sample on top of the other samples of the stack (lee.LikelihoodFitter), in the
+# histogram of plotvar after myquery. The background uncertainty of each bin is the MC statistics
+# and, if given, the RMS of the universes (list of total background histograms, one per flux universe).
+# Without data the fit is to the Asimov data of mu = 1.
+def fit_lee( binning = np.linspace(0,10,1), myquery='', plotvar = default_plot_variable, scalefactor = 1., \
+             universes = [], signal = 'lee'):
+    gen_histos_compiled(binning=binning,myquery=myquery,plotvar=plotvar,scalefactor=scalefactor)
+    fitter = lee.LikelihoodFitter()
+    fitter.SetFromStack(stack_builder, signal)
+    for universe in universes:
+      fitter.AddBackgroundUniverse(std_vector(universe))
+    result = fitter.Run()
+    fitter.Print(result)
+    if compiled_bootstrap:
+      fitter.PrintSpread(fitter.RunBootstrap(stack_builder, signal, compiled_nthreads))
+    return fitter, result
+
+# Bootstrap statistical error of each bin of each sample of the last compiled histograms
+def bootstrap_errors():
+    return OrderedDict( (key, np.array(stack_builder.BootstrapError(key))) for key in stack_builder.Samples() )
+
+# Same for many cut configurations at once: one set of ranges on the cube axes (see gen_histos_cube)
+# per configuration, all fitted in parallel. Returns (significance, upper limit) per configuration.
+def lee_sensitivity_cube( configs = [{}], filename = cube_filename, signal = 'lee'):
+    from ROOT import TFile
+    cubefile = TFile.Open(filename)
+    fitters = std.vector('lee::LikelihoodFitter')()
+    for ranges in configs:
+      background, sumw2 = 0., 0.
+      fitter = lee.LikelihoodFitter()
+      for key in stack_builder.Samples():
+        cube = cubefile.Get(key)
+        cube.ResetRanges()
+        for axis, (lo, hi) in ranges.iteritems():
+          cube.SetRange(axis, lo, hi)
+        if key == signal:
+          fitter.SetSignal(cube.Project())
+        else:
+          background = background + np.array(cube.Project())
+          sumw2 = sumw2 + np.array(cube.ProjectSumW2())
+      fitter.SetBackground(std_vector(background))
+      fitter.SetBackgroundSumW2(std_vector(sumw2))
+      fitters.push_back(fitter)
+    return [ (r.significance, r.upper_limit) for r in lee.LikelihoodFitter.RunAll(fitters, compiled_nthreads) ]
+
 if __name__ == '__main__':
   mybins = np.linspace(0.1,3.0,15)
   mycuts = defaultcut + ' and ' + BGWcut + ' and ' + fidvolcut